@@ -27,6 +27,10 @@
 
 #define DONT_DEFINE_VOID
 
+#ifndef _WIN32
+# include <sys/time.h>
+#endif
+
 #if MYSQLCLIENT_STATIC_LINKING
 
 #include <my_global.h>
@@ -87,6 +91,15 @@ extern "C"
 #define myodbc_mutex_trylock native_mutex_trylock
 #define myodbc_mutex_init native_mutex_init
 #define myodbc_mutex_destroy native_mutex_destroy
+#define myodbc_cond_t native_cond_t
+#define myodbc_cond_init native_cond_init
+#define myodbc_cond_destroy native_cond_destroy
+#define myodbc_cond_wait native_cond_wait
+#define myodbc_cond_signal native_cond_signal
+#define myodbc_cond_broadcast native_cond_broadcast
+#define myodbc_thread_t my_thread_handle
+#define myodbc_thread_create(A,B,C) my_thread_create(A,NULL,B,C)
+#define myodbc_thread_join(A) my_thread_join(A,NULL)
 #define sort_dynamic(A,cmp) my_qsort((A)->buffer, (A)->elements, (A)->size_of_element, (cmp))
 #define push_dynamic(A,B) insert_dynamic((A),(B))
 #define myodbc_snprintf my_snprintf
@@ -133,6 +146,61 @@ extern "C"
       (array->elements - idx)*array->size_of_element);
   }
 
+  /*
+    Initializes a condition for myodbc_cond_timedwait(), which measures the
+    wait with the monotonic clock where the clock of a condition can be set
+  */
+  static int inline myodbc_cond_init_timed(myodbc_cond_t *cond)
+  {
+#if defined(_WIN32) || defined(__APPLE__)
+    return myodbc_cond_init(cond);
+#else
+    pthread_condattr_t attr;
+    int rc;
+
+    if ((rc= pthread_condattr_init(&attr)))
+      return rc;
+    if (!(rc= pthread_condattr_setclock(&attr, CLOCK_MONOTONIC)))
+      rc= pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+    return rc;
+#endif
+  }
+
+  /*
+    Waits for the condition at most the given number of milliseconds. The
+    condition has to be initialized with myodbc_cond_init_timed(), so that
+    changes of the system time do not shorten or stretch the wait.
+  */
+  static int inline myodbc_cond_timedwait(myodbc_cond_t *cond,
+                                          myodbc_mutex_t *mutex,
+                                          unsigned long msec)
+  {
+#ifdef _WIN32
+    if (!SleepConditionVariableCS(cond, mutex, msec))
+      return ETIMEDOUT;
+    return 0;
+#elif defined(__APPLE__)
+    struct timespec reltime;
+
+    reltime.tv_sec= msec / 1000;
+    reltime.tv_nsec= (long)(msec % 1000) * 1000000;
+    return pthread_cond_timedwait_relative_np(cond, mutex, &reltime);
+#else
+    struct timespec abstime;
+
+    clock_gettime(CLOCK_MONOTONIC, &abstime);
+    abstime.tv_sec+= msec / 1000;
+    abstime.tv_nsec+= (long)(msec % 1000) * 1000000;
+    if (abstime.tv_nsec >= 1000000000)
+    {
+      ++abstime.tv_sec;
+      abstime.tv_nsec-= 1000000000;
+    }
+    return pthread_cond_timedwait(cond, mutex, &abstime);
+#endif
+  }
+
 
 /* Get rid of defines from my_config.h that conflict with our myconf.h */
 #ifdef VERSION
@@ -452,12 +452,20 @@ SQLRETURN SQL_API
 SQLExecDirect(SQLHSTMT hstmt, SQLCHAR *str, SQLINTEGER str_len)
 {
   int error;
+  SQLRETURN rc;
   
   CHECK_HANDLE(hstmt);  
 
+  if (async_poll((STMT *)hstmt, SQL_API_SQLEXECDIRECT, &rc))
+    return rc;
+
   if ((error= SQLPrepareImpl(hstmt, str, str_len)))
     return error;
-  error= my_SQLExecute((STMT *)hstmt);
+
+  if (ASYNC_ENABLED((STMT *)hstmt))
+    return async_start((STMT *)hstmt, SQL_API_SQLEXECDIRECT, 0, 0);
+
+  error= keyset_cursor_info((STMT *)hstmt, my_SQLExecute((STMT *)hstmt));
 
   return error;
 }
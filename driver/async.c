@@ -0,0 +1,546 @@
+/*
+  Copyright (c) 2018-Present MongoDB Inc.
+
+  The MySQL Connector/ODBC is licensed under the terms of the GPLv2
+  <http://www.gnu.org/licenses/old-licenses/gpl-2.0.html>, like most
+  MySQL Connectors. There are special exceptions to the terms and
+  conditions of the GPLv2 as it is applied to this software, see the
+  FLOSS License Exception
+  <http://www.mysql.com/about/legal/licensing/foss-exception.html>.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; version 2 of the License.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+  for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+*/
+
+/**
+  @file  async.c
+  @brief Asynchronous execution of statement and connection functions
+         (SQL_ATTR_ASYNC_ENABLE, SQL_ATTR_ASYNC_DBC_FUNCTIONS_ENABLE).
+
+  SQLExecDirect, SQLExecute, SQLFetch, SQLFetchScroll and SQLMoreResults
+  of a statement with SQL_ASYNC_ENABLE_ON, and SQLConnect, SQLDriverConnect
+  and SQLDisconnect of a connection with SQL_ASYNC_DBC_ENABLE_ON, queue the
+  call to the worker threads of the environment and return
+  SQL_STILL_EXECUTING. The application calls the function again until it
+  returns something else, the result of the call. When the call ends the
+  callback set by the driver manager is called, or else the event of the
+  handle is signaled, so that one thread can wait for many handles.
+
+  Workers are started as calls are queued and there is no idle one, up to
+  ASYNC_MAX_WORKERS, and live until the environment is freed. Calls of
+  statements of the same connection still take turns on it, connections
+  are opened in parallel.
+*/
+
+#include "driver.h"
+
+#ifndef _WIN32
+# include <unistd.h>
+#endif
+
+#define ASYNC_MAX_WORKERS 64
+
+
+typedef struct st_async_pool
+{
+  myodbc_mutex_t  lock;
+  myodbc_cond_t   work;     /* Signaled when a call is queued */
+  myodbc_cond_t   done;     /* Broadcast when a call ends */
+  myodbc_thread_t workers[ASYNC_MAX_WORKERS];
+  uint            worker_count, idle;
+  MY_ASYNC        *head, *tail;
+  uint            queued;
+  my_bool         stop;
+} MY_ASYNC_POOL;
+
+
+static SQLRETURN async_execute(MY_ASYNC *async)
+{
+  STMT *stmt= async->stmt;
+
+  switch (async->function)
+  {
+  case SQL_API_SQLEXECDIRECT:
+  case SQL_API_SQLEXECUTE:
+    return keyset_cursor_info(stmt, my_SQLExecute(stmt));
+
+  case SQL_API_SQLFETCH:
+  case SQL_API_SQLFETCHSCROLL:
+    return my_SQLExtendedFetch(stmt, async->orientation, async->offset,
+                               stmt->ird->rows_processed_ptr,
+                               stmt->ird->array_status_ptr, 0);
+
+  case SQL_API_SQLMORERESULTS:
+    return my_SQLMoreResults(stmt);
+
+  case SQL_API_SQLCONNECT:
+  case SQL_API_SQLDRIVERCONNECT:
+    return myodbc_do_connect(async->dbc, async->ds);
+
+  case SQL_API_SQLDISCONNECT:
+    return my_SQLDisconnect(async->dbc);
+  }
+
+  return SQL_ERROR;
+}
+
+
+/*
+  Tells the application that a call has ended. On Windows the event is a
+  HANDLE of an event object, elsewhere it is a file descriptor, of eventfd()
+  or of the write end of a pipe, that gets an 8-byte 1 written to it.
+*/
+static void async_notify(SQLPOINTER event, MY_ASYNC_CALLBACK callback,
+                         SQLPOINTER context)
+{
+  if (callback != NULL)
+  {
+    callback(context, TRUE);
+  }
+  else if (event != NULL)
+  {
+#ifdef _WIN32
+    SetEvent((HANDLE)event);
+#else
+    unsigned long long one= 1;
+
+    if (write((int)(SQLLEN)event, &one, sizeof(one)) != sizeof(one))
+    {
+      /* Nothing to do if the application has closed it */
+    }
+#endif
+  }
+}
+
+
+static void * async_worker(void *arg)
+{
+  MY_ASYNC_POOL *pool= (MY_ASYNC_POOL *)arg;
+
+  mysql_thread_init();
+
+  myodbc_mutex_lock(&pool->lock);
+
+  while (!pool->stop)
+  {
+    MY_ASYNC *async= pool->head;
+    SQLPOINTER event, context;
+    MY_ASYNC_CALLBACK callback;
+    SQLRETURN rc= SQL_ERROR;
+
+    if (async == NULL)
+    {
+      ++pool->idle;
+      myodbc_cond_wait(&pool->work, &pool->lock);
+      --pool->idle;
+      continue;
+    }
+
+    pool->head= async->next;
+    if (pool->head == NULL)
+    {
+      pool->tail= NULL;
+    }
+    --pool->queued;
+
+    /* Call canceled before it started is not run at all */
+    if (!async->canceled)
+    {
+      myodbc_mutex_unlock(&pool->lock);
+      rc= async_execute(async);
+      myodbc_mutex_lock(&pool->lock);
+    }
+
+    /* The handle may be freed as soon as it is done */
+    event=    async->event;
+    callback= async->callback;
+    context=  async->context;
+
+    async->rc=   rc;
+    async->done= TRUE;
+    myodbc_cond_broadcast(&pool->done);
+
+    myodbc_mutex_unlock(&pool->lock);
+    async_notify(event, callback, context);
+    myodbc_mutex_lock(&pool->lock);
+  }
+
+  myodbc_mutex_unlock(&pool->lock);
+
+  mysql_thread_end();
+
+  return NULL;
+}
+
+
+/* Returns the pool of the environment, creating it if needed */
+static MY_ASYNC_POOL * async_pool(ENV *env)
+{
+  MY_ASYNC_POOL *pool;
+
+  myodbc_mutex_lock(&env->lock);
+
+  if ((pool= env->async_pool) == NULL)
+  {
+    pool= (MY_ASYNC_POOL *)myodbc_malloc(sizeof(MY_ASYNC_POOL),
+                                         MYF(MY_ZEROFILL));
+    if (pool != NULL)
+    {
+      myodbc_mutex_init(&pool->lock, NULL);
+      myodbc_cond_init(&pool->work);
+      myodbc_cond_init(&pool->done);
+      env->async_pool= pool;
+    }
+  }
+
+  myodbc_mutex_unlock(&env->lock);
+
+  return pool;
+}
+
+
+/*
+  Queues the call to the workers of the environment.
+
+  @return FALSE if the call is queued, TRUE if there are no workers to run
+          it
+*/
+static my_bool async_queue(ENV *env, MY_ASYNC *async)
+{
+  MY_ASYNC_POOL *pool= async_pool(env);
+
+  if (pool == NULL)
+  {
+    return TRUE;
+  }
+
+  myodbc_mutex_lock(&pool->lock);
+
+  if (pool->idle <= pool->queued && pool->worker_count < ASYNC_MAX_WORKERS
+      && !myodbc_thread_create(&pool->workers[pool->worker_count],
+                               async_worker, pool))
+  {
+    ++pool->worker_count;
+  }
+
+  if (pool->worker_count == 0)
+  {
+    myodbc_mutex_unlock(&pool->lock);
+    return TRUE;
+  }
+
+  async->done=     FALSE;
+  async->canceled= FALSE;
+  async->next=     NULL;
+
+  if (pool->tail != NULL)
+  {
+    pool->tail->next= async;
+  }
+  else
+  {
+    pool->head= async;
+  }
+  pool->tail= async;
+  ++pool->queued;
+
+  myodbc_cond_signal(&pool->work);
+  myodbc_mutex_unlock(&pool->lock);
+
+  return FALSE;
+}
+
+
+/*
+  Checks the call in progress, if any, when the application calls the
+  same function again. Callers report other functions with HY010.
+
+  @return FALSE if no call is in progress. Otherwise *rc is what the
+          function has to return: SQL_STILL_EXECUTING while the call runs,
+          the result of the call once it has ended.
+*/
+static my_bool async_check(ENV *env, MY_ASYNC *async, SQLUSMALLINT function,
+                           SQLRETURN *rc)
+{
+  MY_ASYNC_POOL *pool;
+  my_bool done;
+
+  /* Only the application sets and clears the function */
+  if (async->function == 0)
+  {
+    return FALSE;
+  }
+
+  pool= env->async_pool;
+  myodbc_mutex_lock(&pool->lock);
+  done= async->done;
+  myodbc_mutex_unlock(&pool->lock);
+
+  if (!done)
+  {
+    *rc= SQL_STILL_EXECUTING;
+    return TRUE;
+  }
+
+  async->function= 0;
+  *rc= async->rc;
+
+  return TRUE;
+}
+
+
+/* Waits for the call in progress, if any, to end */
+static void async_finish(ENV *env, MY_ASYNC *async)
+{
+  MY_ASYNC_POOL *pool;
+
+  if (async->function == 0)
+  {
+    return;
+  }
+
+  pool= env->async_pool;
+  myodbc_mutex_lock(&pool->lock);
+  while (!async->done)
+  {
+    myodbc_cond_wait(&pool->done, &pool->lock);
+  }
+  myodbc_mutex_unlock(&pool->lock);
+
+  async->function= 0;
+}
+
+
+/*
+  Starts the call of the given function of the statement in the background.
+  The arguments of SQLExecDirect and SQLExecute are in the statement
+  already, those of fetch functions are passed.
+
+  @return SQL_STILL_EXECUTING, or the result of the call if there are no
+          workers to run it, and it has been run right away
+*/
+SQLRETURN async_start(STMT *stmt, SQLUSMALLINT function,
+                      SQLSMALLINT orientation, SQLLEN offset)
+{
+  MY_ASYNC *async= &stmt->async;
+
+  async->stmt=        stmt;
+  async->function=    function;
+  async->orientation= orientation;
+  async->offset=      offset;
+
+  if (async_queue(stmt->dbc->env, async))
+  {
+    async->function= 0;
+    return async_execute(async);
+  }
+
+  return SQL_STILL_EXECUTING;
+}
+
+
+/*
+  Checks the asynchronous call of the statement, see async_check(). A call
+  canceled by SQLCancel that has failed reports HY008.
+*/
+my_bool async_poll(STMT *stmt, SQLUSMALLINT function, SQLRETURN *rc)
+{
+  /* Function sequence error while another function runs */
+  if (stmt->async.function != 0 && stmt->async.function != function)
+  {
+    *rc= set_error(stmt, MYERR_S1010, NULL, 0);
+    return TRUE;
+  }
+
+  if (!async_check(stmt->dbc->env, &stmt->async, function, rc))
+  {
+    return FALSE;
+  }
+
+  /* Call that has finished anyway returns its own result */
+  if (stmt->async.function == 0 && stmt->async.canceled &&
+      !SQL_SUCCEEDED(*rc))
+  {
+    my_SQLFreeStmt(stmt, SQL_CLOSE);
+    *rc= set_error(stmt, MYERR_S1008, NULL, 0);
+  }
+
+  return TRUE;
+}
+
+
+/*
+  Asks the asynchronous call of the statement to stop. The call is dropped
+  if it has not started yet, SQLCancel kills the query that is running.
+
+  @return TRUE if there was a call in progress
+*/
+my_bool async_cancel(STMT *stmt)
+{
+  MY_ASYNC_POOL *pool;
+  my_bool running;
+
+  if (stmt->async.function == 0)
+  {
+    return FALSE;
+  }
+
+  pool= stmt->dbc->env->async_pool;
+  myodbc_mutex_lock(&pool->lock);
+  running= !stmt->async.done;
+  if (running)
+  {
+    stmt->async.canceled= TRUE;
+  }
+  myodbc_mutex_unlock(&pool->lock);
+
+  return running;
+}
+
+
+/*
+  Whether the asynchronous call the statement runs has been canceled. The
+  call checks it with dbc->lock held, before it sends anything to the
+  server: SQLCancel that has got the lock returns without killing a query,
+  so a call it has been too early for must not start one.
+*/
+my_bool async_canceled(STMT *stmt)
+{
+  MY_ASYNC_POOL *pool= stmt->dbc->env->async_pool;
+  my_bool canceled;
+
+  if (stmt->async.function == 0 || pool == NULL)
+  {
+    return FALSE;
+  }
+
+  myodbc_mutex_lock(&pool->lock);
+  canceled= stmt->async.canceled && !stmt->async.done;
+  myodbc_mutex_unlock(&pool->lock);
+
+  return canceled;
+}
+
+
+/*
+  Waits for the asynchronous call of the statement to end and discards its
+  result. For the functions that close or free the statement.
+*/
+void async_wait(STMT *stmt)
+{
+  async_finish(stmt->dbc->env, &stmt->async);
+}
+
+
+/*
+  Starts the call of the given function of the connection in the
+  background. Connect functions pass the data source, that belongs to the
+  call from now on: it becomes dbc->ds, or is deleted if the connection
+  fails.
+
+  @return TRUE if the call is started, FALSE if there are no workers to run
+          it and the caller has to do it
+*/
+my_bool async_dbc_start(DBC *dbc, SQLUSMALLINT function, DataSource *ds)
+{
+  MY_ASYNC *async= &dbc->async;
+
+  async->dbc=      dbc;
+  async->function= function;
+  async->ds=       ds;
+
+  if (async_queue(dbc->env, async))
+  {
+    async->function= 0;
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+
+/* Deletes the data source of a connect call that has failed */
+static void async_dbc_end(DBC *dbc)
+{
+  if (dbc->async.ds != NULL)
+  {
+    if (!dbc->ds)
+    {
+      ds_delete(dbc->async.ds);
+    }
+    dbc->async.ds= NULL;
+  }
+}
+
+
+/* Checks the asynchronous call of the connection, see async_check() */
+my_bool async_dbc_poll(DBC *dbc, SQLUSMALLINT function, SQLRETURN *rc)
+{
+  if (dbc->async.function != 0 && dbc->async.function != function)
+  {
+    *rc= set_conn_error(dbc, MYERR_S1010, NULL, 0);
+    return TRUE;
+  }
+
+  if (!async_check(dbc->env, &dbc->async, function, rc))
+  {
+    return FALSE;
+  }
+
+  if (dbc->async.function == 0)
+  {
+    async_dbc_end(dbc);
+  }
+
+  return TRUE;
+}
+
+
+/* Waits for the asynchronous call of the connection before it is freed */
+void async_dbc_wait(DBC *dbc)
+{
+  async_finish(dbc->env, &dbc->async);
+  async_dbc_end(dbc);
+}
+
+/*
+  Stops the workers of the environment. All its statements are freed
+  already, so nothing is queued.
+*/
+void async_stop(ENV *env)
+{
+  MY_ASYNC_POOL *pool= env->async_pool;
+  uint i;
+
+  if (pool == NULL)
+  {
+    return;
+  }
+
+  myodbc_mutex_lock(&pool->lock);
+  pool->stop= TRUE;
+  myodbc_cond_broadcast(&pool->work);
+  myodbc_mutex_unlock(&pool->lock);
+
+  for (i= 0; i < pool->worker_count; ++i)
+  {
+    myodbc_thread_join(&pool->workers[i]);
+  }
+
+  myodbc_cond_destroy(&pool->done);
+  myodbc_cond_destroy(&pool->work);
+  myodbc_mutex_destroy(&pool->lock);
+  x_free(pool);
+
+  env->async_pool= NULL;
+}
@@ -0,0 +1,184 @@
+/*
+  Copyright (c) 2018-Present MongoDB Inc.
+
+  The MySQL Connector/ODBC is licensed under the terms of the GPLv2
+  <http://www.gnu.org/licenses/old-licenses/gpl-2.0.html>, like most
+  MySQL Connectors. There are special exceptions to the terms and
+  conditions of the GPLv2 as it is applied to this software, see the
+  FLOSS License Exception
+  <http://www.mysql.com/about/legal/licensing/foss-exception.html>.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; version 2 of the License.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+  for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+*/
+
+/**
+  @file  bench_escape.c
+  @brief Micro-benchmark of myodbc_escape_data against
+         mysql_real_escape_string on a generated JSON document, for the
+         character sets the fast path covers and one it doesn't. No server
+         is needed.
+
+  Built with -DWITH_BENCHMARKS=1, run as bench_escape [iterations] [MB].
+*/
+
+#include "driver.h"
+#include <time.h>
+
+
+static char *gen_json(size_t length)
+{
+  static const char item[]= "{\"device\": \"sensor \\\"%lu\\\"\", "
+                            "\"label\": \"it's\\n%lu\", \"values\": "
+                            "[21.55, 1013.25, 0.5]},\n";
+  char *json= myodbc_malloc(length + 1, MYF(0));
+  size_t pos= 0;
+  unsigned long i= 0;
+
+  if (json == NULL)
+  {
+    return NULL;
+  }
+
+  while (pos < length)
+  {
+    char buff[sizeof(item) + 40];
+    size_t n= sprintf(buff, item, i, i);
+
+    memcpy(json + pos, buff, myodbc_min(n, length - pos));
+    pos+= myodbc_min(n, length - pos);
+    ++i;
+  }
+  json[length]= '\0';
+
+  return json;
+}
+
+
+static int bench(MYSQL *mysql, const char *csname, const char *json,
+                 size_t length, long iterations)
+{
+  char *plain= myodbc_malloc(length * 2 + 1, MYF(0));
+  char *fast= myodbc_malloc(length * 2 + 1, MYF(0));
+  ulong plain_length= 0, fast_length= 0;
+  double plain_seconds, fast_seconds;
+  clock_t start;
+  long n;
+
+  mysql->charset= get_charset_by_csname(csname, MYF(MY_CS_PRIMARY), MYF(0));
+  if (plain == NULL || fast == NULL || mysql->charset == NULL)
+  {
+    fprintf(stderr, "%s: initialization failed\n", csname);
+    return 1;
+  }
+
+  start= clock();
+  for (n= 0; n < iterations; ++n)
+  {
+    plain_length= mysql_real_escape_string(mysql, plain, json,
+                                           (ulong)length);
+  }
+  plain_seconds= (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  start= clock();
+  for (n= 0; n < iterations; ++n)
+  {
+    fast_length= myodbc_escape_data(mysql, fast, json, (ulong)length);
+  }
+  fast_seconds= (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  if (plain_length != fast_length || memcmp(plain, fast, plain_length))
+  {
+    fprintf(stderr, "%s: escaped values differ\n", csname);
+    return 1;
+  }
+
+  printf("%-8s %10lu %10lu %12.1f %12.1f\n", csname, (unsigned long)length,
+         plain_length,
+         plain_seconds > 0 ? length * (double)iterations / plain_seconds /
+                             1048576 : 0.0,
+         fast_seconds > 0 ? length * (double)iterations / fast_seconds /
+                            1048576 : 0.0);
+
+  x_free(plain);
+  x_free(fast);
+  return 0;
+}
+
+
+/*
+  The fast path has to give the same result as the client library for
+  utf8 values with valid and invalid multibyte sequences too.
+*/
+static int check_utf8(MYSQL *mysql)
+{
+  static const char value[]= "caf\xc3\xa9 '\xe2\x82\xac' \xc3' \xe2\x82\\"
+                             "\xf0\x9f\x98\x80 \xff\"\xc3";
+  char plain[sizeof(value) * 2], fast[sizeof(value) * 2];
+  ulong plain_length, fast_length;
+
+  mysql->charset= get_charset_by_csname("utf8", MYF(MY_CS_PRIMARY), MYF(0));
+  plain_length= mysql_real_escape_string(mysql, plain, value,
+                                         sizeof(value) - 1);
+  fast_length= myodbc_escape_data(mysql, fast, value, sizeof(value) - 1);
+
+  if (plain_length != fast_length || memcmp(plain, fast, plain_length))
+  {
+    fprintf(stderr, "utf8: escaped invalid sequences differ\n");
+    return 1;
+  }
+
+  return 0;
+}
+
+
+int main(int argc, char **argv)
+{
+  long iterations= argc > 1 ? atol(argv[1]) : 20L;
+  long megabytes= argc > 2 ? atol(argv[2]) : 8L;
+  size_t length;
+  MYSQL mysql;
+  char *json;
+  int rc;
+
+  if (iterations <= 0 || megabytes <= 0)
+  {
+    fprintf(stderr, "usage: %s [iterations] [MB]\n", argv[0]);
+    return 1;
+  }
+
+  myodbc_init();
+  mysql_init(&mysql);
+
+  length= (size_t)megabytes * 1048576;
+  if (!(json= gen_json(length)))
+  {
+    fprintf(stderr, "out of memory\n");
+    return 1;
+  }
+
+  printf("%-8s %10s %10s %12s %12s\n", "charset", "bytes", "escaped",
+         "scalar MB/s", "fast MB/s");
+
+  rc= check_utf8(&mysql) ||
+      bench(&mysql, "utf8", json, length, iterations) ||
+      bench(&mysql, "latin1", json, length, iterations) ||
+      bench(&mysql, "binary", json, length, iterations) ||
+      bench(&mysql, "gbk", json, length, iterations);
+
+  x_free(json);
+  mysql_close(&mysql);
+  myodbc_end();
+
+  return rc;
+}
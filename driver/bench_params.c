@@ -0,0 +1,169 @@
+/*
+  Copyright (c) 2018-Present MongoDB Inc.
+
+  The MySQL Connector/ODBC is licensed under the terms of the GPLv2
+  <http://www.gnu.org/licenses/old-licenses/gpl-2.0.html>, like most
+  MySQL Connectors. There are special exceptions to the terms and
+  conditions of the GPLv2 as it is applied to this software, see the
+  FLOSS License Exception
+  <http://www.mysql.com/about/legal/licensing/foss-exception.html>.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; version 2 of the License.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+  for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+*/
+
+/**
+  @file  bench_params.c
+  @brief Micro-benchmark of convert_c_type2str, which formats parameters
+         of every C type as text. No server is needed.
+
+  Built with -DWITH_BENCHMARKS=1, run as bench_params [iterations].
+*/
+
+#include "driver.h"
+#include <time.h>
+
+
+typedef struct
+{
+  const char  *name;
+  SQLSMALLINT ctype;
+  SQLSMALLINT sql_type;
+  void        *value;
+  long        length;
+} BENCH_PARAM;
+
+
+int main(int argc, char **argv)
+{
+  long iterations= argc > 1 ? atol(argv[1]) : 1000000L;
+
+  SQLCHAR             char_value[]= "telemetry value";
+  SQLWCHAR            wchar_value[]= {'t', 'e', 'l', 'e', 'm', 'e', 't',
+                                      'r', 'y', 0};
+  SQLSCHAR            tinyint_value= -100;
+  SQLCHAR             utinyint_value= 200;
+  SQLSMALLINT         short_value= -30000;
+  SQLUSMALLINT        ushort_value= 60000;
+  SQLINTEGER          long_value= -2000000000;
+  SQLUINTEGER         ulong_value= 4000000000U;
+  SQLBIGINT           sbigint_value= -9000000000000000000LL;
+  SQLUBIGINT          ubigint_value= 18000000000000000000ULL;
+  SQLREAL             float_value= 21.55f;
+  SQLDOUBLE           double_value= 1013.2500000000001;
+  SQL_DATE_STRUCT     date_value= {2018, 11, 23};
+  SQL_TIME_STRUCT     time_value= {13, 45, 7};
+  SQL_TIMESTAMP_STRUCT timestamp_value= {2018, 11, 23, 13, 45, 7, 123456000};
+  SQL_NUMERIC_STRUCT  numeric_value= {10, 2, 1, {0x39, 0x30}};
+  SQL_INTERVAL_STRUCT interval_value;
+
+  BENCH_PARAM params[]=
+  {
+    {"SQL_C_CHAR", SQL_C_CHAR, SQL_VARCHAR, char_value,
+     sizeof(char_value) - 1},
+    {"SQL_C_WCHAR", SQL_C_WCHAR, SQL_WVARCHAR, wchar_value,
+     sizeof(wchar_value) - sizeof(SQLWCHAR)},
+    {"SQL_C_BINARY", SQL_C_BINARY, SQL_VARBINARY, char_value,
+     sizeof(char_value) - 1},
+    {"SQL_C_BIT", SQL_C_BIT, SQL_BIT, &utinyint_value, 1},
+    {"SQL_C_STINYINT", SQL_C_STINYINT, SQL_TINYINT, &tinyint_value, 1},
+    {"SQL_C_UTINYINT", SQL_C_UTINYINT, SQL_TINYINT, &utinyint_value, 1},
+    {"SQL_C_SSHORT", SQL_C_SSHORT, SQL_SMALLINT, &short_value, 2},
+    {"SQL_C_USHORT", SQL_C_USHORT, SQL_SMALLINT, &ushort_value, 2},
+    {"SQL_C_SLONG", SQL_C_SLONG, SQL_INTEGER, &long_value, 4},
+    {"SQL_C_ULONG", SQL_C_ULONG, SQL_INTEGER, &ulong_value, 4},
+    {"SQL_C_SBIGINT", SQL_C_SBIGINT, SQL_BIGINT, &sbigint_value, 8},
+    {"SQL_C_UBIGINT", SQL_C_UBIGINT, SQL_BIGINT, &ubigint_value, 8},
+    {"SQL_C_FLOAT", SQL_C_FLOAT, SQL_REAL, &float_value, 4},
+    {"SQL_C_FLOAT/DECIMAL", SQL_C_FLOAT, SQL_DECIMAL, &float_value, 4},
+    {"SQL_C_DOUBLE", SQL_C_DOUBLE, SQL_DOUBLE, &double_value, 8},
+    {"SQL_C_DOUBLE/DECIMAL", SQL_C_DOUBLE, SQL_DECIMAL, &double_value, 8},
+    {"SQL_C_TYPE_DATE", SQL_C_TYPE_DATE, SQL_TYPE_DATE, &date_value,
+     sizeof(date_value)},
+    {"SQL_C_TYPE_TIME", SQL_C_TYPE_TIME, SQL_TYPE_TIME, &time_value,
+     sizeof(time_value)},
+    {"SQL_C_TYPE_TIMESTAMP", SQL_C_TYPE_TIMESTAMP, SQL_TYPE_TIMESTAMP,
+     &timestamp_value, sizeof(timestamp_value)},
+    {"SQL_C_NUMERIC", SQL_C_NUMERIC, SQL_DECIMAL, &numeric_value,
+     sizeof(numeric_value)},
+    {"SQL_C_INTERVAL_HOUR_TO_SECOND", SQL_C_INTERVAL_HOUR_TO_SECOND,
+     SQL_TYPE_TIME, &interval_value, sizeof(interval_value)}
+  };
+
+  ENV env;
+  DBC dbc;
+  STMT stmt;
+  DESCREC iprec;
+  uint i;
+
+  if (iterations <= 0)
+  {
+    fprintf(stderr, "usage: %s [iterations]\n", argv[0]);
+    return 1;
+  }
+
+  myodbc_init();
+
+  memset(&interval_value, 0, sizeof(interval_value));
+  interval_value.interval_type= SQL_IS_HOUR_TO_SECOND;
+  interval_value.intval.day_second.hour= 13;
+  interval_value.intval.day_second.minute= 45;
+  interval_value.intval.day_second.second= 7;
+
+  memset(&env, 0, sizeof(env));
+  memset(&dbc, 0, sizeof(dbc));
+  memset(&stmt, 0, sizeof(stmt));
+  dbc.env= &env;
+  dbc.ds= ds_new();
+  dbc.mysql.server_version= (char *)"5.7.0";
+  stmt.dbc= &dbc;
+
+  printf("%-30s %10s %8s  %s\n", "C type", "ns/param", "bytes", "text");
+
+  for (i= 0; i < array_elements(params); ++i)
+  {
+    char buff[128], *res= NULL;
+    long length= 0, n;
+    clock_t start;
+    double ns;
+
+    memset(&iprec, 0, sizeof(iprec));
+    iprec.concise_type= params[i].sql_type;
+    iprec.precision= 10;
+    iprec.scale= 2;
+
+    start= clock();
+    for (n= 0; n < iterations; ++n)
+    {
+      res= (char *)params[i].value;
+      length= params[i].length;
+
+      if (!SQL_SUCCEEDED(convert_c_type2str(&stmt, params[i].ctype, &iprec,
+                                            &res, &length, buff,
+                                            sizeof(buff))))
+      {
+        fprintf(stderr, "%s: conversion failed\n", params[i].name);
+        return 1;
+      }
+    }
+    ns= (double)(clock() - start) * 1e9 / CLOCKS_PER_SEC / iterations;
+
+    printf("%-30s %10.1f %8ld  %.*s\n", params[i].name, ns, length,
+           (int)length, res);
+  }
+
+  ds_delete(dbc.ds);
+  myodbc_end();
+
+  return 0;
+}
@@ -0,0 +1,153 @@
+/*
+  Copyright (c) 2018-Present MongoDB Inc.
+
+  The MySQL Connector/ODBC is licensed under the terms of the GPLv2
+  <http://www.gnu.org/licenses/old-licenses/gpl-2.0.html>, like most
+  MySQL Connectors. There are special exceptions to the terms and
+  conditions of the GPLv2 as it is applied to this software, see the
+  FLOSS License Exception
+  <http://www.mysql.com/about/legal/licensing/foss-exception.html>.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; version 2 of the License.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+  for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+*/
+
+/**
+  @file  bench_parse.c
+  @brief Micro-benchmark of parse() on large generated INSERT and SELECT
+         statements. No server is needed.
+
+  Built with -DWITH_BENCHMARKS=1, run as bench_parse [iterations] [rows].
+*/
+
+#include "driver.h"
+#include <time.h>
+
+
+static char *gen_insert(long rows)
+{
+  DYNAMIC_STRING query;
+  long i;
+
+  init_dynamic_string(&query, "INSERT INTO sensor_readings (device_id, "
+                      "recorded_at, temperature, humidity, label) VALUES ",
+                      rows * 80, 4096);
+
+  for (i= 0; i < rows; ++i)
+  {
+    char row[128];
+
+    sprintf(row, "%s(%ld,'2018-11-23 13:45:%02ld',21.%02ld,?,'device_%ld')",
+            i ? "," : "", i, i % 60, i % 100, i);
+    dynstr_append(&query, row);
+  }
+
+  return query.str;
+}
+
+
+static char *gen_select(long columns)
+{
+  DYNAMIC_STRING query;
+  long i;
+
+  init_dynamic_string(&query, "SELECT ", columns * 60, 4096);
+
+  for (i= 0; i < columns; ++i)
+  {
+    char column[128];
+
+    sprintf(column, "%sreadings.measurement_column_%ld AS measurement_%ld",
+            i ? ", " : "", i, i);
+    dynstr_append(&query, column);
+  }
+
+  dynstr_append(&query, " FROM sensor_readings readings /* all devices */"
+                        " WHERE readings.device_id = ? AND"
+                        " readings.label <> 'it''s a \"label\"'"
+                        " ORDER BY readings.recorded_at");
+  return query.str;
+}
+
+
+static int bench(const char *name, char *query, long iterations)
+{
+  size_t length= strlen(query);
+  MY_PARSED_QUERY pq;
+  clock_t start;
+  double seconds;
+  long n;
+
+  init_parsed_query(&pq);
+
+  start= clock();
+  for (n= 0; n < iterations; ++n)
+  {
+    char *copy= myodbc_strdup(query, MYF(0));
+
+    if (copy == NULL)
+    {
+      fprintf(stderr, "%s: out of memory\n", name);
+      return 1;
+    }
+
+    reset_parsed_query(&pq, copy, copy + length, utf8_charset_info);
+
+    if (parse(&pq))
+    {
+      fprintf(stderr, "%s: parsing failed\n", name);
+      return 1;
+    }
+  }
+  seconds= (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  printf("%-8s %10lu %8u %8u %12.1f %10.1f\n", name, (unsigned long)length,
+         TOKEN_COUNT(&pq), PARAM_COUNT(&pq),
+         seconds * 1e6 / iterations,
+         seconds > 0 ? length * (double)iterations / seconds / 1048576 : 0.0);
+
+  delete_parsed_query(&pq);
+  return 0;
+}
+
+
+int main(int argc, char **argv)
+{
+  long iterations= argc > 1 ? atol(argv[1]) : 1000L;
+  long rows= argc > 2 ? atol(argv[2]) : 10000L;
+  char *insert, *select;
+  int rc;
+
+  if (iterations <= 0 || rows <= 0)
+  {
+    fprintf(stderr, "usage: %s [iterations] [rows]\n", argv[0]);
+    return 1;
+  }
+
+  myodbc_init();
+
+  insert= gen_insert(rows);
+  select= gen_select(rows / 10 + 1);
+
+  printf("%-8s %10s %8s %8s %12s %10s\n", "query", "bytes", "tokens",
+         "params", "us/parse", "MB/s");
+
+  rc= bench("INSERT", insert, iterations) ||
+      bench("SELECT", select, iterations);
+
+  x_free(insert);
+  x_free(select);
+  myodbc_end();
+
+  return rc;
+}
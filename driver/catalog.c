@@ -129,6 +129,284 @@ create_empty_fake_resultset(STMT *stmt, MYSQL_ROW rowval, size_t rowsize,
 }
 
 
+/*
+****************************************************************************
+Catalog cache
+****************************************************************************
+*/
+
+/* Catalog functions with cached results, the first byte of the key */
+enum myodbcCatalogCache {myccTables= 'T', myccColumns= 'C',
+                         myccPrimaryKeys= 'P', myccStatistics= 'S'};
+
+
+static void catalog_cache_entry_free(MY_CATALOG_CACHE_ENTRY *entry)
+{
+  free_root(&entry->alloc, MYF(0));
+  x_free(entry->key);
+  x_free(entry);
+}
+
+
+/**
+  Start the cache key of a catalog function call. Results of calls without
+  a catalog depend on the default database, and SQL_ATTR_METADATA_ID tells
+  how the arguments are matched, so both go to the key as well.
+
+  @param[in]  stmt      Statement
+  @param[out] key       Key, its str is NULL if there is nothing to look up
+  @param[in]  function  myodbcCatalogCache value
+
+  @return TRUE if the cache is on and the key has been started
+*/
+static my_bool catalog_cache_key_init(STMT *stmt, DYNAMIC_STRING *key,
+                                      char function)
+{
+  const char *db= stmt->dbc->database ? stmt->dbc->database : "";
+  SQLUINTEGER metadata_id;
+
+  if (!stmt->dbc->ds->catalog_cache_ttl
+    || init_dynamic_string(key, NULL, 256, 256))
+  {
+    key->str= NULL;
+    return FALSE;
+  }
+
+  MySQLGetStmtAttr((SQLHSTMT)stmt, SQL_ATTR_METADATA_ID,
+                   (SQLPOINTER)&metadata_id, 0, NULL);
+
+  dynstr_append_mem(key, &function, 1);
+  dynstr_append_mem(key, metadata_id ? "I" : "P", 1);
+  dynstr_append_mem(key, db, strlen(db) + 1);
+
+  return TRUE;
+}
+
+
+/**
+  Add an argument of the call to the key. NULL and empty arguments mean
+  different things to catalog functions, so they have different keys.
+*/
+static void catalog_cache_key_add(DYNAMIC_STRING *key, SQLCHAR *name,
+                                  SQLSMALLINT name_len)
+{
+  if (name == NULL)
+  {
+    dynstr_append_mem(key, "N", 1);
+    return;
+  }
+
+  dynstr_append_mem(key, "V", 1);
+  dynstr_append_mem(key, (char *)&name_len, sizeof(name_len));
+  dynstr_append_mem(key, (char *)name, name_len);
+}
+
+
+/**
+  Give the statement the cached result of the call, if there is one that
+  has not expired yet. The key is freed on a hit.
+
+  @return TRUE on a hit
+*/
+static my_bool catalog_cache_get(STMT *stmt, DYNAMIC_STRING *key)
+{
+  DBC                    *dbc= stmt->dbc;
+  LIST                   *element;
+  MY_CATALOG_CACHE_ENTRY *expired= NULL;
+  my_bool                hit= FALSE;
+
+  myodbc_mutex_lock(&dbc->catalog_cache_lock);
+
+  for (element= dbc->catalog_cache; element; element= element->next)
+  {
+    MY_CATALOG_CACHE_ENTRY *entry= (MY_CATALOG_CACHE_ENTRY *)element->data;
+    my_ulonglong i;
+
+    if (entry->key_length != key->length
+      || memcmp(entry->key, key->str, key->length))
+    {
+      continue;
+    }
+
+    if (entry->expires <= time(NULL))
+    {
+      dbc->catalog_cache= list_delete(dbc->catalog_cache, element);
+      expired= entry;
+      break;
+    }
+
+    if (create_fake_resultset(stmt, entry->values, sizeof(char *) *
+                              entry->field_count *
+                              myodbc_max(entry->row_count, 1),
+                              entry->row_count, entry->fields,
+                              entry->field_count) != SQL_SUCCESS)
+    {
+      break;
+    }
+
+    /* The entry can expire while the statement is still using the values */
+    for (i= 0; i < entry->row_count * entry->field_count; ++i)
+    {
+      if (stmt->result_array[i])
+      {
+        stmt->result_array[i]= strdup_root(&stmt->alloc_root,
+                                           stmt->result_array[i]);
+      }
+    }
+
+    hit= TRUE;
+    break;
+  }
+
+  myodbc_mutex_unlock(&dbc->catalog_cache_lock);
+
+  if (expired)
+  {
+    catalog_cache_entry_free(expired);
+  }
+
+  if (hit)
+  {
+    dynstr_free(key);
+  }
+
+  return hit;
+}
+
+
+/**
+  Keep the result the statement has got from a catalog function for the
+  next calls with the same key, and free the key.
+
+  @param[in] stmt  Statement
+  @param[in] key   Key started by catalog_cache_key_init()
+  @param[in] rc    What the catalog function has returned
+*/
+static void catalog_cache_put(STMT *stmt, DYNAMIC_STRING *key, SQLRETURN rc)
+{
+  DBC                    *dbc= stmt->dbc;
+  MYSQL_RES              *result= stmt->result;
+  MY_CATALOG_CACHE_ENTRY *entry;
+  LIST                   *element, *next, *dropped= NULL;
+  my_ulonglong           row;
+  uint                   i, field_count;
+  time_t                 now= time(NULL);
+
+  if (key->str == NULL)
+  {
+    return;
+  }
+
+  /* Rows are either in result_array, or mapped to the fields of the
+     function by fix_fields */
+  if (rc != SQL_SUCCESS || !result
+    || (!stmt->result_array && !stmt->fix_fields)
+    || !(entry= (MY_CATALOG_CACHE_ENTRY *)
+                 myodbc_malloc(sizeof(MY_CATALOG_CACHE_ENTRY),
+                               MYF(MY_ZEROFILL))))
+  {
+    dynstr_free(key);
+    return;
+  }
+
+  field_count= result->field_count;
+  entry->key= (char *)myodbc_memdup(key->str, key->length, MYF(0));
+  entry->key_length= key->length;
+  dynstr_free(key);
+
+  entry->fields= result->fields;
+  entry->field_count= field_count;
+  entry->expires= now + dbc->ds->catalog_cache_ttl;
+  entry->values= (char **)alloc_root(&entry->alloc, sizeof(char *) *
+                                     field_count *
+                                     myodbc_max(result->row_count, 1));
+  if (!entry->key || !entry->values)
+  {
+    catalog_cache_entry_free(entry);
+    return;
+  }
+  memset(entry->values, 0, sizeof(char *) * field_count);
+
+  for (row= 0; row < result->row_count; ++row)
+  {
+    MYSQL_ROW values;
+
+    if (stmt->result_array)
+    {
+      values= stmt->result_array + row * field_count;
+    }
+    else if ((values= mysql_fetch_row(result)))
+    {
+      values= (*stmt->fix_fields)(stmt, values);
+    }
+    else
+    {
+      break;
+    }
+
+    for (i= 0; i < field_count; ++i)
+    {
+      entry->values[row * field_count + i]= values[i] ?
+        strdup_root(&entry->alloc, values[i]) : NULL;
+    }
+  }
+  entry->row_count= row;
+
+  if (!stmt->result_array)
+  {
+    mysql_data_seek(result, 0);
+  }
+
+  myodbc_mutex_lock(&dbc->catalog_cache_lock);
+
+  /* Drop expired entries, and the one another statement may have put */
+  for (element= dbc->catalog_cache; element; element= next)
+  {
+    MY_CATALOG_CACHE_ENTRY *cached= (MY_CATALOG_CACHE_ENTRY *)element->data;
+    next= element->next;
+
+    if (cached->expires <= now || (cached->key_length == entry->key_length
+      && !memcmp(cached->key, entry->key, entry->key_length)))
+    {
+      dbc->catalog_cache= list_delete(dbc->catalog_cache, element);
+      dropped= list_add(dropped, element);
+    }
+  }
+
+  entry->list.data= entry;
+  dbc->catalog_cache= list_add(dbc->catalog_cache, &entry->list);
+
+  myodbc_mutex_unlock(&dbc->catalog_cache_lock);
+
+  while (dropped)
+  {
+    element= dropped;
+    dropped= list_delete(dropped, element);
+    catalog_cache_entry_free((MY_CATALOG_CACHE_ENTRY *)element->data);
+  }
+}
+
+
+/*
+  Forgets all cached catalog results, when the connection is closed or
+  the driver sees a statement that may change them.
+*/
+void catalog_cache_free(DBC *dbc)
+{
+  LIST *element;
+
+  myodbc_mutex_lock(&dbc->catalog_cache_lock);
+
+  while ((element= dbc->catalog_cache))
+  {
+    dbc->catalog_cache= list_delete(dbc->catalog_cache, element);
+    catalog_cache_entry_free((MY_CATALOG_CACHE_ENTRY *)element->data);
+  }
+
+  myodbc_mutex_unlock(&dbc->catalog_cache_lock);
+}
+
+
 /**
   Get the table status for a table or tables using Information_Schema DB.
   Lengths may not be SQL_NTS.
@@ -380,6 +658,8 @@ MySQLTables(SQLHSTMT hstmt,
             SQLCHAR *type_name, SQLSMALLINT type_len)
 {
   STMT *stmt= (STMT *)hstmt;
+  SQLRETURN rc;
+  DYNAMIC_STRING key;
 
   CLEAR_STMT_ERROR(hstmt);
   my_SQLFreeStmt(hstmt, MYSQL_RESET);
@@ -389,16 +669,31 @@ MySQLTables(SQLHSTMT hstmt,
   GET_NAME_LEN(stmt, table_name, table_len);
   GET_NAME_LEN(stmt, type_name, type_len);
 
+  if (catalog_cache_key_init(stmt, &key, myccTables))
+  {
+    catalog_cache_key_add(&key, catalog_name, catalog_len);
+    catalog_cache_key_add(&key, schema_name, schema_len);
+    catalog_cache_key_add(&key, table_name, table_len);
+    catalog_cache_key_add(&key, type_name, type_len);
+    if (catalog_cache_get(stmt, &key))
+    {
+      return SQL_SUCCESS;
+    }
+  }
+
   if (server_has_i_s(stmt->dbc) && !stmt->dbc->ds->no_information_schema)
   {
-    return tables_i_s(hstmt, catalog_name, catalog_len, schema_name, schema_len,
-                      table_name, table_len, type_name, type_len);
+    rc= tables_i_s(hstmt, catalog_name, catalog_len, schema_name, schema_len,
+                   table_name, table_len, type_name, type_len);
   }
   else
   {
-    return tables_no_i_s(hstmt, catalog_name, catalog_len, schema_name, schema_len,
-                         table_name, table_len, type_name, type_len);
+    rc= tables_no_i_s(hstmt, catalog_name, catalog_len, schema_name, schema_len,
+                      table_name, table_len, type_name, type_len);
   }
+
+  catalog_cache_put(stmt, &key, rc);
+  return rc;
 }
 
 
@@ -456,6 +751,8 @@ MySQLColumns(SQLHSTMT hstmt, SQLCHAR *catalog_name, SQLSMALLINT catalog_len,
 
 {
   STMT *stmt= (STMT *)hstmt;
+  SQLRETURN rc;
+  DYNAMIC_STRING key;
 
   CLEAR_STMT_ERROR(hstmt);
   my_SQLFreeStmt(hstmt, MYSQL_RESET);
@@ -465,16 +762,31 @@ MySQLColumns(SQLHSTMT hstmt, SQLCHAR *catalog_name, SQLSMALLINT catalog_len,
   GET_NAME_LEN(stmt, table_name, table_len);
   GET_NAME_LEN(stmt, column_name, column_len);
 
+  if (catalog_cache_key_init(stmt, &key, myccColumns))
+  {
+    catalog_cache_key_add(&key, catalog_name, catalog_len);
+    catalog_cache_key_add(&key, schema_name, schema_len);
+    catalog_cache_key_add(&key, table_name, table_len);
+    catalog_cache_key_add(&key, column_name, column_len);
+    if (catalog_cache_get(stmt, &key))
+    {
+      return SQL_SUCCESS;
+    }
+  }
+
   if (server_has_i_s(stmt->dbc) && !stmt->dbc->ds->no_information_schema)
   {
-    return columns_i_s(hstmt, catalog_name, catalog_len,schema_name, schema_len,
-                       table_name, table_len, column_name, column_len);
+    rc= columns_i_s(hstmt, catalog_name, catalog_len,schema_name, schema_len,
+                    table_name, table_len, column_name, column_len);
   }
   else
   {
-    return columns_no_i_s(hstmt, catalog_name, catalog_len,schema_name, schema_len,
-                          table_name, table_len, column_name, column_len);
+    rc= columns_no_i_s(hstmt, catalog_name, catalog_len,schema_name, schema_len,
+                       table_name, table_len, column_name, column_len);
   }
+
+  catalog_cache_put(stmt, &key, rc);
+  return rc;
 }
 
 
@@ -522,6 +834,8 @@ MySQLStatistics(SQLHSTMT hstmt,
                 SQLUSMALLINT fAccuracy __attribute__((unused)))
 {
   STMT *stmt= (STMT *)hstmt;
+  SQLRETURN rc;
+  DYNAMIC_STRING key;
 
   CLEAR_STMT_ERROR(hstmt);
   my_SQLFreeStmt(hstmt,MYSQL_RESET);
@@ -530,16 +844,32 @@ MySQLStatistics(SQLHSTMT hstmt,
   GET_NAME_LEN(stmt, schema_name, schema_len);
   GET_NAME_LEN(stmt, table_name, table_len);
 
+  if (catalog_cache_key_init(stmt, &key, myccStatistics))
+  {
+    catalog_cache_key_add(&key, catalog_name, catalog_len);
+    catalog_cache_key_add(&key, schema_name, schema_len);
+    catalog_cache_key_add(&key, table_name, table_len);
+    catalog_cache_key_add(&key, (SQLCHAR *)(fUnique == SQL_INDEX_UNIQUE ?
+                                            "U" : "A"), 1);
+    if (catalog_cache_get(stmt, &key))
+    {
+      return SQL_SUCCESS;
+    }
+  }
+
   if (server_has_i_s(stmt->dbc) && !stmt->dbc->ds->no_information_schema)
   {
-    return statistics_i_s(hstmt, catalog_name, catalog_len, schema_name, schema_len,
-                          table_name, table_len, fUnique, fAccuracy);
+    rc= statistics_i_s(hstmt, catalog_name, catalog_len, schema_name, schema_len,
+                       table_name, table_len, fUnique, fAccuracy);
   }
   else
   {
-    return statistics_no_i_s(hstmt, catalog_name, catalog_len, schema_name, schema_len,
-                             table_name, table_len, fUnique, fAccuracy);
+    rc= statistics_no_i_s(hstmt, catalog_name, catalog_len, schema_name, schema_len,
+                          table_name, table_len, fUnique, fAccuracy);
   }
+
+  catalog_cache_put(stmt, &key, rc);
+  return rc;
 }
 
 /*
@@ -807,6 +1137,8 @@ MySQLPrimaryKeys(SQLHSTMT hstmt,
                  SQLCHAR *table_name, SQLSMALLINT table_len)
 {
   STMT *stmt= (STMT *) hstmt;
+  SQLRETURN rc;
+  DYNAMIC_STRING key;
 
   CLEAR_STMT_ERROR(hstmt);
   my_SQLFreeStmt(hstmt,MYSQL_RESET);
@@ -815,16 +1147,30 @@ MySQLPrimaryKeys(SQLHSTMT hstmt,
   GET_NAME_LEN(stmt, schema_name, schema_len);
   GET_NAME_LEN(stmt, table_name, table_len);
 
+  if (catalog_cache_key_init(stmt, &key, myccPrimaryKeys))
+  {
+    catalog_cache_key_add(&key, catalog_name, catalog_len);
+    catalog_cache_key_add(&key, schema_name, schema_len);
+    catalog_cache_key_add(&key, table_name, table_len);
+    if (catalog_cache_get(stmt, &key))
+    {
+      return SQL_SUCCESS;
+    }
+  }
+
   if (server_has_i_s(stmt->dbc) && !stmt->dbc->ds->no_information_schema)
   {
-    return primary_keys_i_s(hstmt, catalog_name, catalog_len, schema_name, schema_len,
-                            table_name, table_len);
+    rc= primary_keys_i_s(hstmt, catalog_name, catalog_len, schema_name, schema_len,
+                         table_name, table_len);
   }
   else
   {
-    return primary_keys_no_i_s(hstmt, catalog_name, catalog_len, schema_name, schema_len,
-                               table_name, table_len);
+    rc= primary_keys_no_i_s(hstmt, catalog_name, catalog_len, schema_name, schema_len,
+                            table_name, table_len);
   }
+
+  catalog_cache_put(stmt, &key, rc);
+  return rc;
 }
 
 
@@ -31,6 +31,7 @@
 
 #include "driver.h"
 #include "catalog.h"
+#include "errmsg.h"
 
 
 /*
@@ -168,74 +169,505 @@ MYSQL_FIELD SQLCOLUMNS_fields[]=
 
 const uint SQLCOLUMNS_FIELDS= array_elements(SQLCOLUMNS_values);
 
+/* Tables whose columns are asked for in one multi-statement request */
+#define COLUMNS_BATCH_TABLES 64
+
 /**
-  Get the list of columns in a table matching a wildcard.
+  Fill a row of the SQLColumns result for a column.
+
+  @param[in]  stmt      Statement
+  @param[in]  field     Column, def is its default value
+  @param[in]  db        TABLE_CAT value
+  @param[in]  is_access Whether the application is MS Access
+  @param[in]  ordinal   ORDINAL_POSITION value
+  @param[out] row       Row to fill
+*/
+static void fill_column_row(STMT *stmt, MYSQL_FIELD *field, char *db,
+                            BOOL is_access, int ordinal, MYSQL_ROW row)
+{
+  MEM_ROOT *alloc= &stmt->alloc_root;
+  SQLSMALLINT type;
+  char buff[255]; /* @todo justify the size of this buffer */
 
-  @param[in] stmt             Statement
-  @param[in] szCatalog        Name of catalog (database)
-  @param[in] cbCatalog        Length of catalog
-  @param[in] szTable          Name of table
-  @param[in] cbTable          Length of table
-  @param[in] szColumn         Pattern of column names to match
-  @param[in] cbColumn         Length of column pattern
+  row[0]= db;                     /* TABLE_CAT */
+  row[1]= NULL;                   /* TABLE_SCHEM */
+  row[2]= strdup_root(alloc, field->table); /* TABLE_NAME */
+  row[3]= strdup_root(alloc, field->name);  /* COLUMN_NAME */
+
+  type= get_sql_data_type(stmt, field, buff);
+
+  row[5]= strdup_root(alloc, buff); /* TYPE_NAME */
+
+  sprintf(buff, "%d", type);
+  row[4]= strdup_root(alloc, buff); /* DATA_TYPE */
+
+  if (type == SQL_TYPE_DATE || type == SQL_TYPE_TIME ||
+      type == SQL_TYPE_TIMESTAMP)
+  {
+    row[14]= row[4];    /* SQL_DATETIME_SUB */
+    sprintf(buff, "%d", SQL_DATETIME);
+    row[13]= strdup_root(alloc, buff); /* SQL_DATA_TYPE */
+  }
+  else
+  {
+    row[13]= row[4];    /* SQL_DATA_TYPE */
+    row[14]= NULL;      /* SQL_DATETIME_SUB */
+  }
+
+  /* COLUMN_SIZE */
+  fill_column_size_buff(buff, stmt, field);
+  row[6]= strdup_root(alloc, buff);
+
+  /* BUFFER_LENGTH */
+  sprintf(buff, "%ld", get_transfer_octet_length(stmt, field));
+  row[7]= strdup_root(alloc, buff);
+
+  if (is_char_sql_type(type) || is_wchar_sql_type(type) ||
+      is_binary_sql_type(type))
+  {
+    row[15]= strdup_root(alloc, buff); /* CHAR_OCTET_LENGTH */
+  }
+  else
+  {
+    row[15]= NULL;                     /* CHAR_OCTET_LENGTH */
+  }
+
+  {
+    SQLSMALLINT digits= get_decimal_digits(stmt, field);
+    if (digits != SQL_NO_TOTAL)
+    {
+      sprintf(buff, "%d", digits);
+      row[8]= strdup_root(alloc, buff);  /* DECIMAL_DIGITS */
+      row[9]= "10";                      /* NUM_PREC_RADIX */
+    }
+    else
+    {
+      row[8]= row[9]= NullS;             /* DECIMAL_DIGITS, NUM_PREC_RADIX */
+    }
+  }
+
+  /*
+    If a field is a TIMESTAMP, NULL can be stored to it (although it gets turned into
+    something else).
+
+    The same logic applies to fields with AUTO_INCREMENT_FLAG set.
+  */
+  if ((field->flags & NOT_NULL_FLAG) && !(field->type == MYSQL_TYPE_TIMESTAMP) &&
+      !(field->flags & AUTO_INCREMENT_FLAG))
+  {
+    /* Bug#31067. Access seems to try to put NULL value when not null field
+       is cleared. And that contradicts with its knowledge of that the field
+       is not nullable, and it yields an error. Here is a little trick for
+       such case - we don't tell Access the whole truth we know, and
+       return for such field SQL_NULLABLE_UNKNOWN instead*/
+    if (is_access)
+    {
+      sprintf(buff, "%d", SQL_NULLABLE_UNKNOWN);
+      row[10]= strdup_root(alloc, buff); /* NULLABLE */
+      row[17]= strdup_root(alloc, "NO");/* IS_NULLABLE */
+    }
+    else
+    {
+      sprintf(buff, "%d", SQL_NO_NULLS);
+      row[10]= strdup_root(alloc, buff); /* NULLABLE */
+      row[17]= strdup_root(alloc, "NO"); /* IS_NULLABLE */
+    }
+  }
+  else
+  {
+    sprintf(buff, "%d", SQL_NULLABLE);
+    row[10]= strdup_root(alloc, buff); /* NULLABLE */
+    row[17]= strdup_root(alloc, "YES");/* IS_NULLABLE */
+  }
+
+  row[11]= ""; /* REMARKS */
+
+  /*
+    The default value of the column. The value in this column should be
+    interpreted as a string if it is enclosed in quotation marks.
+
+    if NULL was specified as the default value, then this column is the
+    word NULL, not enclosed in quotation marks. If the default value
+    cannot be represented without truncation, then this column contains
+    TRUNCATED, with no enclosing single quotation marks. If no default
+    value was specified, then this column is NULL.
+
+    The value of COLUMN_DEF can be used in generating a new column
+    definition, except when it contains the value TRUNCATED
+  */
+  if (!field->def)
+    row[12]= NullS; /* COLUMN_DEF */
+  else
+  {
+    if (field->type == MYSQL_TYPE_TIMESTAMP &&
+        !strcmp(field->def,"0000-00-00 00:00:00"))
+    {
+      row[12]= NullS; /* COLUMN_DEF */
+    }
+    else
+    {
+      char *def= alloc_root(alloc, strlen(field->def) + 3);
+      if (is_numeric_mysql_type(field))
+      {
+        sprintf(def, "%s", field->def);
+      }
+      else
+      {
+        sprintf(def, "'%s'", field->def);
+      }
+      row[12]= def; /* COLUMN_DEF */
+    }
+  }
+
+  sprintf(buff, "%d", ordinal);
+  row[16]= strdup_root(alloc, buff); /* ORDINAL_POSITION */
+}
+
+
+/**
+  Put a pattern-value argument into a quoted string literal of LIKE. The
+  server leaves \_ and \% in literals alone, so the escapes of the pattern
+  reach LIKE as they are. Other backslashes and the quotes are escaped, and
+  multibyte characters are copied whole.
+
+  @param[in]  mysql   Connection the literal is sent to
+  @param[out] to      Buffer of at least 2 * length + 1 bytes
+  @param[in]  from    The pattern
+  @param[in]  length  Length of the pattern
+
+  @return Length of the escaped pattern
+*/
+static ulong escape_like_pattern(MYSQL *mysql, char *to, const char *from,
+                                 ulong length)
+{
+  const char *to_start= to, *end= from + length;
+  my_bool no_backslash_escapes=
+    (mysql->server_status & SERVER_STATUS_NO_BACKSLASH_ESCAPES) != 0;
+
+  while (from < end)
+  {
+    int mb_length= use_mb(mysql->charset)
+                   ? my_ismbchar(mysql->charset, from, end) : 0;
 
-  @return Result of mysql_list_fields, or NULL if there is an error
+    if (mb_length)
+    {
+      memcpy(to, from, mb_length);
+      to+= mb_length;
+      from+= mb_length;
+      continue;
+    }
+
+    if (*from == '\\' && !no_backslash_escapes)
+    {
+      *to++= *from++;
+      if (from == end || (*from != '_' && *from != '%'))
+      {
+        *to++= '\\';
+      }
+      continue;
+    }
+
+    if (*from == '\'')
+    {
+      *to++= '\'';
+    }
+    *to++= *from++;
+  }
+
+  *to= '\0';
+  return (ulong)(to - to_start);
+}
+
+
+/**
+  Whether the error of a statement about a single table, like an invalid
+  view or a table dropped since it was listed, leaves the connection usable
+  for the other tables.
 */
-static MYSQL_RES *
-server_list_dbcolumns(STMT *stmt,
-                      SQLCHAR *szCatalog, SQLSMALLINT cbCatalog,
-                      SQLCHAR *szTable, SQLSMALLINT cbTable,
-                      SQLCHAR *szColumn, SQLSMALLINT cbColumn)
+static BOOL is_table_error(MYSQL *mysql)
+{
+  unsigned int error= mysql_errno(mysql);
+
+  return error != 0 && (error < CR_MIN_ERROR || error > CR_MAX_ERROR)
+      && error != ER_QUERY_INTERRUPTED;
+}
+
+
+/**
+  Get the columns of one table with mysql_list_fields(). That is for a table
+  the batch could not SELECT from, because the user has privileges on some
+  of its columns only; the server lists the columns the user can see.
+  Caller holds dbc->lock.
+
+  @param[in]     stmt       Statement
+  @param[in]     table      Name of the table
+  @param[in]     szCatalog  Name of catalog (database)
+  @param[in]     cbCatalog  Length of catalog
+  @param[in]     wild       Pattern of column names, "" for all
+  @param[in]     db         TABLE_CAT value
+  @param[in]     is_access  Whether the application is MS Access
+  @param[in,out] next_row   Number of rows in stmt->result_array
+
+  @return SQL_SUCCESS, or SQL_ERROR (and diag is set)
+*/
+static SQLRETURN
+columns_list_fields(STMT *stmt, const char *table, SQLCHAR *szCatalog,
+                    SQLSMALLINT cbCatalog, const char *wild, char *db,
+                    BOOL is_access, unsigned long *next_row)
 {
   DBC *dbc= stmt->dbc;
   MYSQL *mysql= &dbc->mysql;
-  MYSQL_RES *result;
-  char buff[NAME_LEN * 2 + 64], column_buff[NAME_LEN * 2 + 64];
+  MYSQL_RES *res;
+  MYSQL_FIELD *field;
+  char catalog[NAME_LEN + 1];
+  BOOL change_db, table_error;
+  int ordinal= 0;
+
+  strmake(catalog, (char *)szCatalog, cbCatalog);
+  change_db= cbCatalog && (dbc->database == NULL
+                           || strcmp(catalog, dbc->database));
+
+  /* mysql_list_fields() works in the current database, and if there is
+     none it could not be restored. The table is skipped then */
+  if (change_db && dbc->database == NULL)
+  {
+    return SQL_SUCCESS;
+  }
 
-  /* If a catalog was specified, we have to change working catalog
-     to be able to use mysql_list_fields. */
-  if (cbCatalog)
+  if (change_db && mysql_select_db(mysql, catalog))
   {
-    if (reget_current_catalog(dbc))
-      return NULL;
+    return is_table_error(mysql) ? SQL_SUCCESS
+                                 : handle_connection_error(stmt);
+  }
+
+  res= mysql_list_fields(mysql, table, wild);
+  table_error= res == NULL && is_table_error(mysql);
+
+  if (change_db && mysql_select_db(mysql, dbc->database))
+  {
+    if (res)
+      mysql_free_result(res);
+    return handle_connection_error(stmt);
+  }
+
+  if (res == NULL)
+  {
+    return table_error ? SQL_SUCCESS : handle_connection_error(stmt);
+  }
+
+  stmt->result_array= (char **)myodbc_realloc((char *)stmt->result_array,
+                                          sizeof(char *) *
+                                          SQLCOLUMNS_FIELDS *
+                                          (*next_row + mysql_num_fields(res)),
+                                          MYF(MY_ALLOW_ZERO_PTR));
+  if (!stmt->result_array)
+  {
+    mysql_free_result(res);
+    set_mem_error(mysql);
+    return handle_connection_error(stmt);
+  }
+
+  while ((field= mysql_fetch_field(res)))
+  {
+    fill_column_row(stmt, field, db, is_access, ++ordinal,
+                    stmt->result_array + SQLCOLUMNS_FIELDS * (*next_row)++);
+  }
 
-    /* reget_current_catalog locks and release mutex, so locking
-       here again */
-    myodbc_mutex_lock(&dbc->lock);
+  mysql_free_result(res);
 
-    strncpy(buff, szCatalog, cbCatalog);
-    buff[cbCatalog]= '\0';
+  return SQL_SUCCESS;
+}
+
+
+/**
+  Get the columns of a batch of tables in one request. For every table
+  SHOW COLUMNS gives the columns matching the pattern with their defaults,
+  and SELECT ... LIMIT 0 gives their metadata. Caller holds dbc->lock, and
+  multi-statements have to be enabled.
+
+  The server does not execute the statements after one that fails. If that
+  is an error of the table only, the table is skipped and the batch ends
+  with it, so the caller can ask for the rest of the tables again. A table
+  that can't be read by SELECT for the lack of privileges on all of its
+  columns gets its columns from mysql_list_fields() instead.
+
+  @param[in]     stmt       Statement
+  @param[in]     tables     Rows of the table list, name is the 1st column
+  @param[in]     lengths    Lengths of the table names
+  @param[in]     count      Number of tables
+  @param[in]     szCatalog  Name of catalog (database)
+  @param[in]     cbCatalog  Length of catalog
+  @param[in]     pattern    Escaped pattern of column names, "" for all
+  @param[in]     wild       Pattern of column names as given, "" for all
+  @param[in]     db         TABLE_CAT value
+  @param[in]     is_access  Whether the application is MS Access
+  @param[in,out] next_row   Number of rows in stmt->result_array
+  @param[out]    done       Number of tables done or skipped
+
+  @return SQL_SUCCESS, or SQL_ERROR (and diag is set)
+*/
+static SQLRETURN
+columns_batch(STMT *stmt, MYSQL_ROW *tables, unsigned long *lengths,
+              uint count, SQLCHAR *szCatalog, SQLSMALLINT cbCatalog,
+              const char *pattern, const char *wild, char *db,
+              BOOL is_access, unsigned long *next_row, uint *done)
+{
+  MYSQL *mysql= &stmt->dbc->mysql;
+  DYNAMIC_STRING query;
+  char catalog[NAME_LEN + 1];
+  uint i, denied= count;
+  SQLRETURN rc= SQL_SUCCESS;
 
-    if (mysql_select_db(mysql, buff))
+  if (init_dynamic_string(&query, "", 1024, 1024))
+  {
+    set_mem_error(mysql);
+    return handle_connection_error(stmt);
+  }
+
+  strmake(catalog, (char *)szCatalog, cbCatalog);
+
+  for (i= 0; i < count; ++i)
+  {
+    char table[NAME_LEN + 1];
+    strmake(table, tables[i][0], myodbc_min(lengths[i], NAME_LEN));
+
+    if (i)
     {
-      myodbc_mutex_unlock(&dbc->lock);
-      return NULL;
+      dynstr_append_mem(&query, ";", 1);
     }
+    dynstr_append_mem(&query, "SHOW COLUMNS FROM ", 18);
+    dynstr_append_quoted_name(&query, table);
+    if (cbCatalog)
+    {
+      dynstr_append_mem(&query, " FROM ", 6);
+      dynstr_append_quoted_name(&query, catalog);
+    }
+    if (*pattern)
+    {
+      dynstr_append_mem(&query, " LIKE '", 7);
+      dynstr_append(&query, pattern);
+      dynstr_append_mem(&query, "'", 1);
+    }
+
+    dynstr_append_mem(&query, ";SELECT * FROM ", 15);
+    if (cbCatalog)
+    {
+      dynstr_append_quoted_name(&query, catalog);
+      dynstr_append_mem(&query, ".", 1);
+    }
+    dynstr_append_quoted_name(&query, table);
+    dynstr_append_mem(&query, " LIMIT 0", 8);
   }
-  else
-    myodbc_mutex_lock(&dbc->lock);
 
-  strncpy(buff, szTable, cbTable);
-  buff[cbTable]= '\0';
-  strncpy(column_buff, szColumn, cbColumn);
-  column_buff[cbColumn]= '\0';
+  MYLOG_QUERY(stmt, query.str);
+
+  *done= count;
 
-  result= mysql_list_fields(mysql, buff, column_buff);
+  if (exec_stmt_query(stmt, query.str, query.length, FALSE))
+  {
+    dynstr_free(&query);
+
+    if (is_table_error(mysql))
+    {
+      *done= 1;
+      return SQL_SUCCESS;
+    }
+    return handle_connection_error(stmt);
+  }
+  dynstr_free(&query);
 
-  /* If before this call no database were selected - we cannot revert that */
-  if (cbCatalog && dbc->database)
+  for (i= 0; i < count; ++i)
   {
-    if (mysql_select_db( mysql, dbc->database))
+    MYSQL_RES *columns_res= NULL, *table_res= NULL;
+    MYSQL_FIELD *field;
+    MYSQL_ROW column_row;
+    int ordinal= 0;
+
+    if (!(columns_res= mysql_store_result(mysql))
+      || mysql_next_result(mysql)
+      || !(table_res= mysql_store_result(mysql)))
     {
-      /* Well, probably have to return error here */
-      mysql_free_result(result);
-      myodbc_mutex_unlock(&dbc->lock);
-      return NULL;
+      if (columns_res)
+        mysql_free_result(columns_res);
+
+      if (is_table_error(mysql))
+      {
+        *done= i + 1;
+
+        /* SHOW COLUMNS has listed the columns the user can see */
+        if (columns_res && (mysql_errno(mysql) == ER_TABLEACCESS_DENIED_ERROR
+                          || mysql_errno(mysql) == ER_COLUMNACCESS_DENIED_ERROR))
+        {
+          denied= i;
+        }
+      }
+      else
+        rc= handle_connection_error(stmt);
+      break;
+    }
+
+    stmt->result_array= (char **)myodbc_realloc((char *)stmt->result_array,
+                                            sizeof(char *) *
+                                            SQLCOLUMNS_FIELDS *
+                                            (*next_row +
+                                             mysql_num_rows(columns_res)),
+                                            MYF(MY_ALLOW_ZERO_PTR));
+    if (!stmt->result_array)
+    {
+      mysql_free_result(columns_res);
+      mysql_free_result(table_res);
+      set_mem_error(mysql);
+      rc= handle_connection_error(stmt);
+      break;
+    }
+
+    /* Both list the columns in the table order */
+    column_row= mysql_fetch_row(columns_res);
+    while (column_row && (field= mysql_fetch_field(table_res)))
+    {
+      if (strcmp(field->name, column_row[0]))
+      {
+        continue;
+      }
+
+      field->def= column_row[4];
+      fill_column_row(stmt, field, db, is_access, ++ordinal,
+                      stmt->result_array + SQLCOLUMNS_FIELDS * (*next_row)++);
+      column_row= mysql_fetch_row(columns_res);
+    }
+
+    mysql_free_result(columns_res);
+    mysql_free_result(table_res);
+
+    /* The last SELECT has no more results after it */
+    if (i < count - 1 && mysql_next_result(mysql))
+    {
+      if (is_table_error(mysql))
+        *done= i + 2;
+      else
+        rc= handle_connection_error(stmt);
+      break;
     }
   }
-  myodbc_mutex_unlock(&dbc->lock);
 
-  return result;
+  /* Results after an error are not sent, others have to be read */
+  while (!mysql_next_result(mysql))
+  {
+    MYSQL_RES *res= mysql_store_result(mysql);
+    if (res)
+      mysql_free_result(res);
+  }
+
+  if (denied < count)
+  {
+    char table[NAME_LEN + 1];
+    strmake(table, tables[denied][0], myodbc_min(lengths[denied], NAME_LEN));
+
+    rc= columns_list_fields(stmt, table, szCatalog, cbCatalog, wild, db,
+                            is_access, next_row);
+  }
+
+  return rc;
 }
 
 
@@ -260,12 +692,16 @@ columns_no_i_s(STMT * stmt, SQLCHAR *szCatalog, SQLSMALLINT cbCatalog,
                SQLCHAR *szColumn, SQLSMALLINT cbColumn)
 
 {
+  DBC *dbc= stmt->dbc;
+  MYSQL *mysql= &dbc->mysql;
   MYSQL_RES *res;
-  MEM_ROOT *alloc;
-  MYSQL_ROW table_row;
-  unsigned long rows= 0, next_row= 0, *lengths;
-  char *db= NULL;
+  MYSQL_ROW tables[COLUMNS_BATCH_TABLES];
+  unsigned long lengths[COLUMNS_BATCH_TABLES], next_row= 0;
+  char *db= NULL, pattern[NAME_LEN * 2 + 1], wild[NAME_LEN + 1];
+  uint count, done, i;
   BOOL is_access= FALSE;
+  my_bool multi_statements_off= !dbc->ds->allow_multiple_statements;
+  SQLRETURN rc= SQL_SUCCESS;
 
   if (cbColumn > NAME_LEN || cbTable > NAME_LEN || cbCatalog > NAME_LEN)
   {
@@ -273,22 +709,21 @@ columns_no_i_s(STMT * stmt, SQLCHAR *szCatalog, SQLSMALLINT cbCatalog,
   }
 
   /* Get the list of tables that match szCatalog and szTable */
-  myodbc_mutex_lock(&stmt->dbc->lock);
+  lock_dbc(dbc);
   res= table_status(stmt, szCatalog, cbCatalog, szTable, cbTable, TRUE,
                     TRUE, TRUE);
 
-  if (!res && mysql_errno(&stmt->dbc->mysql))
+  if (!res && mysql_errno(mysql))
   {
-    SQLRETURN rc= handle_connection_error(stmt);
-    myodbc_mutex_unlock(&stmt->dbc->lock);
+    rc= handle_connection_error(stmt);
+    myodbc_mutex_unlock(&dbc->lock);
     return rc;
   }
   else if (!res)
   {
-    myodbc_mutex_unlock(&stmt->dbc->lock);
+    myodbc_mutex_unlock(&dbc->lock);
     goto empty_set;
   }
-  myodbc_mutex_unlock(&stmt->dbc->lock);
 
 #ifdef _WIN32
   if (GetModuleHandle("msaccess.exe") != NULL)
@@ -296,185 +731,52 @@ columns_no_i_s(STMT * stmt, SQLCHAR *szCatalog, SQLSMALLINT cbCatalog,
 #endif
 
   stmt->result= res;
-  alloc= &stmt->alloc_root;
 
-  if (!stmt->dbc->ds->no_catalog)
-    db= strmake_root(alloc, (char *)szCatalog, cbCatalog);
+  if (!dbc->ds->no_catalog)
+    db= strmake_root(&stmt->alloc_root, (char *)szCatalog, cbCatalog);
 
-  while ((table_row= mysql_fetch_row(res)))
-  {
-    MYSQL_FIELD *field;
-    MYSQL_RES *table_res;
-    int count= 0;
+  escape_like_pattern(mysql, pattern, (char *)szColumn, cbColumn);
+  strmake(wild, (char *)szColumn, cbColumn);
 
-    /* Get list of columns matching szColumn for each table. */
-    lengths= mysql_fetch_lengths(res);
-    table_res= server_list_dbcolumns(stmt, szCatalog, cbCatalog,
-                                     (SQLCHAR *)table_row[0],
-                                     (SQLSMALLINT)lengths[0],
-                                     szColumn, cbColumn);
+  /* Columns of many tables are asked for in one request */
+  if (multi_statements_off
+    && mysql_set_server_option(mysql, MYSQL_OPTION_MULTI_STATEMENTS_ON))
+  {
+    rc= handle_connection_error(stmt);
+    myodbc_mutex_unlock(&dbc->lock);
+    return rc;
+  }
 
-    if (!table_res)
+  do
+  {
+    for (count= 0; count < COLUMNS_BATCH_TABLES &&
+                   (tables[count]= mysql_fetch_row(res)); ++count)
     {
-      return handle_connection_error(stmt);
+      lengths[count]= mysql_fetch_lengths(res)[0];
     }
 
-    rows+= mysql_num_fields(table_res);
-
-    stmt->result_array= (char **)myodbc_realloc((char *)stmt->result_array,
-                                            sizeof(char *) *
-                                            SQLCOLUMNS_FIELDS * rows,
-                                            MYF(MY_ALLOW_ZERO_PTR));
-    if (!stmt->result_array)
+    for (i= 0; i < count && rc == SQL_SUCCESS; i+= done)
     {
-      set_mem_error(&stmt->dbc->mysql);
-      return handle_connection_error(stmt);
+      rc= columns_batch(stmt, tables + i, lengths + i, count - i, szCatalog,
+                        cbCatalog, pattern, wild, db, is_access, &next_row,
+                        &done);
     }
+  } while (count == COLUMNS_BATCH_TABLES && rc == SQL_SUCCESS);
 
-    while ((field= mysql_fetch_field(table_res)))
-    {
-      SQLSMALLINT type;
-      char buff[255]; /* @todo justify the size of this buffer */
-      MYSQL_ROW row= stmt->result_array + (SQLCOLUMNS_FIELDS * next_row++);
-
-      row[0]= db;                     /* TABLE_CAT */
-      row[1]= NULL;                   /* TABLE_SCHEM */
-      row[2]= strdup_root(alloc, field->table); /* TABLE_NAME */
-      row[3]= strdup_root(alloc, field->name);  /* COLUMN_NAME */
-
-      type= get_sql_data_type(stmt, field, buff);
-
-      row[5]= strdup_root(alloc, buff); /* TYPE_NAME */
-
-      sprintf(buff, "%d", type);
-      row[4]= strdup_root(alloc, buff); /* DATA_TYPE */
-
-      if (type == SQL_TYPE_DATE || type == SQL_TYPE_TIME ||
-          type == SQL_TYPE_TIMESTAMP)
-      {
-        row[14]= row[4];    /* SQL_DATETIME_SUB */
-        sprintf(buff, "%d", SQL_DATETIME);
-        row[13]= strdup_root(alloc, buff); /* SQL_DATA_TYPE */
-      }
-      else
-      {
-        row[13]= row[4];    /* SQL_DATA_TYPE */
-        row[14]= NULL;      /* SQL_DATETIME_SUB */
-      }
-
-      /* COLUMN_SIZE */
-      fill_column_size_buff(buff, stmt, field);
-      row[6]= strdup_root(alloc, buff);
-
-      /* BUFFER_LENGTH */
-      sprintf(buff, "%ld", get_transfer_octet_length(stmt, field));
-      row[7]= strdup_root(alloc, buff);
-
-      if (is_char_sql_type(type) || is_wchar_sql_type(type) ||
-          is_binary_sql_type(type))
-      {
-        row[15]= strdup_root(alloc, buff); /* CHAR_OCTET_LENGTH */
-      }
-      else
-      {
-        row[15]= NULL;                     /* CHAR_OCTET_LENGTH */
-      }
-
-      {
-        SQLSMALLINT digits= get_decimal_digits(stmt, field);
-        if (digits != SQL_NO_TOTAL)
-        {
-          sprintf(buff, "%d", digits);
-          row[8]= strdup_root(alloc, buff);  /* DECIMAL_DIGITS */
-          row[9]= "10";                      /* NUM_PREC_RADIX */
-        }
-        else
-        {
-          row[8]= row[9]= NullS;             /* DECIMAL_DIGITS, NUM_PREC_RADIX */
-        }
-      }
-
-      /*
-        If a field is a TIMESTAMP, NULL can be stored to it (although it gets turned into
-        something else).
-
-        The same logic applies to fields with AUTO_INCREMENT_FLAG set.
-      */
-      if ((field->flags & NOT_NULL_FLAG) && !(field->type == MYSQL_TYPE_TIMESTAMP) &&
-          !(field->flags & AUTO_INCREMENT_FLAG))
-      {
-        /* Bug#31067. Access seems to try to put NULL value when not null field
-           is cleared. And that contradicts with its knowledge of that the field
-           is not nullable, and it yields an error. Here is a little trick for
-           such case - we don't tell Access the whole truth we know, and
-           return for such field SQL_NULLABLE_UNKNOWN instead*/
-        if (is_access)
-        {
-          sprintf(buff, "%d", SQL_NULLABLE_UNKNOWN);
-          row[10]= strdup_root(alloc, buff); /* NULLABLE */
-          row[17]= strdup_root(alloc, "NO");/* IS_NULLABLE */
-        }
-        else
-        {
-          sprintf(buff, "%d", SQL_NO_NULLS);
-          row[10]= strdup_root(alloc, buff); /* NULLABLE */
-          row[17]= strdup_root(alloc, "NO"); /* IS_NULLABLE */
-        }
-      }
-      else
-      {
-        sprintf(buff, "%d", SQL_NULLABLE);
-        row[10]= strdup_root(alloc, buff); /* NULLABLE */
-        row[17]= strdup_root(alloc, "YES");/* IS_NULLABLE */
-      }
-
-      row[11]= ""; /* REMARKS */
-
-      /*
-        The default value of the column. The value in this column should be
-        interpreted as a string if it is enclosed in quotation marks.
-
-        if NULL was specified as the default value, then this column is the
-        word NULL, not enclosed in quotation marks. If the default value
-        cannot be represented without truncation, then this column contains
-        TRUNCATED, with no enclosing single quotation marks. If no default
-        value was specified, then this column is NULL.
-
-        The value of COLUMN_DEF can be used in generating a new column
-        definition, except when it contains the value TRUNCATED
-      */
-      if (!field->def)
-        row[12]= NullS; /* COLUMN_DEF */
-      else
-      {
-        if (field->type == MYSQL_TYPE_TIMESTAMP &&
-            !strcmp(field->def,"0000-00-00 00:00:00"))
-        {
-          row[12]= NullS; /* COLUMN_DEF */
-        }
-        else
-        {
-          char *def= alloc_root(alloc, strlen(field->def) + 3);
-          if (is_numeric_mysql_type(field))
-          {
-            sprintf(def, "%s", field->def);
-          }
-          else
-          {
-            sprintf(def, "'%s'", field->def);
-          }
-          row[12]= def; /* COLUMN_DEF */
-        }
-      }
-
-      sprintf(buff, "%d", ++count);
-      row[16]= strdup_root(alloc, buff); /* ORDINAL_POSITION */
-    }
+  if (multi_statements_off
+    && mysql_set_server_option(mysql, MYSQL_OPTION_MULTI_STATEMENTS_OFF)
+    && rc == SQL_SUCCESS)
+  {
+    rc= handle_connection_error(stmt);
+  }
+  myodbc_mutex_unlock(&dbc->lock);
 
-    mysql_free_result(table_res);
+  if (rc != SQL_SUCCESS)
+  {
+    return rc;
   }
 
-  set_row_count(stmt, rows);
+  set_row_count(stmt, next_row);
   myodbc_link_fields(stmt, SQLCOLUMNS_fields, SQLCOLUMNS_FIELDS);
 
   return SQL_SUCCESS;
@@ -599,7 +901,7 @@ list_table_priv_no_i_s(SQLHSTMT hstmt,
     MEM_ROOT *alloc;
     uint     row_count;
 
-    myodbc_mutex_lock(&stmt->dbc->lock);
+    lock_dbc(stmt->dbc);
     stmt->result= table_privs_raw_data(stmt, catalog, catalog_len,
       table, table_len);
 
@@ -752,7 +1054,7 @@ list_column_priv_no_i_s(SQLHSTMT hstmt,
   CLEAR_STMT_ERROR(hstmt);
   my_SQLFreeStmt(hstmt,MYSQL_RESET);
 
-  myodbc_mutex_lock(&stmt->dbc->lock);
+  lock_dbc(stmt->dbc);
   stmt->result= column_privs_raw_data(stmt,
     catalog, catalog_len,
     table, table_len,
@@ -1101,7 +1403,7 @@ SQLRETURN foreign_keys_no_i_s(SQLHSTMT hstmt,
   myodbc_init_dynamic_array(&records, sizeof(MY_FOREIGN_KEY_FIELD), 0, 0);
 
   /* Get the list of tables that match szCatalog and szTable */
-  myodbc_mutex_lock(&stmt->dbc->lock);
+  lock_dbc(stmt->dbc);
   local_res= table_status(stmt, szFkCatalogName, cbFkCatalogName, szFkTableName, 
                     cbFkTableName, FALSE, TRUE, TRUE);
   if (!local_res && mysql_errno(&stmt->dbc->mysql))
@@ -1118,7 +1420,7 @@ SQLRETURN foreign_keys_no_i_s(SQLHSTMT hstmt,
 
   while ((table_row = mysql_fetch_row(local_res)))
   {
-    myodbc_mutex_lock(&stmt->dbc->lock);
+    lock_dbc(stmt->dbc);
     lengths = mysql_fetch_lengths(local_res);
     if (stmt->result)
       mysql_free_result(stmt->result);
@@ -1529,7 +1831,7 @@ primary_keys_no_i_s(SQLHSTMT hstmt,
     char      **data;
     uint      row_count;
 
-    myodbc_mutex_lock(&stmt->dbc->lock);
+    lock_dbc(stmt->dbc);
     if (!(stmt->result= server_list_dbkeys(stmt, catalog, catalog_len,
                                            table, table_len)))
     {
@@ -1747,7 +2049,7 @@ procedure_columns_no_i_s(SQLHSTMT hstmt,
   }
 
   /* get procedures list */
-  myodbc_mutex_lock(&stmt->dbc->lock);
+  lock_dbc(stmt->dbc);
 
   if (!(proc_list_res= server_list_proc_params(stmt, 
       szCatalogName, cbCatalogName, szProcName, cbProcName)))
@@ -1949,7 +2251,7 @@ procedure_columns_no_i_s(SQLHSTMT hstmt,
 
   if (cbColumnName)
   {
-    myodbc_mutex_lock(&stmt->dbc->lock);
+    lock_dbc(stmt->dbc);
     if (exec_stmt_query(stmt, dynQuery.str, (unsigned long)dynQuery.length, FALSE) ||
         !(columns_res= mysql_store_result(&stmt->dbc->mysql)))
     {
@@ -2316,7 +2618,7 @@ statistics_no_i_s(SQLHSTMT hstmt,
     if (!table_len)
         goto empty_set;
 
-    myodbc_mutex_lock(&dbc->lock);
+    lock_dbc(dbc);
     stmt->result= server_list_dbkeys(stmt, catalog, catalog_len,
                                      table, table_len);
     if (!stmt->result)
@@ -2433,7 +2735,7 @@ tables_no_i_s(SQLHSTMT hstmt,
         || (catalog && (!server_has_i_s(stmt->dbc) || 
                         stmt->dbc->ds->no_information_schema))))
     {
-      myodbc_mutex_lock(&stmt->dbc->lock);
+      lock_dbc(stmt->dbc);
       {
         char buff[32 + NAME_LEN * 2], *to;
         to= myodbc_stpmov(buff, "SHOW DATABASES LIKE '");
@@ -2535,7 +2837,7 @@ tables_no_i_s(SQLHSTMT hstmt,
       while (catalog_res && (catalog_row= mysql_fetch_row(catalog_res)) 
              || is_info_schema)
       {
-        myodbc_mutex_lock(&stmt->dbc->lock);
+        lock_dbc(stmt->dbc);
 
         if (is_info_schema)
         {
@@ -30,6 +30,7 @@
 #include "driver.h"
 #include "installer.h"
 #include "stringutil.h"
+#include "errmsg.h"
 
 #ifndef CLIENT_NO_SCHEMA
 # define CLIENT_NO_SCHEMA      16
@@ -139,6 +140,250 @@ SQLRETURN myodbc_set_initial_character_set(DBC *dbc, const char *charset)
 }
 
 
+/**
+  Set SSL/TLS options of a connection handle as configured in the data
+  source.
+
+  @param[in]  mysql  Connection handle, not connected yet
+  @param[in]  ds     Data source information
+*/
+static void set_ssl_options(MYSQL *mysql, DataSource *ds)
+{
+  /* Use 'int' and fill all bits to avoid alignment Bug#25920 */
+  unsigned int opt_ssl_verify_server_cert = ~0;
+#if MYSQL_VERSION_ID >= 50703
+  const my_bool on= 1;
+#endif
+
+  /* set SSL parameters */
+  mysql_ssl_set(mysql,
+                ds_get_utf8attr(ds->sslkey,    &ds->sslkey8),
+                ds_get_utf8attr(ds->sslcert,   &ds->sslcert8),
+                ds_get_utf8attr(ds->sslca,     &ds->sslca8),
+                ds_get_utf8attr(ds->sslcapath, &ds->sslcapath8),
+                ds_get_utf8attr(ds->sslcipher, &ds->sslcipher8));
+
+  if (ds->sslverify)
+    mysql_options(mysql, MYSQL_OPT_SSL_VERIFY_SERVER_CERT,
+                  (const char *)&opt_ssl_verify_server_cert);
+#if MYSQL_VERSION_ID >= 50660
+  if (ds->rsakey)
+  {
+    /* Read the public key on the client side */
+    mysql_options(mysql, MYSQL_SERVER_PUBLIC_KEY,
+                  ds_get_utf8attr(ds->rsakey, &ds->rsakey8));
+  }
+#endif
+#if MYSQL_VERSION_ID >= 50710
+  {
+    char tls_options[128] = { 0 };
+    if (ds->tls_1)
+    {
+      strcat(tls_options, "TLSv1");
+    }
+    if (!ds->no_tls_1_1)
+    {
+      strcat(tls_options, !ds->tls_1 ? "TLSv1.1" : ",TLSv1.1");
+    }
+    if (!ds->no_tls_1_2)
+    {
+      strcat(tls_options, !ds->tls_1 && ds->no_tls_1_1 ? "TLSv1.2" : ",TLSv1.2");
+    }
+    if (tls_options[0])
+      mysql_options(mysql, MYSQL_OPT_TLS_VERSION, tls_options);
+  }
+#endif
+
+  mysql->options.use_ssl = !ds->disable_ssl_default;
+#if MYSQL_VERSION_ID >= 50703
+  {
+    if (ds->ssl_enforce)
+    {
+      mysql_options(mysql, MYSQL_OPT_SSL_ENFORCE, (char *)&on);
+    }
+  }
+#endif
+
+#if MYSQL_VERSION_ID >= 50711
+  if (ds->sslmode)
+  {
+    unsigned int mode = 0;
+    ds_get_utf8attr(ds->sslmode, &ds->sslmode8);
+    if (!myodbc_strcasecmp(ODBC_SSL_MODE_DISABLED, ds->sslmode8))
+      mode = SSL_MODE_DISABLED;
+    if (!myodbc_strcasecmp(ODBC_SSL_MODE_PREFERRED, ds->sslmode8))
+      mode = SSL_MODE_PREFERRED;
+    if (!myodbc_strcasecmp(ODBC_SSL_MODE_REQUIRED, ds->sslmode8))
+      mode = SSL_MODE_REQUIRED;
+    if (!myodbc_strcasecmp(ODBC_SSL_MODE_VERIFY_CA, ds->sslmode8))
+      mode = SSL_MODE_VERIFY_CA;
+    if (!myodbc_strcasecmp(ODBC_SSL_MODE_VERIFY_IDENTITY, ds->sslmode8))
+      mode = SSL_MODE_VERIFY_IDENTITY;
+
+    // Don't do anything if there is no match with any of the available modes
+    if (mode)
+      mysql_options(mysql, MYSQL_OPT_SSL_MODE, &mode);
+  }
+#endif
+}
+
+
+/*
+  Pings a connection of the environment that has been idle for its
+  LIVENESS_INTERVAL, if there is one. Connections busy with a statement are
+  not idle and are skipped. Called with env->lock held, which is released
+  for the ping.
+
+  @param[in]  env   Environment
+  @param[out] wait  Seconds till the next check is due, 0 if no connection
+                    is monitored
+
+  @return TRUE if a connection has been pinged, and the list has to be
+          scanned again
+*/
+static BOOL env_monitor_check(ENV *env, unsigned long *wait)
+{
+  time_t now= time(NULL);
+  LIST *item;
+
+  *wait= 0;
+
+  for (item= env->connections; item != NULL; item= item->next)
+  {
+    DBC *dbc= (DBC *)item->data;
+    unsigned long due, interval= dbc->liveness_interval;
+
+    if (interval == 0)
+    {
+      continue;
+    }
+
+    due= interval;
+
+    if (!myodbc_mutex_trylock(&dbc->lock))
+    {
+      unsigned long idle= (unsigned long)(now - dbc->last_query_time);
+
+      if (idle < interval)
+      {
+        due= interval - idle;
+      }
+      /* Nothing may be sent while a result is being read */
+      else if (is_connected(dbc) && dbc->mysql.status == MYSQL_STATUS_READY
+               && !(dbc->mysql.server_status & SERVER_MORE_RESULTS_EXISTS))
+      {
+        my_bool reconnect= dbc->mysql.reconnect;
+
+        /* The connection can't be closed while its lock is held */
+        myodbc_mutex_unlock(&env->lock);
+
+        /* Reconnecting here would drop the session state and transaction
+           behind the application's back, see check_if_server_is_alive() */
+        dbc->mysql.reconnect= 0;
+        dbc->server_gone= mysql_ping(&dbc->mysql) &&
+                          (mysql_errno(&dbc->mysql) == CR_SERVER_LOST ||
+                           mysql_errno(&dbc->mysql) == CR_SERVER_GONE_ERROR);
+        dbc->mysql.reconnect= reconnect;
+        dbc->last_query_time= time(NULL);
+        ++dbc->liveness_pings;
+
+        myodbc_mutex_unlock(&dbc->lock);
+        myodbc_mutex_lock(&env->lock);
+
+        return TRUE;
+      }
+
+      myodbc_mutex_unlock(&dbc->lock);
+    }
+
+    *wait= *wait == 0 ? due : myodbc_min(*wait, due);
+  }
+
+  return FALSE;
+}
+
+
+static void * env_monitor(void *arg)
+{
+  ENV *env= (ENV *)arg;
+  unsigned long wait;
+
+  mysql_thread_init();
+
+  myodbc_mutex_lock(&env->lock);
+
+  while (!env->monitor_stop)
+  {
+    if (env_monitor_check(env, &wait))
+    {
+      continue;
+    }
+
+    /* Connections added to the monitor wake it up as well */
+    myodbc_cond_timedwait(&env->monitor_cond, &env->lock,
+                          wait > 0 ? wait * 1000 : 3600 * 1000);
+  }
+
+  myodbc_mutex_unlock(&env->lock);
+
+  mysql_thread_end();
+
+  return NULL;
+}
+
+
+/*
+  Makes the monitor of the environment check the connection whenever it is
+  idle for the given number of seconds. The monitor is started with the 1st
+  connection that asks for it. If it can't be started, the connection stays
+  unmonitored, and check_if_server_is_alive() pings it instead.
+*/
+static void env_monitor_add(DBC *dbc, unsigned int interval)
+{
+  ENV *env= dbc->env;
+
+  myodbc_mutex_lock(&env->lock);
+
+  if (!env->monitor_started)
+  {
+    myodbc_cond_init_timed(&env->monitor_cond);
+
+    if (myodbc_thread_create(&env->monitor, env_monitor, env))
+    {
+      myodbc_cond_destroy(&env->monitor_cond);
+      myodbc_mutex_unlock(&env->lock);
+      return;
+    }
+    env->monitor_started= TRUE;
+  }
+
+  dbc->server_gone= FALSE;
+  dbc->liveness_interval= interval;
+  myodbc_cond_signal(&env->monitor_cond);
+
+  myodbc_mutex_unlock(&env->lock);
+}
+
+
+/* Stops the monitor of the environment, if it has been started */
+void env_monitor_stop(ENV *env)
+{
+  if (!env->monitor_started)
+  {
+    return;
+  }
+
+  myodbc_mutex_lock(&env->lock);
+  env->monitor_stop= TRUE;
+  myodbc_cond_signal(&env->monitor_cond);
+  myodbc_mutex_unlock(&env->lock);
+
+  myodbc_thread_join(&env->monitor);
+  myodbc_cond_destroy(&env->monitor_cond);
+  env->monitor_started= FALSE;
+}
+
+
 /**
   Try to establish a connection to a MySQL server based on the data source
   configuration.
@@ -154,8 +399,6 @@ SQLRETURN myodbc_do_connect(DBC *dbc, DataSource *ds)
   SQLRETURN rc= SQL_SUCCESS;
   MYSQL *mysql= &dbc->mysql;
   unsigned long flags;
-  /* Use 'int' and fill all bits to avoid alignment Bug#25920 */
-  unsigned int opt_ssl_verify_server_cert = ~0;
   const my_bool on= 1;
   unsigned long max_long = ~0L;
 
@@ -233,44 +476,7 @@ SQLRETURN myodbc_do_connect(DBC *dbc, DataSource *ds)
   }
 #endif
 
-  /* set SSL parameters */
-  mysql_ssl_set(mysql,
-                ds_get_utf8attr(ds->sslkey,    &ds->sslkey8),
-                ds_get_utf8attr(ds->sslcert,   &ds->sslcert8),
-                ds_get_utf8attr(ds->sslca,     &ds->sslca8),
-                ds_get_utf8attr(ds->sslcapath, &ds->sslcapath8),
-                ds_get_utf8attr(ds->sslcipher, &ds->sslcipher8));
-
-  if (ds->sslverify)
-    mysql_options(mysql, MYSQL_OPT_SSL_VERIFY_SERVER_CERT,
-                  (const char *)&opt_ssl_verify_server_cert);
-#if MYSQL_VERSION_ID >= 50660
-  if (ds->rsakey)
-  {
-    /* Read the public key on the client side */
-    mysql_options(mysql, MYSQL_SERVER_PUBLIC_KEY,
-                  ds_get_utf8attr(ds->rsakey, &ds->rsakey8));
-  }
-#endif
-#if MYSQL_VERSION_ID >= 50710
-  {
-    char tls_options[128] = { 0 };
-    if (ds->tls_1)
-    {
-      strcat(tls_options, "TLSv1");
-    }
-    if (!ds->no_tls_1_1)
-    {
-      strcat(tls_options, !ds->tls_1 ? "TLSv1.1" : ",TLSv1.1");
-    }
-    if (!ds->no_tls_1_2)
-    {
-      strcat(tls_options, !ds->tls_1 && ds->no_tls_1_1 ? "TLSv1.2" : ",TLSv1.2");
-    }
-    if (tls_options[0])
-      mysql_options(mysql, MYSQL_OPT_TLS_VERSION, tls_options);
-  }
-#endif
+  set_ssl_options(mysql, ds);
 
 
   if (dbc->unicode)
@@ -322,38 +528,6 @@ SQLRETURN myodbc_do_connect(DBC *dbc, DataSource *ds)
   }
 #endif
 
-  mysql->options.use_ssl = !ds->disable_ssl_default;
-#if MYSQL_VERSION_ID >= 50703
-  {
-    if (ds->ssl_enforce)
-    {
-      mysql_options(mysql, MYSQL_OPT_SSL_ENFORCE, (char *)&on);
-    }
-  }
-#endif
-
-#if MYSQL_VERSION_ID >= 50711
-  if (ds->sslmode)
-  {
-    unsigned int mode = 0;
-    ds_get_utf8attr(ds->sslmode, &ds->sslmode8);
-    if (!myodbc_strcasecmp(ODBC_SSL_MODE_DISABLED, ds->sslmode8))
-      mode = SSL_MODE_DISABLED;
-    if (!myodbc_strcasecmp(ODBC_SSL_MODE_PREFERRED, ds->sslmode8))
-      mode = SSL_MODE_PREFERRED;
-    if (!myodbc_strcasecmp(ODBC_SSL_MODE_REQUIRED, ds->sslmode8))
-      mode = SSL_MODE_REQUIRED;
-    if (!myodbc_strcasecmp(ODBC_SSL_MODE_VERIFY_CA, ds->sslmode8))
-      mode = SSL_MODE_VERIFY_CA;
-    if (!myodbc_strcasecmp(ODBC_SSL_MODE_VERIFY_IDENTITY, ds->sslmode8))
-      mode = SSL_MODE_VERIFY_IDENTITY;
-
-    // Don't do anything if there is no match with any of the available modes
-    if (mode)
-      mysql_options(mysql, MYSQL_OPT_SSL_MODE, &mode);
-  }
-#endif
-
   if (!mysql_real_connect(mysql,
                           ds_get_utf8attr(ds->server,   &ds->server8),
                           ds_get_utf8attr(ds->uid,      &ds->uid8),
@@ -437,7 +611,7 @@ SQLRETURN myodbc_do_connect(DBC *dbc, DataSource *ds)
   }
   
   if (ds->save_queries && !dbc->query_log)
-    dbc->query_log= init_query_log();
+    dbc->query_log= !query_log_open(ds);
 
   /* Set the statement error prefix based on the server version. */
   strxmov(dbc->st_error_prefix, MYODBC_ERROR_PREFIX, "[mysqld-",
@@ -516,6 +690,16 @@ SQLRETURN myodbc_do_connect(DBC *dbc, DataSource *ds)
   // for older versions just use net_buffer_length() macro
   dbc->net_buffer_len = net_buffer_length;
 #endif
+  /* Will be read from the server when needed */
+  dbc->server_max_packet= 0;
+
+  dbc->login_autocommit= autocommit_on(dbc) ? TRUE : FALSE;
+  dbc->login_txn_isolation= dbc->txn_isolation;
+
+  if (ds->liveness_interval > 0)
+  {
+    env_monitor_add(dbc, ds->liveness_interval);
+  }
   return rc;
 
 error:
@@ -524,6 +708,400 @@ error:
 }
 
 
+/**
+  Open one more connection to the server the DBC is connected to, for the
+  driver's internal use. The new connection uses the same account, default
+  database, SSL settings, init statement and character set, but shares no
+  other session state (transaction, temporary tables, variables) with
+  dbc->mysql.
+
+  @param[in]  dbc    Connected database connection
+  @param[out] mysql  Connection handle to initialize and connect
+
+  @return 0 on success, native error number otherwise. In case of error
+          mysql is closed already.
+*/
+unsigned int myodbc_connect_internal(DBC *dbc, MYSQL *mysql)
+{
+  DataSource *ds= dbc->ds;
+  unsigned int native_error;
+
+  mysql_init(mysql);
+
+  if (dbc->login_timeout)
+    mysql_options(mysql, MYSQL_OPT_CONNECT_TIMEOUT,
+                  (char *)&dbc->login_timeout);
+
+  if (ds->readtimeout)
+    mysql_options(mysql, MYSQL_OPT_READ_TIMEOUT,
+                  (const char *) &ds->readtimeout);
+
+  if (ds->writetimeout)
+    mysql_options(mysql, MYSQL_OPT_WRITE_TIMEOUT,
+                  (const char *) &ds->writetimeout);
+
+#if MYSQL_VERSION_ID >= 50507
+  if (ds->plugin_dir)
+  {
+    mysql_options(mysql, MYSQL_PLUGIN_DIR,
+                  ds_get_utf8attr(ds->plugin_dir, &ds->plugin_dir8));
+  }
+
+  if (ds->default_auth)
+  {
+    mysql_options(mysql, MYSQL_DEFAULT_AUTH,
+                  ds_get_utf8attr(ds->default_auth, &ds->default_auth8));
+  }
+#endif
+
+  set_ssl_options(mysql, ds);
+
+  /* Checked for SET NAMES when dbc->mysql was connected */
+  if (ds->initstmt && ds->initstmt[0])
+    mysql_options(mysql, MYSQL_INIT_COMMAND, ds->initstmt8);
+
+  mysql_options(mysql, MYSQL_SET_CHARSET_NAME, dbc->cxn_charset_info->csname);
+
+  if (!mysql_real_connect(mysql, ds->server8, ds->uid8, ds->pwd8,
+                          dbc->database, ds->port, ds->socket8,
+                          get_client_flags(ds) & ~CLIENT_MULTI_STATEMENTS)
+      /* Conversion of results is done by the driver, as on dbc->mysql */
+      || mysql_real_query(mysql, "SET character_set_results = NULL", 32))
+  {
+    native_error= mysql_errno(mysql);
+    mysql_close(mysql);
+    return native_error ? native_error : CR_UNKNOWN_ERROR;
+  }
+
+  return 0;
+}
+
+
+/*
+  Key of the cancel channel to the server and account of the data source:
+  its port, server, socket, user, password, SSL settings and RSA key,
+  plugin directory and default authentication plugin, each string terminated by \0. Data
+  sources that differ in any of them do not share a channel. The UTF-8
+  values are set when the DBC connects. Returns NULL if out of memory.
+*/
+static char * cancel_channel_key(DataSource *ds, size_t *key_length)
+{
+  const char *parts[13];
+  char *key, *pos;
+  uint i;
+
+  parts[0]=  (char *)ds->server8;
+  parts[1]=  (char *)ds->socket8;
+  parts[2]=  (char *)ds->uid8;
+  parts[3]=  (char *)ds->pwd8;
+  parts[4]=  (char *)ds->sslmode8;
+  parts[5]=  (char *)ds->sslkey8;
+  parts[6]=  (char *)ds->sslcert8;
+  parts[7]=  (char *)ds->sslca8;
+  parts[8]=  (char *)ds->sslcapath8;
+  parts[9]=  (char *)ds->sslcipher8;
+  parts[10]= (char *)ds->plugin_dir8;
+  parts[11]= (char *)ds->default_auth8;
+  parts[12]= (char *)ds->rsakey8;
+
+  *key_length= sizeof(ds->port) + sizeof(ds->sslverify);
+  for (i= 0; i < array_elements(parts); ++i)
+  {
+    *key_length+= (parts[i] ? strlen(parts[i]) : 0) + 1;
+  }
+
+  if (!(key= myodbc_malloc(*key_length, MYF(0))))
+  {
+    return NULL;
+  }
+
+  memcpy(key, &ds->port, sizeof(ds->port));
+  pos= key + sizeof(ds->port);
+  memcpy(pos, &ds->sslverify, sizeof(ds->sslverify));
+  pos+= sizeof(ds->sslverify);
+  for (i= 0; i < array_elements(parts); ++i)
+  {
+    pos= myodbc_stpmov(pos, parts[i] ? parts[i] : "") + 1;
+  }
+
+  return key;
+}
+
+
+/**
+  Kill the query running on a connection, through the environment's cancel
+  channel to the server and account of the DBC (see MY_CANCEL_CHANNEL). The
+  channel is opened by the 1st cancel with the DBC's SSL settings, and again
+  if the server has closed it since.
+
+  @param[in]  dbc        Connection whose data source the channel uses
+  @param[in]  thread_id  Server's id of the connection to cancel
+
+  @return 0 on success, native error number otherwise
+*/
+unsigned int env_cancel_query(DBC *dbc, unsigned long thread_id)
+{
+  ENV *env= dbc->env;
+  MY_CANCEL_CHANNEL *channel= NULL;
+  LIST *item;
+  char buff[48], *key;
+  size_t key_length;
+  unsigned int native_error= 0;
+  int attempt;
+
+  if (!(key= cancel_channel_key(dbc->ds, &key_length)))
+  {
+    return CR_OUT_OF_MEMORY;
+  }
+
+  myodbc_mutex_lock(&env->cancel_lock);
+
+  for (item= env->cancel_channels; item != NULL; item= item->next)
+  {
+    MY_CANCEL_CHANNEL *cached= (MY_CANCEL_CHANNEL *)item->data;
+
+    if (cached->key_length == key_length
+        && !memcmp(cached->key, key, key_length))
+    {
+      channel= cached;
+      break;
+    }
+  }
+
+  if (!channel)
+  {
+    if (!(channel= (MY_CANCEL_CHANNEL *)myodbc_malloc(sizeof(MY_CANCEL_CHANNEL),
+                                                      MYF(MY_ZEROFILL))))
+    {
+      myodbc_mutex_unlock(&env->cancel_lock);
+      x_free(key);
+      return CR_OUT_OF_MEMORY;
+    }
+
+    myodbc_mutex_init(&channel->lock, NULL);
+    channel->key= key;
+    channel->key_length= key_length;
+    key= NULL;
+    channel->list.data= channel;
+    env->cancel_channels= list_add(env->cancel_channels, &channel->list);
+  }
+
+  myodbc_mutex_unlock(&env->cancel_lock);
+  x_free(key);
+
+  /* Channels are freed only with the environment */
+  myodbc_mutex_lock(&channel->lock);
+
+  /* buff is always big enough because max length of %lu is 20 */
+  sprintf(buff, "KILL /*!50000 QUERY */ %lu", thread_id);
+
+  /* The server may have closed an idle channel, it is opened once again */
+  for (attempt= 0; attempt < 2; ++attempt)
+  {
+    if (!channel->connected)
+    {
+      if ((native_error= myodbc_connect_internal(dbc, &channel->mysql)))
+      {
+        break;
+      }
+      channel->connected= TRUE;
+    }
+
+    if (!mysql_real_query(&channel->mysql, buff, strlen(buff)))
+    {
+      native_error= 0;
+      break;
+    }
+
+    native_error= mysql_errno(&channel->mysql);
+    if (native_error != CR_SERVER_GONE_ERROR && native_error != CR_SERVER_LOST)
+    {
+      break;
+    }
+
+    mysql_close(&channel->mysql);
+    channel->connected= FALSE;
+  }
+
+  myodbc_mutex_unlock(&channel->lock);
+
+  return native_error;
+}
+
+
+/* Closes the cancel channels of the environment */
+void env_cancel_free(ENV *env)
+{
+  LIST *item;
+
+  while ((item= env->cancel_channels))
+  {
+    MY_CANCEL_CHANNEL *channel= (MY_CANCEL_CHANNEL *)item->data;
+
+    env->cancel_channels= list_delete(env->cancel_channels, item);
+
+    if (channel->connected)
+    {
+      mysql_close(&channel->mysql);
+    }
+    myodbc_mutex_destroy(&channel->lock);
+    x_free(channel->key);
+    x_free(channel);
+  }
+}
+
+
+static void * env_timer(void *arg)
+{
+  ENV *env= (ENV *)arg;
+
+  mysql_thread_init();
+
+  myodbc_mutex_lock(&env->timer_lock);
+
+  while (!env->timer_stop)
+  {
+    my_ulonglong now= myodbc_time_us(), wait= 0;
+    DBC *expired= NULL;
+    LIST *item;
+
+    for (item= env->timers; item != NULL; item= item->next)
+    {
+      DBC *dbc= (DBC *)item->data;
+
+      /* Killed already, waiting for the query to end */
+      if (dbc->query_deadline == 0)
+      {
+        continue;
+      }
+
+      if (dbc->query_deadline <= now)
+      {
+        expired= dbc;
+        break;
+      }
+
+      wait= wait == 0 ? dbc->query_deadline - now
+                      : myodbc_min(wait, dbc->query_deadline - now);
+    }
+
+    if (expired)
+    {
+      expired->query_deadline= 0;
+      expired->query_timed_out= TRUE;
+      env->timer_killing= expired;
+      myodbc_mutex_unlock(&env->timer_lock);
+
+      /* query_timer_stop() waits for it, expired stays connected */
+      env_cancel_query(expired, mysql_thread_id(&expired->mysql));
+
+      myodbc_mutex_lock(&env->timer_lock);
+      env->timer_killing= NULL;
+      myodbc_cond_broadcast(&env->timer_cond);
+      continue;
+    }
+
+    /* Deadlines added wake it up as well */
+    myodbc_cond_timedwait(&env->timer_cond, &env->timer_lock,
+                          wait > 0 ? (unsigned long)((wait + 999) / 1000)
+                                   : 3600 * 1000);
+  }
+
+  myodbc_mutex_unlock(&env->timer_lock);
+
+  mysql_thread_end();
+
+  return NULL;
+}
+
+
+/**
+  Start the timer of the query the connection is about to execute. If the
+  query is still running after the given number of seconds, the timer of
+  the environment kills it through the cancel channel. The timer thread is
+  started with the 1st query that has a timeout. Called with dbc->lock
+  held, query_timer_stop() has to be called when the query returns.
+
+  @return TRUE if the timer is running, FALSE if its thread can't be started
+*/
+my_bool query_timer_start(DBC *dbc, SQLULEN timeout)
+{
+  ENV *env= dbc->env;
+
+  myodbc_mutex_lock(&env->timer_lock);
+
+  if (!env->timer_started)
+  {
+    myodbc_cond_init_timed(&env->timer_cond);
+
+    if (myodbc_thread_create(&env->timer, env_timer, env))
+    {
+      myodbc_cond_destroy(&env->timer_cond);
+      myodbc_mutex_unlock(&env->timer_lock);
+      return FALSE;
+    }
+    env->timer_started= TRUE;
+  }
+
+  dbc->query_deadline= myodbc_time_us() + (my_ulonglong)timeout * 1000000;
+  dbc->query_timed_out= FALSE;
+  dbc->timer_list.data= dbc;
+  env->timers= list_add(env->timers, &dbc->timer_list);
+  myodbc_cond_broadcast(&env->timer_cond);
+
+  myodbc_mutex_unlock(&env->timer_lock);
+
+  return TRUE;
+}
+
+
+/**
+  Stop the timer of the query that has returned. If the timer is sending
+  a KILL for it, waits until the KILL is sent, so that it can't hit the
+  next query of the connection.
+
+  @return TRUE if the query has been killed by the timer
+*/
+my_bool query_timer_stop(DBC *dbc)
+{
+  ENV *env= dbc->env;
+  my_bool timed_out;
+
+  myodbc_mutex_lock(&env->timer_lock);
+
+  while (env->timer_killing == dbc)
+  {
+    myodbc_cond_wait(&env->timer_cond, &env->timer_lock);
+  }
+
+  env->timers= list_delete(env->timers, &dbc->timer_list);
+  timed_out= dbc->query_timed_out;
+
+  myodbc_mutex_unlock(&env->timer_lock);
+
+  return timed_out;
+}
+
+
+/* Stops the timer of the environment, if it has been started */
+void env_timer_stop(ENV *env)
+{
+  if (!env->timer_started)
+  {
+    return;
+  }
+
+  myodbc_mutex_lock(&env->timer_lock);
+  env->timer_stop= TRUE;
+  myodbc_cond_broadcast(&env->timer_cond);
+  myodbc_mutex_unlock(&env->timer_lock);
+
+  myodbc_thread_join(&env->timer);
+  myodbc_cond_destroy(&env->timer_cond);
+  env->timer_started= FALSE;
+}
+
+
 /**
   Establish a connection to a data source.
 
@@ -554,6 +1132,9 @@ SQLRETURN SQL_API MySQLConnect(SQLHDBC   hdbc,
                        "SQLConnect requires DSN and driver manager", 0);
 #else
 
+  if (async_dbc_poll(dbc, SQL_API_SQLCONNECT, &rc))
+    return rc;
+
   /* Can't connect if we're already connected. */
   if (is_connected(dbc))
     return set_conn_error(hdbc, MYERR_08002, NULL, 0);
@@ -575,6 +1156,10 @@ SQLRETURN SQL_API MySQLConnect(SQLHDBC   hdbc,
 
   ds_lookup(ds);
 
+  if (dbc->async_enable &&
+      async_dbc_start(dbc, SQL_API_SQLCONNECT, ds))
+    return SQL_STILL_EXECUTING;
+
   rc= myodbc_do_connect(dbc, ds);
 
   if (!dbc->ds)
@@ -635,6 +1220,20 @@ SQLRETURN SQL_API MySQLDriverConnect(SQLHDBC hdbc, SQLHWND hwnd,
   if (cbConnStrIn != SQL_NTS)
     szConnStrIn= sqlwchardup(szConnStrIn, cbConnStrIn);
 
+  /*
+    Calls made while the connection is being established pass the same
+    arguments again, the last one copies the connection string to the output
+  */
+  if (async_dbc_poll(dbc, SQL_API_SQLDRIVERCONNECT, &rc))
+  {
+    if (!SQL_SUCCEEDED(rc))
+      goto error;
+
+    ds_delete(ds);
+    ds= dbc->ds;
+    goto connected;
+  }
+
   /* Parse the incoming string */
   if (ds_from_kvpair(ds, szConnStrIn, (SQLWCHAR)';'))
   {
@@ -862,6 +1461,15 @@ SQLRETURN SQL_API MySQLDriverConnect(SQLHDBC hdbc, SQLHWND hwnd,
 
   }
 
+  /* Without prompting it is up to the workers */
+  if (!bPrompt && !ds->savefile && dbc->async_enable &&
+      async_dbc_start(dbc, SQL_API_SQLDRIVERCONNECT, ds))
+  {
+    ds= NULL;
+    rc= SQL_STILL_EXECUTING;
+    goto error;
+  }
+
   if ((rc= myodbc_do_connect(dbc, ds)) != SQL_SUCCESS)
   {
     goto error;
@@ -922,8 +1530,8 @@ error:
     x_free(szConnStrIn);
 
   driver_delete(pDriver);
-  /* delete data source unless connected */
-  if (!dbc->ds)
+  /* delete data source unless connected, or connecting */
+  if (ds && !dbc->ds)
     ds_delete(ds);
   x_free(prompt_instr);
 
@@ -938,6 +1546,7 @@ void free_connection_stmts(DBC *dbc)
   for (list_element= dbc->statements; list_element; list_element= next_element)
   {
       next_element= list_element->next;
+      async_wait((STMT *)list_element->data);
       my_SQLFreeStmt((SQLHSTMT)list_element->data, SQL_DROP);
   }
 }
@@ -956,15 +1565,39 @@ void free_connection_stmts(DBC *dbc)
 SQLRETURN SQL_API SQLDisconnect(SQLHDBC hdbc)
 {
   DBC *dbc= (DBC *) hdbc;
+  SQLRETURN rc;
 
   CHECK_HANDLE(hdbc);
 
+  if (async_dbc_poll(dbc, SQL_API_SQLDISCONNECT, &rc))
+    return rc;
+
+  if (dbc->async_enable &&
+      async_dbc_start(dbc, SQL_API_SQLDISCONNECT, NULL))
+    return SQL_STILL_EXECUTING;
+
+  return my_SQLDisconnect(dbc);
+}
+
+
+/* Body of SQLDisconnect(), run by an async worker as well */
+SQLRETURN my_SQLDisconnect(DBC *dbc)
+{
   free_connection_stmts(dbc);
-  
+
+  /* The monitor may be pinging the connection */
+  lock_dbc(dbc);
+  dbc->liveness_interval= 0;
+  ssps_cache_free(dbc);
+  catalog_cache_free(dbc);
   mysql_close(&dbc->mysql);
+  myodbc_mutex_unlock(&dbc->lock);
 
-  if (dbc->ds && dbc->ds->save_queries)
-    end_query_log(dbc->query_log);
+  if (dbc->query_log)
+  {
+    query_log_close();
+    dbc->query_log= FALSE;
+  }
 
   /* free allocated packet buffer */
   if (dbc->mysql.net.buff)
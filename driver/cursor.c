@@ -213,7 +213,7 @@ static my_bool have_field_in_result(const char *name, MYSQL_RES *result)
 
   @return  Whether a usable unique keys exists
 */
-static my_bool check_if_usable_unique_key_exists(STMT *stmt)
+my_bool check_if_usable_unique_key_exists(STMT *stmt)
 {
   char buff[NAME_LEN * 2 + 18], /* Possibly escaped name, plus text for query */
        *pos, *table;
@@ -238,7 +238,7 @@ static my_bool check_if_usable_unique_key_exists(STMT *stmt)
 
   MYLOG_QUERY(stmt, buff);
 
-  myodbc_mutex_lock(&stmt->dbc->lock);
+  lock_dbc(stmt->dbc);
   if (exec_stmt_query(stmt, buff, strlen(buff), FALSE) ||
       !(res= mysql_store_result(&stmt->dbc->mysql)))
   {
@@ -286,6 +286,358 @@ static my_bool check_if_usable_unique_key_exists(STMT *stmt)
 }
 
 
+/**
+  Check if the dynamic cursor of the statement can read its rowset again by
+  a unique key instead of executing the query again on every fetch: the
+  result is read from a single table, every column of it is a column of
+  the table and so are all parts of a unique key of the table.
+
+  @param[in]  stmt  Statement
+
+  @return  Whether keyset_refresh() can be used
+*/
+my_bool keyset_usable(STMT *stmt)
+{
+  MYCURSOR    *cursor= &stmt->cursor;
+  MYSQL_RES   *result= stmt->result;
+  MYSQL_FIELD *field;
+  uint         ncol, index;
+
+  if (cursor->keyset_validated)
+    return cursor->keyset_usable;
+
+  cursor->keyset_validated= TRUE;
+  cursor->keyset_usable= FALSE;
+
+  if (!result || !result->field_count || ssps_used(stmt) ||
+      stmt->fix_fields || stmt->result_array || scroller_exists(stmt) ||
+      if_forward_cache(stmt))
+    return FALSE;
+
+  for (ncol= 0; ncol < result->field_count; ++ncol)
+  {
+    field= result->fields + ncol;
+    if (!field->org_name || !field->org_name[0] ||
+        !field->org_table || !field->org_table[0] ||
+        strcmp(field->org_table, result->fields->org_table))
+      return FALSE;
+  }
+
+  if (!find_used_table(stmt) || !check_if_usable_unique_key_exists(stmt))
+    return FALSE;
+
+  for (index= 0; index < cursor->pk_count; ++index)
+  {
+    for (ncol= 0; ncol < result->field_count; ++ncol)
+    {
+      if (!myodbc_strcasecmp(cursor->pkcol[index].name,
+                             result->fields[ncol].org_name))
+        break;
+    }
+    cursor->keyset_columns[index]= ncol;
+  }
+
+  cursor->keyset_usable= TRUE;
+  return TRUE;
+}
+
+
+/**
+  Report a dynamic cursor, for which keyset_usable() is TRUE after the
+  statement has been executed, as keyset-driven, since rows inserted later
+  are not seen by it.
+
+  @param[in]  stmt  Statement
+  @param[in]  rc    Result of the execution
+
+  @return  SQL_SUCCESS_WITH_INFO with 01S02 for such cursors, rc otherwise
+*/
+SQLRETURN keyset_cursor_info(STMT *stmt, SQLRETURN rc)
+{
+  if (SQL_SUCCEEDED(rc) && if_dynamic_cursor(stmt) && stmt->result &&
+      keyset_usable(stmt))
+  {
+    return set_error(stmt, MYERR_01S02,
+                     "Cursor type changed to keyset-driven", 0);
+  }
+
+  return rc;
+}
+
+
+/**
+  Read the rows of the rowset starting at the current row of the result
+  again, with a query selecting them by the values of their unique keys.
+  Rows with a NULL in the key are left out, and come back unchanged.
+
+  The key values are compared by the server, with the collation of the key,
+  so a row comes back for the keys of the rowset the server considers equal
+  too. Numeric key values are written as numbers, others as strings. The query returns the position of each row in the rowset as an extra
+  last column, which maps the rows read to the rows of the rowset.
+
+  @param[in]  stmt  Statement, for which keyset_usable() is TRUE
+  @param[in]  rows  Number of rows in the rowset
+*/
+SQLRETURN keyset_refresh(STMT *stmt, SQLULEN rows)
+{
+  MYCURSOR        *cursor= &stmt->cursor;
+  MYSQL_RES       *result= stmt->result;
+  MYSQL_ROW_OFFSET position= mysql_row_tell(result);
+  DYNAMIC_STRING   query, key, in_list, when_list;
+  MYSQL_ROW        values;
+  unsigned long   *lengths;
+  SQLULEN          row, added= 0;
+  uint             ncol, index;
+  char            *buff= NULL;
+  ulong            buff_length= 0;
+  char             number[24];
+  SQLRETURN        rc= SQL_SUCCESS;
+
+  keyset_free(stmt);
+
+  if (!(cursor->keyset_offsets= (MYSQL_ROW_OFFSET *)
+        myodbc_malloc(sizeof(MYSQL_ROW_OFFSET) * rows, MYF(MY_ZEROFILL))))
+    return set_error(stmt, MYERR_S1001, NULL, 4001);
+  cursor->keyset_count= rows;
+
+  memset(&query, 0, sizeof(query));
+  memset(&key, 0, sizeof(key));
+  memset(&in_list, 0, sizeof(in_list));
+  memset(&when_list, 0, sizeof(when_list));
+
+  if (init_dynamic_string(&query, "SELECT ", 1024, 1024) ||
+      init_dynamic_string(&key, "(", 64, 64) ||
+      init_dynamic_string(&in_list, "", 1024, 1024) ||
+      init_dynamic_string(&when_list, "", 1024, 1024))
+  {
+    dynstr_free(&query);
+    dynstr_free(&key);
+    dynstr_free(&in_list);
+    dynstr_free(&when_list);
+    keyset_free(stmt);
+    return set_error(stmt, MYERR_S1001, NULL, 4001);
+  }
+
+  for (index= 0; index < cursor->pk_count; ++index)
+  {
+    dynstr_append_quoted_name(&key, cursor->pkcol[index].name);
+    dynstr_append_mem(&key, ",", 1);
+  }
+  key.str[key.length - 1]= ')';
+
+  for (row= 0; row < rows && (values= mysql_fetch_row(result)); ++row)
+  {
+    size_t value_start= in_list.length;
+
+    lengths= mysql_fetch_lengths(result);
+
+    for (index= 0; index < cursor->pk_count; ++index)
+    {
+      if (!values[cursor->keyset_columns[index]])
+        break;
+    }
+    if (index < cursor->pk_count)
+      continue;
+
+    dynstr_append_mem(&in_list, added ? ",(" : "(", added ? 2 : 1);
+    if (added)
+      ++value_start;
+    for (index= 0; index < cursor->pk_count; ++index)
+    {
+      ncol= cursor->keyset_columns[index];
+
+      if (index)
+        dynstr_append_mem(&in_list, ",", 1);
+
+      /* Compared with a string, a BIGINT key would be converted to a
+         double, and keys past 2^53 would match their neighbours */
+      if (is_numeric_mysql_type(result->fields + ncol) &&
+          result->fields[ncol].type != MYSQL_TYPE_BIT)
+      {
+        dynstr_append_mem(&in_list, values[ncol], lengths[ncol]);
+        continue;
+      }
+
+      if (lengths[ncol] * 2 + 1 > buff_length)
+      {
+        x_free(buff);
+        buff_length= lengths[ncol] * 2 + 1;
+        if (!(buff= myodbc_malloc(buff_length, MYF(0))))
+        {
+          rc= set_error(stmt, MYERR_S1001, NULL, 4001);
+          goto exit;
+        }
+      }
+
+      dynstr_append_mem(&in_list, "'", 1);
+      dynstr_append_mem(&in_list, buff,
+                        myodbc_escape_data(&stmt->dbc->mysql, buff,
+                                           values[ncol], lengths[ncol]));
+      dynstr_append_mem(&in_list, "'", 1);
+    }
+    dynstr_append_mem(&in_list, ")", 1);
+
+    /* WHEN (key)=(values) THEN row */
+    dynstr_append_mem(&when_list, " WHEN ", 6);
+    dynstr_append_mem(&when_list, key.str, key.length);
+    dynstr_append_mem(&when_list, "=", 1);
+    dynstr_append_mem(&when_list, in_list.str + value_start,
+                      in_list.length - value_start);
+    dynstr_append_mem(&when_list, number,
+                      sprintf(number, " THEN %lu", (unsigned long)row));
+    ++added;
+  }
+
+  if (!added)
+    goto exit;
+
+  for (ncol= 0; ncol < result->field_count; ++ncol)
+  {
+    dynstr_append_quoted_name(&query, result->fields[ncol].org_name);
+    dynstr_append_mem(&query, ",", 1);
+  }
+  dynstr_append_mem(&query, "CASE", 4);
+  dynstr_append_mem(&query, when_list.str, when_list.length);
+  dynstr_append_mem(&query, " END FROM ", 10);
+
+  if (result->fields->db_length)
+  {
+    dynstr_append_quoted_name(&query, result->fields->db);
+    dynstr_append_mem(&query, ".", 1);
+  }
+  dynstr_append_quoted_name(&query, stmt->table_name);
+  dynstr_append_mem(&query, " WHERE ", 7);
+  dynstr_append_mem(&query, key.str, key.length);
+  dynstr_append_mem(&query, " IN (", 5);
+  dynstr_append_mem(&query, in_list.str, in_list.length);
+  dynstr_append_mem(&query, ")", 1);
+
+  MYLOG_QUERY(stmt, query.str);
+
+  lock_dbc(stmt->dbc);
+  if (exec_stmt_query(stmt, query.str, query.length, FALSE) ||
+      !(cursor->keyset_rows= mysql_store_result(&stmt->dbc->mysql)))
+  {
+    rc= set_error(stmt, MYERR_S1000, mysql_error(&stmt->dbc->mysql),
+                  mysql_errno(&stmt->dbc->mysql));
+    myodbc_mutex_unlock(&stmt->dbc->lock);
+    goto exit;
+  }
+  myodbc_mutex_unlock(&stmt->dbc->lock);
+
+  /* Where each row of the rowset is in the rows read */
+  for (;;)
+  {
+    MYSQL_ROW_OFFSET offset= mysql_row_tell(cursor->keyset_rows);
+    MYSQL_ROW        fresh= mysql_fetch_row(cursor->keyset_rows);
+
+    if (!fresh)
+      break;
+
+    if (fresh[result->field_count] &&
+        (row= strtoul(fresh[result->field_count], NULL, 10)) < rows)
+      cursor->keyset_offsets[row]= offset;
+  }
+
+exit:
+  x_free(buff);
+  mysql_row_seek(result, position);
+  dynstr_free(&query);
+  dynstr_free(&key);
+  dynstr_free(&in_list);
+  dynstr_free(&when_list);
+
+  if (rc != SQL_SUCCESS)
+    keyset_free(stmt);
+
+  return rc;
+}
+
+
+/* Whether the column has the same value in both rows */
+static my_bool keyset_same_value(MYSQL_ROW values, unsigned long *lengths,
+                                 MYSQL_ROW other, unsigned long *other_lengths,
+                                 uint ncol)
+{
+  if (!values[ncol] || !other[ncol])
+    return !values[ncol] && !other[ncol];
+
+  return lengths[ncol] == other_lengths[ncol] &&
+         !memcmp(values[ncol], other[ncol], lengths[ncol]);
+}
+
+
+/**
+  Find the row read by keyset_refresh() for a row of the rowset.
+  Lengths of the values returned are left in cursor.keyset_lengths.
+
+  @param[in]   stmt    Statement
+  @param[in]   values  Current row of the result
+  @param[in]   row     Position of the row in the rowset
+  @param[out]  status  SQL_ROW_UPDATED if any value has changed since the
+                       query was executed, SQL_ROW_DELETED if the row is not
+                       in the table anymore, not changed otherwise
+
+  @return  Values of the row read again, or the current row if it was not
+*/
+MYSQL_ROW keyset_row(STMT *stmt, MYSQL_ROW values, SQLULEN row,
+                     SQLUSMALLINT *status)
+{
+  MYCURSOR      *cursor= &stmt->cursor;
+  unsigned long *lengths= mysql_fetch_lengths(stmt->result);
+  uint           field_count= stmt->result->field_count;
+  MYSQL_ROW      fresh;
+  unsigned long *fresh_lengths;
+  uint           index, ncol;
+
+  cursor->keyset_lengths= lengths;
+
+  for (index= 0; index < cursor->pk_count; ++index)
+  {
+    if (!values[cursor->keyset_columns[index]])
+      return values;
+  }
+
+  if (!cursor->keyset_rows || row >= cursor->keyset_count ||
+      !cursor->keyset_offsets[row])
+  {
+    *status= SQL_ROW_DELETED;
+    return values;
+  }
+
+  mysql_row_seek(cursor->keyset_rows, cursor->keyset_offsets[row]);
+  fresh= mysql_fetch_row(cursor->keyset_rows);
+  fresh_lengths= mysql_fetch_lengths(cursor->keyset_rows);
+
+  for (ncol= 0; ncol < field_count; ++ncol)
+  {
+    if (!keyset_same_value(values, lengths, fresh, fresh_lengths, ncol))
+    {
+      *status= SQL_ROW_UPDATED;
+      break;
+    }
+  }
+
+  cursor->keyset_lengths= fresh_lengths;
+  return fresh;
+}
+
+
+/* Free the rowset read by keyset_refresh() */
+void keyset_free(STMT *stmt)
+{
+  if (stmt->cursor.keyset_rows)
+  {
+    mysql_free_result(stmt->cursor.keyset_rows);
+    stmt->cursor.keyset_rows= NULL;
+  }
+  x_free(stmt->cursor.keyset_offsets);
+  stmt->cursor.keyset_offsets= NULL;
+  stmt->cursor.keyset_count= 0;
+  stmt->cursor.keyset_lengths= NULL;
+}
+
+
 /*
   @type    : myodbc3 internal
   @purpose : positions the data cursor to appropriate row
@@ -425,7 +777,7 @@ static SQLRETURN copy_rowdata(STMT *stmt, DESCREC *aprec,
                               DESCREC *iprec, NET **net, SQLCHAR **to)
 {
     SQLRETURN rc;
-    SQLCHAR *orig_to= *to;
+    SQLCHAR *orig_to;
     /* Negative length means either NULL or DEFAULT, so we need 7 chars. */
     SQLUINTEGER length= (*aprec->octet_length_ptr > 0 ?
                          *aprec->octet_length_ptr + 1 : 7);
@@ -433,6 +785,8 @@ static SQLRETURN copy_rowdata(STMT *stmt, DESCREC *aprec,
     if ( !(*to= (SQLCHAR *) extend_buffer(*net,(char*) *to,length)) )
         return set_error(stmt,MYERR_S1001,NULL,4001);
 
+    /* The buffer may have been moved by extend_buffer() */
+    orig_to= *to;
     rc= insert_param(stmt, (uchar*) to, stmt->apd, aprec, iprec, 0);
     if (!SQL_SUCCEEDED(rc))
         return rc;
@@ -461,7 +815,7 @@ static my_bool insert_field(STMT *stmt, MYSQL_RES *result,
   DESCREC *aprec= &aprec_, *iprec= &iprec_;
   MYSQL_FIELD *field= mysql_fetch_field_direct(result,nSrcCol);
   MYSQL_ROW   row_data;
-  NET         *net=&stmt->dbc->mysql.net;
+  NET         *net=&stmt->query_net;
   unsigned char *to= net->buff;
   SQLLEN      length;
   char as_string[50], *dummy;
@@ -586,7 +940,7 @@ static SQLRETURN append_all_fields(STMT *stmt, DYNAMIC_STRING *dynQuery)
   */
   strxmov(select, "SELECT * FROM `", stmt->table_name, "` LIMIT 0", NullS);
   MYLOG_QUERY(stmt, select);
-  myodbc_mutex_lock(&stmt->dbc->lock);
+  lock_dbc(stmt->dbc);
   if (exec_stmt_query(stmt, select, strlen(select), FALSE) ||
       !(presultAllColumns= mysql_store_result(&stmt->dbc->mysql)))
   {
@@ -729,7 +1083,7 @@ static SQLRETURN build_set_clause(STMT *stmt, SQLULEN irow,
     uint          ncol, ignore_count= 0;
     MYSQL_FIELD *field;
     MYSQL_RES   *result= stmt->result;
-    NET         *net=&stmt->dbc->mysql.net;
+    NET         *net=&stmt->query_net;
     DESCREC *arrec, *irrec;
 
     dynstr_append_mem(dynQuery," SET ",5);
@@ -1313,6 +1667,305 @@ static SQLRETURN setpos_update(STMT *stmt, SQLUSMALLINT irow,
 }
 
 
+/*
+  Number of placeholders the server accepts in one prepared statement
+*/
+#define SSPS_INSERT_MAX_PARAMS 65535
+
+
+/*
+  Gives the type of MYSQL_BIND that takes data of the C type as it is in the
+  application's buffer, or MYSQL_TYPE_NULL if the data needs conversion
+  and can only go into a textual INSERT.
+*/
+static enum enum_field_types ssps_insert_type(STMT *stmt, SQLSMALLINT c_type,
+                                              my_bool *is_unsigned)
+{
+  *is_unsigned= FALSE;
+
+  switch (c_type)
+  {
+  case SQL_C_CHAR:
+    /* The server would take the data in the connection character set */
+    return stmt->dbc->ansi_charset_info->number ==
+           stmt->dbc->cxn_charset_info->number ? MYSQL_TYPE_STRING :
+                                                 MYSQL_TYPE_NULL;
+  case SQL_C_BINARY:
+    return MYSQL_TYPE_BLOB;
+  case SQL_C_BIT:
+  case SQL_C_UTINYINT:
+    *is_unsigned= TRUE;
+    /* fall through */
+  case SQL_C_TINYINT:
+  case SQL_C_STINYINT:
+    return MYSQL_TYPE_TINY;
+  case SQL_C_USHORT:
+    *is_unsigned= TRUE;
+    /* fall through */
+  case SQL_C_SHORT:
+  case SQL_C_SSHORT:
+    return MYSQL_TYPE_SHORT;
+  case SQL_C_ULONG:
+    *is_unsigned= TRUE;
+    /* fall through */
+  case SQL_C_LONG:
+  case SQL_C_SLONG:
+    return MYSQL_TYPE_LONG;
+  case SQL_C_UBIGINT:
+    *is_unsigned= TRUE;
+    /* fall through */
+  case SQL_C_SBIGINT:
+    return MYSQL_TYPE_LONGLONG;
+  case SQL_C_FLOAT:
+    return MYSQL_TYPE_FLOAT;
+  case SQL_C_DOUBLE:
+    return MYSQL_TYPE_DOUBLE;
+  }
+
+  return MYSQL_TYPE_NULL;
+}
+
+
+/*
+  Checks if the rows of SQLBulkOperations(SQL_ADD) can be sent as parameters
+  of a server-side prepared INSERT, binding the application's buffers
+  directly. That is if every column is bound with a C type the server takes
+  as it is, and no value is ignored or given at execution time.
+
+  Returns the number of rows that fit into one execution, 0 if the rows
+  have to be inserted as text.
+*/
+static SQLULEN ssps_insert_rows(STMT *stmt, SQLULEN insert_count)
+{
+  MYSQL_RES *result= stmt->result;
+  SQLULEN    row, rows;
+  ulong      row_length= 0;
+  uint       ncol;
+
+  if (stmt->dbc->ds->no_ssps || stmt->dae_type || stmt->setpos_apd ||
+      !result->field_count)
+  {
+    return 0;
+  }
+
+  for (ncol= 0; ncol < result->field_count; ++ncol)
+  {
+    DESCREC *arrec= desc_get_rec(stmt->ard, ncol, FALSE);
+    my_bool  is_unsigned;
+
+    if (!arrec || !arrec->data_ptr ||
+        ssps_insert_type(stmt, arrec->concise_type, &is_unsigned) ==
+        MYSQL_TYPE_NULL)
+    {
+      return 0;
+    }
+
+    row_length+= bind_length(arrec->concise_type, arrec->octet_length);
+
+    if (arrec->octet_length_ptr)
+    {
+      for (row= 0; row < insert_count; ++row)
+      {
+        SQLLEN ind= *(SQLLEN *)ptr_offset_adjust(arrec->octet_length_ptr,
+                                                 stmt->ard->bind_offset_ptr,
+                                                 stmt->ard->bind_type,
+                                                 sizeof(SQLLEN), row);
+        if (ind == SQL_COLUMN_IGNORE || ind == SQL_DATA_AT_EXEC ||
+            ind <= SQL_LEN_DATA_AT_EXEC_OFFSET)
+        {
+          return 0;
+        }
+      }
+    }
+  }
+
+  /* Keep an execution within what a text batch would send at once */
+  rows= myodbc_min(insert_count, SSPS_INSERT_MAX_PARAMS / result->field_count);
+  if (row_length)
+  {
+    rows= myodbc_min(rows, stmt->dbc->net_buffer_len / row_length);
+  }
+
+  return rows > 1 ? rows : 0;
+}
+
+
+/*
+  Inserts the rows of SQLBulkOperations(SQL_ADD) through a server-side
+  prepared INSERT with placeholders for batch_rows rows. The statement is
+  prepared once and executed again for each batch, only the last batch of
+  fewer rows needs a statement of its own. Handles come from and go back to
+  the statement cache (STMT_CACHE_SIZE) of the connection, so repeated bulk
+  inserts skip the prepare. Parameters point to the application's buffers,
+  so values are not copied or escaped.
+*/
+static SQLRETURN ssps_batch_insert(STMT *stmt, DYNAMIC_STRING *ext_query,
+                                   SQLULEN insert_count, SQLULEN batch_rows)
+{
+  DBC          *dbc= stmt->dbc;
+  uint          columns= stmt->result->field_count;
+  size_t        query_length= ext_query->length;
+  MYSQL_STMT   *ssps= NULL;
+  MY_SSPS_CACHE_ENTRY *entry= NULL;
+  MYSQL_BIND   *bind;
+  unsigned long *lengths;
+  SQLULEN       row, rows, prepared_rows= 0;
+  SQLRETURN     rc= SQL_SUCCESS;
+
+  bind= (MYSQL_BIND *)myodbc_malloc(sizeof(MYSQL_BIND) * columns * batch_rows,
+                                    MYF(0));
+  lengths= (unsigned long *)myodbc_malloc(sizeof(unsigned long) * columns *
+                                          batch_rows, MYF(0));
+  if (!bind || !lengths)
+  {
+    x_free(bind);
+    x_free(lengths);
+    return set_error(stmt, MYERR_S1001, NULL, 4001);
+  }
+
+  lock_dbc(dbc);
+
+  for (row= 0; row < insert_count; row+= rows)
+  {
+    MYSQL_BIND *param= bind;
+    SQLULEN     i;
+    uint        ncol;
+
+    rows= myodbc_min(batch_rows, insert_count - row);
+
+    if (rows != prepared_rows)
+    {
+      ext_query->length= query_length;
+      for (i= 0; i < rows; ++i)
+      {
+        dynstr_append_mem(ext_query, i ? ",(" : "(", i ? 2 : 1);
+        for (ncol= 0; ncol < columns; ++ncol)
+        {
+          dynstr_append_mem(ext_query, ncol ? ",?" : "?", ncol ? 2 : 1);
+        }
+        dynstr_append_mem(ext_query, ")", 1);
+      }
+
+      if (ssps && !ssps_cache_return(dbc, entry, ssps))
+      {
+        mysql_stmt_close(ssps);
+      }
+      ssps= NULL;
+
+      MYLOG_QUERY(stmt, ext_query->str);
+      entry= ssps_cache_take(dbc, ext_query->str, ext_query->length);
+
+      if (entry != NULL && entry->ssps != NULL)
+      {
+        ssps= entry->ssps;
+        entry->ssps= NULL;
+      }
+      else
+      {
+        if (!(ssps= mysql_stmt_init(&dbc->mysql)))
+        {
+          rc= set_error(stmt, MYERR_S1001, NULL, 4001);
+          goto exit;
+        }
+
+        if (mysql_stmt_prepare(ssps, ext_query->str, ext_query->length))
+        {
+          MYLOG_QUERY(stmt, mysql_stmt_error(ssps));
+          rc= set_stmt_error(stmt, "HY000", mysql_stmt_error(ssps),
+                             mysql_stmt_errno(ssps));
+          translate_error(stmt->error.sqlstate, MYERR_S1000,
+                          mysql_stmt_errno(ssps));
+          goto exit;
+        }
+
+        if (entry != NULL)
+        {
+          entry->prepared= TRUE;
+        }
+      }
+      prepared_rows= rows;
+    }
+
+    memset(bind, 0, sizeof(MYSQL_BIND) * columns * rows);
+
+    for (i= 0; i < rows; ++i)
+    {
+      for (ncol= 0; ncol < columns; ++ncol, ++param)
+      {
+        DESCREC *arrec= desc_get_rec(stmt->ard, ncol, FALSE);
+        SQLLEN   ind= arrec->octet_length;
+
+        if (arrec->octet_length_ptr)
+        {
+          ind= *(SQLLEN *)ptr_offset_adjust(arrec->octet_length_ptr,
+                                            stmt->ard->bind_offset_ptr,
+                                            stmt->ard->bind_type,
+                                            sizeof(SQLLEN), row + i);
+        }
+
+        if (ind == SQL_NULL_DATA)
+        {
+          param->buffer_type= MYSQL_TYPE_NULL;
+          continue;
+        }
+
+        param->buffer_type= ssps_insert_type(stmt, arrec->concise_type,
+                                             &param->is_unsigned);
+        param->buffer= ptr_offset_adjust(arrec->data_ptr,
+                                         stmt->ard->bind_offset_ptr,
+                                         stmt->ard->bind_type,
+                                         bind_length(arrec->concise_type,
+                                                     arrec->octet_length),
+                                         row + i);
+
+        if (param->buffer_type == MYSQL_TYPE_STRING ||
+            param->buffer_type == MYSQL_TYPE_BLOB)
+        {
+          unsigned long *length= &lengths[param - bind];
+
+          /* Without a length character data is null-terminated */
+          if (ind == SQL_NTS ||
+              (!arrec->octet_length_ptr && arrec->concise_type == SQL_C_CHAR))
+          {
+            *length= (unsigned long)strlen(param->buffer);
+          }
+          else
+          {
+            *length= (unsigned long)ind;
+          }
+
+          param->buffer_length= *length;
+          param->length= length;
+        }
+      }
+    }
+
+    if (mysql_stmt_bind_param(ssps, bind) || mysql_stmt_execute(ssps))
+    {
+      MYLOG_QUERY(stmt, mysql_stmt_error(ssps));
+      rc= set_stmt_error(stmt, "HY000", mysql_stmt_error(ssps),
+                         mysql_stmt_errno(ssps));
+      translate_error(stmt->error.sqlstate, MYERR_S1000,
+                      mysql_stmt_errno(ssps));
+      goto exit;
+    }
+  }
+
+exit:
+  if (!ssps_cache_return(dbc, entry, ssps) && ssps)
+  {
+    mysql_stmt_close(ssps);
+  }
+  myodbc_mutex_unlock(&dbc->lock);
+
+  ext_query->length= query_length;
+  x_free(bind);
+  x_free(lengths);
+
+  return rc;
+}
+
+
 /*!
     \brief  Insert 1 or more rows.
 
@@ -1340,8 +1993,9 @@ static SQLRETURN batch_insert( STMT *stmt, SQLULEN irow, DYNAMIC_STRING *ext_que
     MYSQL_RES    *result= stmt->result;     /* result set we are working with */
     SQLULEN      insert_count= 1;           /* num rows to insert - will be real value when row is 0 (all)  */
     SQLULEN      count= 0;                  /* current row */
+    SQLULEN      batch_rows;                /* rows per prepared INSERT */
     SQLLEN       length;
-    NET         *net= &stmt->dbc->mysql.net;
+    NET         *net= &stmt->query_net;
     SQLUSMALLINT ncol;
     long i;
     SQLCHAR      *to;
@@ -1361,6 +2015,15 @@ static SQLRETURN batch_insert( STMT *stmt, SQLULEN irow, DYNAMIC_STRING *ext_que
     {
         insert_count= stmt->ard->array_size;
         query_length= ext_query->length;
+
+        /* Let the server take the bound buffers if their types allow */
+        if ((batch_rows= ssps_insert_rows(stmt, insert_count)))
+        {
+            if (ssps_batch_insert(stmt, ext_query, insert_count, batch_rows) !=
+                SQL_SUCCESS)
+                return SQL_ERROR;
+            goto inserted;
+        }
     }
 
     do
@@ -1483,6 +2146,7 @@ static SQLRETURN batch_insert( STMT *stmt, SQLULEN irow, DYNAMIC_STRING *ext_que
 
     } while ( break_insert && count < insert_count );
 
+inserted:
 
     if (stmt->stmt_options.bookmarks == SQL_UB_VARIABLE)
     {
@@ -1681,7 +2345,6 @@ SQLRETURN SQL_API my_SQLSetPos(SQLHSTMT hstmt, SQLSETPOSIROW irow,
                     return set_error(stmt,MYERR_S1000, alloc_error, 0);
                 }
 
-                myodbc_mutex_lock(&stmt->dbc->lock);
                 --irow;
                 sqlRet= SQL_SUCCESS;
                 stmt->cursor_row= (long)(stmt->current_row+irow);
@@ -1696,7 +2359,6 @@ SQLRETURN SQL_API my_SQLSetPos(SQLHSTMT hstmt, SQLSETPOSIROW irow,
                  so the MYSQL_RES is in the state we expect.
                 */
                 data_seek(stmt, (my_ulonglong)stmt->cursor_row);
-                myodbc_mutex_unlock(&stmt->dbc->lock);
                 break;
             }
 
@@ -1977,5 +2639,7 @@ SQLRETURN SQL_API SQLCloseCursor(SQLHSTMT Handle)
 {
     CHECK_HANDLE(Handle);
 
+    async_wait((STMT *)Handle);
+
     return  my_SQLFreeStmt(Handle, SQL_CLOSE);
 }
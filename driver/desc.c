@@ -272,6 +272,7 @@ DESCREC *desc_get_rec(DESC *desc, int recnum, my_bool expand)
         }
         memset(rec, 0, sizeof(DESCREC));
         ++desc->count;
+        ++desc->version;
 
         /* record initialization */
         if (IS_APD(desc))
@@ -804,6 +805,7 @@ MySQLSetDescField(SQLHDESC hdesc, SQLSMALLINT recnum, SQLSMALLINT fldid,
   }
 
   CLEAR_DESC_ERROR(desc);
+  ++desc->version;
 
   /* check for invalid IRD modification */
   if (IS_IRD(desc))
@@ -1019,6 +1021,7 @@ SQLRETURN MySQLCopyDesc(SQLHDESC SourceDescHandle, SQLHDESC TargetDescHandle)
   dest->count= src->count;
   dest->rows_processed_ptr= src->rows_processed_ptr;
   memcpy(&dest->error, &src->error, sizeof(MYERROR));
+  ++dest->version;
 
   /* TODO consistency check on target, if needed (apd) */
 
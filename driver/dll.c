@@ -30,7 +30,7 @@
 #include "driver.h"
 #include <locale.h>
 
-char *default_locale, *decimal_point, *thousands_sep;
+char *decimal_point, *thousands_sep;
 uint decimal_point_length,thousands_sep_length;
 static my_bool myodbc_inited=0;
 
@@ -74,7 +74,13 @@ void myodbc_init(void)
   my_sys_init();
   {
     struct lconv *tmp;
+    char *default_locale;
     init_getfunctions();
+    /*
+      Separators of the environment locale, used only for parameters given
+      as strings with NO_LOCALE. Numbers are converted without setlocale()
+      otherwise, so this is the only place it is called.
+    */
     default_locale=myodbc_strdup(setlocale(LC_NUMERIC,NullS),MYF(0));
     setlocale(LC_NUMERIC,"");
     tmp=localeconv();
@@ -83,9 +89,11 @@ void myodbc_init(void)
     thousands_sep=myodbc_strdup(tmp->thousands_sep,MYF(0));
     thousands_sep_length=strlen(thousands_sep);
     setlocale(LC_NUMERIC,default_locale);
+    x_free(default_locale);
 
     utf8_charset_info= get_charset_by_csname("utf8", MYF(MY_CS_PRIMARY),
                                              MYF(0));
+    query_log_init();
   }
 }
 
@@ -99,8 +107,8 @@ void myodbc_end()
   if (!--myodbc_inited)
   {
     x_free(decimal_point);
-    x_free(default_locale);
     x_free(thousands_sep);
+    query_log_end();
 
     /* my_thread_end_wait_time was added in 5.1.14 and 5.0.32 */
 #if !defined(NONTHREADSAFE) && \
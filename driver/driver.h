@@ -128,6 +128,60 @@ extern "C"
 # define DEFAULT_TXN_ISOLATION 0
 #endif
 
+/*
+  Driver-specific connection attributes, read-only SQLULEN counters of the
+  environment the connection belongs to
+*/
+#ifndef SQL_DRIVER_CONN_ATTR_BASE
+# define SQL_DRIVER_CONN_ATTR_BASE 0x00004000
+#endif
+/* Wakeups of pooled connections, and how many of them had to log in again */
+#define SQL_ATTR_MYODBC_WAKEUPS         (SQL_DRIVER_CONN_ATTR_BASE + 1)
+#define SQL_ATTR_MYODBC_WAKEUPS_REAUTH  (SQL_DRIVER_CONN_ATTR_BASE + 2)
+/* Prepared statement cache of the connection, see STMT_CACHE_SIZE */
+#define SQL_ATTR_MYODBC_STMT_CACHE_HITS       (SQL_DRIVER_CONN_ATTR_BASE + 3)
+#define SQL_ATTR_MYODBC_STMT_CACHE_MISSES     (SQL_DRIVER_CONN_ATTR_BASE + 4)
+#define SQL_ATTR_MYODBC_STMT_CACHE_EVICTIONS  (SQL_DRIVER_CONN_ATTR_BASE + 5)
+/* Times a thread had to wait for another one using the connection */
+#define SQL_ATTR_MYODBC_LOCK_WAITS            (SQL_DRIVER_CONN_ATTR_BASE + 6)
+/* Times the environment's monitor has pinged the idle connection */
+#define SQL_ATTR_MYODBC_LIVENESS_PINGS        (SQL_DRIVER_CONN_ATTR_BASE + 7)
+/* Parse cache of the environment, see parse_cached() */
+#define SQL_ATTR_MYODBC_PARSE_CACHE_HITS      (SQL_DRIVER_CONN_ATTR_BASE + 8)
+#define SQL_ATTR_MYODBC_PARSE_CACHE_MISSES    (SQL_DRIVER_CONN_ATTR_BASE + 9)
+
+/*
+  Counters of MY_STATS, read-only SQLULEN attributes. SQLGetStmtAttr returns
+  them for the statement, SQLGetConnectAttr for the connection and all its
+  statements, or with SQL_ATTR_MYODBC_STATS_ENV added for all connections of
+  the environment. Driver-specific statement attributes start at the same
+  0x4000.
+*/
+#define SQL_ATTR_MYODBC_STATS_EXECUTIONS      (SQL_DRIVER_CONN_ATTR_BASE + 0x10)
+#define SQL_ATTR_MYODBC_STATS_PARSE_US        (SQL_DRIVER_CONN_ATTR_BASE + 0x11)
+#define SQL_ATTR_MYODBC_STATS_PARAMS_US       (SQL_DRIVER_CONN_ATTR_BASE + 0x12)
+#define SQL_ATTR_MYODBC_STATS_QUERY_US        (SQL_DRIVER_CONN_ATTR_BASE + 0x13)
+#define SQL_ATTR_MYODBC_STATS_RESULT_US       (SQL_DRIVER_CONN_ATTR_BASE + 0x14)
+#define SQL_ATTR_MYODBC_STATS_FETCH_US        (SQL_DRIVER_CONN_ATTR_BASE + 0x15)
+#define SQL_ATTR_MYODBC_STATS_ROWS_FETCHED    (SQL_DRIVER_CONN_ATTR_BASE + 0x16)
+#define SQL_ATTR_MYODBC_STATS_BYTES_FETCHED   (SQL_DRIVER_CONN_ATTR_BASE + 0x17)
+#define SQL_ATTR_MYODBC_STATS_SCROLLER_WINDOWS (SQL_DRIVER_CONN_ATTR_BASE + 0x18)
+/* + N, executions by latency, see MY_STATS */
+#define SQL_ATTR_MYODBC_STATS_LATENCY         (SQL_DRIVER_CONN_ATTR_BASE + 0x19)
+/* After the MY_STATS_BUCKETS of latency */
+#define SQL_ATTR_MYODBC_STATS_CANCELS         (SQL_DRIVER_CONN_ATTR_BASE + 0x29)
+#define SQL_ATTR_MYODBC_STATS_CANCEL_US       (SQL_DRIVER_CONN_ATTR_BASE + 0x2A)
+#define SQL_ATTR_MYODBC_STATS_KEYSET_WINDOWS  (SQL_DRIVER_CONN_ATTR_BASE + 0x2B)
+#define SQL_ATTR_MYODBC_STATS_ENV             0x40
+
+#define MY_STATS_BUCKETS  16
+#define MY_STATS_COUNTERS (12 + MY_STATS_BUCKETS)
+#define IS_STATS_ATTR(A) ((A) >= SQL_ATTR_MYODBC_STATS_EXECUTIONS && \
+                          (A) < SQL_ATTR_MYODBC_STATS_EXECUTIONS + \
+                                MY_STATS_COUNTERS)
+#define STATS_COUNTER(S,A) \
+  (((SQLULEN *)(S))[(A) - SQL_ATTR_MYODBC_STATS_EXECUTIONS])
+
 /* For compatibility with old mysql clients - defining error */
 #ifndef ER_MUST_CHANGE_PASSWORD_LOGIN
 # define ER_MUST_CHANGE_PASSWORD_LOGIN 1820
@@ -141,6 +195,35 @@ extern "C"
 # define SQL_PARAM_DATA_AVAILABLE 101
 #endif
 
+/* ODBC 3.8 asynchronous notification, for older headers */
+#ifndef SQL_ATTR_ASYNC_STMT_EVENT
+# define SQL_ATTR_ASYNC_STMT_EVENT      29
+#endif
+#ifndef SQL_ATTR_ASYNC_STMT_PCALLBACK
+# define SQL_ATTR_ASYNC_STMT_PCALLBACK  30
+# define SQL_ATTR_ASYNC_STMT_PCONTEXT   31
+#endif
+#ifndef SQL_ATTR_ASYNC_DBC_FUNCTIONS_ENABLE
+# define SQL_ATTR_ASYNC_DBC_FUNCTIONS_ENABLE 117
+# define SQL_ASYNC_DBC_ENABLE_ON        1UL
+# define SQL_ASYNC_DBC_ENABLE_OFF       0UL
+#endif
+#ifndef SQL_ATTR_ASYNC_DBC_EVENT
+# define SQL_ATTR_ASYNC_DBC_EVENT       119
+#endif
+#ifndef SQL_ATTR_ASYNC_DBC_PCALLBACK
+# define SQL_ATTR_ASYNC_DBC_PCALLBACK   120
+# define SQL_ATTR_ASYNC_DBC_PCONTEXT    121
+#endif
+#ifndef SQL_ASYNC_NOTIFICATION
+# define SQL_ASYNC_NOTIFICATION             10025
+# define SQL_ASYNC_NOTIFICATION_NOT_CAPABLE 0x00000000L
+# define SQL_ASYNC_NOTIFICATION_CAPABLE     0x00000001L
+#endif
+
+/* Set by the driver manager to be called when an asynchronous call ends */
+typedef SQLRETURN (SQL_API *MY_ASYNC_CALLBACK)(SQLPOINTER context, BOOL last);
+
 /* Connection flags to validate after the connection*/
 #define CHECK_AUTOCOMMIT_ON	1  /* AUTOCOMMIT_ON */
 #define CHECK_AUTOCOMMIT_OFF	2  /* AUTOCOMMIT_OFF */
@@ -243,6 +326,9 @@ typedef struct {
   DYNAMIC_ARRAY   records;
   MYERROR         error;
   struct tagSTMT *stmt;
+  /* Incremented on every change of records or header fields, so users of
+     the descriptor data(e.g. fetch plan) know they need to re-read it */
+  uint            version;
 
   /* SQL_DESC_ALLOC_USER-specific */
   struct {
@@ -338,9 +424,80 @@ typedef struct stmt_options
   SQLUINTEGER     bookmarks;
   void            *bookmark_ptr;
   my_bool         bookmark_insert;
+  SQLUINTEGER     async_enable;
 } STMT_OPTIONS;
 
 
+/*
+  Asynchronous call of a statement or a connection, see async.c. All but
+  the arguments of the call are protected by the lock of the worker pool.
+*/
+typedef struct my_async
+{
+  SQLUSMALLINT      function;     /* SQL_API_* of the call, 0 if none */
+  my_bool           done, canceled;
+  SQLRETURN         rc;
+  /* Arguments of SQLFetchScroll */
+  SQLSMALLINT       orientation;
+  SQLLEN            offset;
+  /* Data source of SQLConnect and SQLDriverConnect */
+  DataSource        *ds;
+  /* Signaled when the call ends: SQL_ATTR_ASYNC_STMT_EVENT or
+     SQL_ATTR_ASYNC_DBC_EVENT, or the callback of the driver manager */
+  SQLPOINTER        event;
+  MY_ASYNC_CALLBACK callback;
+  SQLPOINTER        context;
+  /* Handle of the call, one of them is set */
+  struct tagSTMT    *stmt;
+  struct tagDBC     *dbc;
+  struct my_async   *next;        /* In the queue of the pool */
+} MY_ASYNC;
+
+
+/*
+  Where the driver spends its time, in microseconds, and what it has done.
+  Members are in the order of SQL_ATTR_MYODBC_STATS_* attributes and all
+  are SQLULEN.
+*/
+typedef struct
+{
+  SQLULEN executions;       /* do_query() calls */
+  SQLULEN parse_us;         /* Parsing query texts */
+  SQLULEN params_us;        /* Putting parameter values into queries */
+  SQLULEN query_us;         /* Waiting for the server to execute queries */
+  SQLULEN result_us;        /* Storing or starting to use results */
+  SQLULEN fetch_us;         /* Filling rowsets, values converted included */
+  SQLULEN rows_fetched;
+  SQLULEN bytes_fetched;    /* Of values converted into bound buffers */
+  SQLULEN scroller_windows; /* Windows read by PREFETCH */
+  /*
+    Executions by their time in do_query(): under 1 ms in the 1st bucket,
+    from 2^(N-1) to 2^N ms in the bucket N, longer in the last one
+  */
+  SQLULEN latency[MY_STATS_BUCKETS];
+  SQLULEN cancels;          /* KILL QUERY sent by SQLCancel */
+  SQLULEN cancel_us;        /* Sending them, opening the channel included */
+  SQLULEN keyset_windows;   /* Windows read by ORDER BY key values */
+} MY_STATS;
+
+
+/*
+  Connection of the environment that SQLCancel sends KILL QUERY through, one
+  per server, account and connection settings (see cancel_channel_key()).
+  It is opened by the 1st cancel and kept open until the environment is
+  freed.
+*/
+typedef struct
+{
+  myodbc_mutex_t lock;          /* Held while a KILL is sent */
+  MYSQL          mysql;
+  my_bool        connected;
+  char           *key;          /* See cancel_channel_key() */
+  size_t         key_length;
+  LIST           list;
+} MY_CANCEL_CHANNEL;
+
+
 /* Environment handler */
 
 typedef struct	tagENV
@@ -351,6 +508,30 @@ typedef struct	tagENV
 #ifdef THREAD
   myodbc_mutex_t lock;
 #endif
+  /* See SQL_ATTR_MYODBC_WAKEUPS, protected by lock */
+  SQLULEN      wakeup_count, wakeup_reauth_count;
+  /* Background health check of idle connections, see LIVENESS_INTERVAL */
+  myodbc_thread_t monitor;
+  myodbc_cond_t  monitor_cond;
+  BOOL         monitor_started, monitor_stop;
+  /* Parsed queries shared by the connections, see parse_cached() */
+  MY_PARSE_CACHE parse_cache;
+  /* Of connections freed already, protected by lock */
+  MY_STATS     stats;
+  /* Threads running asynchronous calls, started with the 1st one */
+  struct st_async_pool *async_pool;
+  /* See MY_CANCEL_CHANNEL. Not env->lock, env_get_stats() holds it while
+     it waits for connections that may be running the query to cancel */
+  LIST         *cancel_channels;
+  myodbc_mutex_t cancel_lock;
+  /* Kills queries running longer than SQL_ATTR_QUERY_TIMEOUT, see
+     query_timer_start(). The members are protected by timer_lock */
+  myodbc_thread_t timer;
+  myodbc_mutex_t timer_lock;
+  myodbc_cond_t  timer_cond;
+  BOOL         timer_started, timer_stop;
+  LIST         *timers;             /* Connections with a deadline */
+  struct tagDBC *timer_killing;     /* Connection the timer sends KILL for */
 } ENV;
 
 
@@ -365,7 +546,7 @@ typedef struct tagDBC
   LIST          list;
   STMT_OPTIONS  stmt_options;
   MYERROR       error;
-  FILE          *query_log;
+  my_bool       query_log;          /* Has opened the query log */
   char          st_error_prefix[255];
   char          *database;
   SQLUINTEGER   login_timeout;
@@ -374,6 +555,7 @@ typedef struct tagDBC
   uint          port;
   uint          cursor_count;
   ulong         net_buffer_len;
+  ulong         server_max_packet;  /* @@max_allowed_packet, 0 if not read yet */
   uint          commit_flag;
 #ifdef THREAD
   myodbc_mutex_t lock;
@@ -387,6 +569,38 @@ typedef struct tagDBC
   SQLULEN       sql_select_limit;   /* value of the sql_select_limit currently set for a session
                                        (SQLULEN)(-1) if wasn't set */
   int           need_to_wakeup;      /* Connection have been put to the pool */
+  /* Session state after connect, pool wakeup brings the session back to it */
+  my_bool       login_autocommit;
+  int           login_txn_isolation;
+  /* Idle seconds before the environment's monitor pings the connection,
+     0 if it isn't monitored. Protected by lock, as is server_gone */
+  uint          liveness_interval;
+  my_bool       server_gone;        /* Monitor's ping has failed */
+  SQLULEN       liveness_pings;     /* Protected by lock */
+  /* Prepared statements not in use, most recently used first. The list and
+     the counters are protected by stmt_cache_lock */
+  LIST          *stmt_cache;
+  uint          stmt_cache_count;
+  uint          stmt_cache_epoch;   /* Bumped by ssps_cache_free() */
+  SQLULEN       stmt_cache_hits, stmt_cache_misses, stmt_cache_evictions;
+  myodbc_mutex_t stmt_cache_lock;
+  SQLULEN       lock_waits;         /* Times lock_dbc() had to wait */
+  /* Statement whose query holds lock, protected by env->cancel_lock */
+  struct tagSTMT *running_stmt;
+  /* Catalog function results, protected by catalog_cache_lock */
+  LIST          *catalog_cache;
+  myodbc_mutex_t catalog_cache_lock;
+  ulong         stmt_count;         /* Statements allocated, numbers them */
+  ulong         query_log_count;    /* Executions seen by LOG_QUERY_SAMPLE */
+  my_bool       query_log_sampled;  /* Current execution is being logged */
+  MY_STATS      stats;              /* Of statements freed, protected by lock */
+  my_bool       async_enable;       /* SQL_ATTR_ASYNC_DBC_FUNCTIONS_ENABLE */
+  MY_ASYNC      async;
+  time_t        stats_logged;       /* See STATS_INTERVAL */
+  /* Of the query being executed, protected by env->timer_lock */
+  my_ulonglong  query_deadline;     /* myodbc_time_us(), 0 once killed */
+  my_bool       query_timed_out;
+  LIST          timer_list;
 } DBC;
 
 
@@ -410,9 +624,80 @@ typedef struct limit_scroller
    unsigned int       row_count;
    unsigned long long start_offset;
    unsigned long long next_offset, total_rows, query_len;
+   /* Windows fetched ahead on a second connection, see PREFETCH_ASYNC */
+   struct st_scroller_async *async;
+   /* Paging by values of ORDER BY key instead of offsets, if possible */
+   struct st_scroller_keyset *keyset;
 
 } MY_LIMIT_SCROLLER;
 
+/*
+  Fetch plan column - all that is needed to put the value of a bound column
+  into the application buffers, resolved once per result and bindings rather
+  than for every fetched cell.
+*/
+typedef struct fetch_plan_col
+{
+  uint          column;         /* 0-based number of the column */
+  DESCREC       *arrec, *irrec;
+  MYSQL_FIELD   *field;
+  SQLSMALLINT   c_type;         /* resolved if SQL_C_DEFAULT was bound */
+  SQLLEN        buffer_length;
+  my_bool       conversion_ok;
+  char          *data_ptr, *length_ptr;
+  SQLLEN        data_stride, length_stride;
+  /* Server-side prepared statement writes the value straight to data_ptr */
+  my_bool       direct;
+} MY_FETCH_PLAN_COL;
+
+typedef struct fetch_plan
+{
+  MY_FETCH_PLAN_COL *cols;
+  uint              count, allocated, direct_count;
+  my_bool           valid;
+  /* Row of the rowset the next fetch_row() puts direct columns to, and the
+     row the last one did, -1 if the driver's buffers are used */
+  long              direct_row, fetched_row;
+  /* What the plan has been built for */
+  MYSQL_RES         *result;
+  MYSQL_FIELD       *fields;
+  DESC              *ard;
+  uint              ard_version, ird_version, column_count;
+} MY_FETCH_PLAN;
+
+/*
+  Prepared statement kept by the connection for reuse, see STMT_CACHE_SIZE.
+  Key is the query. Unqualified names are resolved in the default database
+  of PREPARE, so the cache is flushed whenever it changes.
+*/
+typedef struct ssps_cache_entry
+{
+  LIST          list;
+  char          *key;
+  size_t        key_length;
+  MYSQL_STMT    *ssps;
+  unsigned long thread_id;      /* Reconnect loses prepared statements */
+  uint          epoch;          /* Of the cache when the handle was taken */
+  my_bool       prepared;
+} MY_SSPS_CACHE_ENTRY;
+
+/*
+  Result of a catalog function kept by the connection, see CATALOG_CACHE_TTL.
+  Values are copied to the statement on every hit.
+*/
+typedef struct catalog_cache_entry
+{
+  LIST          list;
+  char          *key;           /* Function and its arguments */
+  size_t        key_length;
+  time_t        expires;
+  MYSQL_FIELD   *fields;        /* Static field array of the function */
+  uint          field_count;
+  my_ulonglong  row_count;
+  char          **values;       /* row_count * field_count */
+  MEM_ROOT      alloc;
+} MY_CATALOG_CACHE_ENTRY;
+
 /* Statement primary key handler for cursors */
 typedef struct pk_column
 {
@@ -428,6 +713,13 @@ typedef struct cursor
   uint	       pk_count;
   my_bool      pk_validated;
   MY_PK_COLUMN pkcol[MY_MAX_PK_PARTS];
+  /* Dynamic cursor reading its rowset again by the unique key */
+  my_bool      keyset_validated, keyset_usable;
+  uint         keyset_columns[MY_MAX_PK_PARTS]; /* Result columns of pkcol */
+  MYSQL_RES    *keyset_rows;      /* Rowset read by keyset_refresh() */
+  MYSQL_ROW_OFFSET *keyset_offsets; /* Of the rows read, by rowset position */
+  SQLULEN      keyset_count;      /* Rows in the rowset */
+  unsigned long *keyset_lengths;  /* Of the row keyset_row() returned */
 } MYCURSOR;
 
 enum OUT_PARAM_STATE
@@ -444,6 +736,7 @@ enum OUT_PARAM_STATE
 typedef struct tagSTMT
 {
   DBC               *dbc;
+  ulong             id;       /* Number of the statement in the query log */
   MYSQL_RES         *result;
   MEM_ROOT          alloc_root;
   my_bool           fake_result;
@@ -468,6 +761,7 @@ typedef struct tagSTMT
     CURRENT OF' cursor handling.
   */
   my_ulonglong      affected_rows;
+  uint              warning_count;  /* Of the last DML statement executed */
   long              current_row;
   long              cursor_row;
   char              dae_type; /* data-at-exec type */
@@ -501,15 +795,23 @@ typedef struct tagSTMT
   SQLUSMALLINT setpos_lock;
 
   MYSQL_STMT *ssps;
+  MY_SSPS_CACHE_ENTRY *ssps_entry;  /* ssps goes back there when closed */
+  /* Queries with parameter values are built here rather than in the
+     connection's NET, so that needs no dbc->lock */
+  NET query_net;
   MYSQL_BIND *result_bind;
 
   MY_LIMIT_SCROLLER scroller;
+  MY_FETCH_PLAN     fetch_plan;
 
   enum OUT_PARAM_STATE out_params_state;
+  /* Updated by the thread using the statement without locks */
+  MY_STATS          stats;
+  MY_ASYNC          async;
 } STMT;
 
 
-extern char *default_locale, *decimal_point, *thousands_sep;
+extern char *decimal_point, *thousands_sep;
 extern uint decimal_point_length,thousands_sep_length;
 #ifndef _UNIX_
 extern HINSTANCE NEAR s_hModule;  /* DLL handle. */
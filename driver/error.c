@@ -95,6 +95,7 @@ static MYODBC3_ERR_STR myodbc3_errors[]=
   {"42S22","Column not found", SQL_ERROR},
   {"08S01","Communication link failure", SQL_ERROR},
   {"08004","Server rejected the connection", SQL_ERROR},
+  {"HY008","Operation canceled", SQL_ERROR},
 };
 
 
@@ -123,6 +124,7 @@ void myodbc_sqlstate2_init(void)
     myodbc_stpmov(myodbc3_errors[MYERR_42S12].sqlstate,"S0012");
     myodbc_stpmov(myodbc3_errors[MYERR_42S21].sqlstate,"S0021");
     myodbc_stpmov(myodbc3_errors[MYERR_42S22].sqlstate,"S0022");
+    myodbc_stpmov(myodbc3_errors[MYERR_S1008].sqlstate,"S1008");
 }
 
 
@@ -147,6 +149,7 @@ void myodbc_sqlstate3_init(void)
     myodbc_stpmov(myodbc3_errors[MYERR_42S12].sqlstate,"42S12");
     myodbc_stpmov(myodbc3_errors[MYERR_42S21].sqlstate,"42S21");
     myodbc_stpmov(myodbc3_errors[MYERR_42S22].sqlstate,"42S22");
+    myodbc_stpmov(myodbc3_errors[MYERR_S1008].sqlstate,"HY008");
 }
 
 
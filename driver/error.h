@@ -140,6 +140,7 @@ typedef enum myodbc_errid
     MYERR_08S01,
     /* Please add new errors to the end of enum, and not in alphabet order */
     MYERR_08004,
+    MYERR_S1008,
 } myodbc_errid;
 
 /*
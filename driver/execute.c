@@ -28,7 +28,6 @@
 */
 
 #include "driver.h"
-#include <locale.h>
 
 
 /*
@@ -39,6 +38,8 @@
 SQLRETURN do_query(STMT *stmt,char *query, SQLULEN query_length)
 {
     int error= SQL_ERROR, native_error= 0;
+    my_ulonglong start= myodbc_time_us(), phase_start;
+    my_bool timer= FALSE, scroller= FALSE;
 
     if (!query)
     {
@@ -63,8 +64,20 @@ SQLRETURN do_query(STMT *stmt,char *query, SQLULEN query_length)
       query_length= strlen(query);
     }
 
-    MYLOG_QUERY(stmt, query);
-    myodbc_mutex_lock(&stmt->dbc->lock);
+    lock_dbc(stmt->dbc);
+    dbc_set_running(stmt->dbc, stmt);
+
+    if (stmt->dbc->query_log)
+    {
+      query_log_start(stmt, query, query_length);
+    }
+
+    /* Canceled while it waited for the connection, see async_canceled() */
+    if (async_canceled(stmt))
+    {
+      set_error(stmt, MYERR_S1008, NULL, 0);
+      goto exit;
+    }
 
     if ( check_if_server_is_alive( stmt->dbc ) )
     {
@@ -76,6 +89,12 @@ SQLRETURN do_query(STMT *stmt,char *query, SQLULEN query_length)
       goto exit;
     }
 
+    /* SQL_ATTR_QUERY_TIMEOUT costs no round trip, the driver kills the query */
+    timer= stmt->stmt_options.query_timeout > 0 &&
+           query_timer_start(stmt->dbc, stmt->stmt_options.query_timeout);
+
+    phase_start= myodbc_time_us();
+
     /* Simplifying task so far - we will do "LIMIT" scrolling forward only
      * and when no musltiple statements is allowed - we can't now parse query
      * that well to detect multiple queries.
@@ -103,6 +122,7 @@ SQLRETURN do_query(STMT *stmt,char *query, SQLULEN query_length)
 
       native_error= mysql_real_query(&stmt->dbc->mysql, stmt->scroller.query,
                                   (unsigned long)stmt->scroller.query_len);
+      scroller= native_error == 0;
     }
       /* Not using ssps for scroller so far. Relaxing a bit condition
        if allow_multiple_statements option selected by primitive check if
@@ -113,6 +133,7 @@ SQLRETURN do_query(STMT *stmt,char *query, SQLULEN query_length)
                                         (MYSQL_BIND*)stmt->param_bind->buffer);
       if (native_error == 0)
       {
+        ssps_set_cursor_type(stmt);
         native_error= mysql_stmt_execute(stmt->ssps);
       }
       else
@@ -126,22 +147,19 @@ SQLRETURN do_query(STMT *stmt,char *query, SQLULEN query_length)
                         mysql_stmt_errno(stmt->ssps));
         goto exit;
       }
-      MYLOG_QUERY(stmt, "ssps has been executed");
     }
     else
     {
-      MYLOG_QUERY(stmt, "Using direct execution");
       /* Need to close ps handler if it is open as our relsult will be generated
          by direct execution. and ps handler may create some chaos */
       ssps_close(stmt);
       native_error= mysql_real_query(&stmt->dbc->mysql,query,query_length);
     }
 
-    MYLOG_QUERY(stmt, "query has been executed");
+    stmt->stats.query_us+= myodbc_time_us() - phase_start;
 
     if (native_error)
     {
-      MYLOG_QUERY(stmt, mysql_error(&stmt->dbc->mysql));
       set_stmt_error(stmt, "HY000", mysql_error(&stmt->dbc->mysql),
                      mysql_errno(&stmt->dbc->mysql));
 
@@ -165,6 +183,7 @@ SQLRETURN do_query(STMT *stmt,char *query, SQLULEN query_length)
         error= SQL_SUCCESS;     /* no result set */
         stmt->state= ST_EXECUTED;
         update_affected_rows(stmt);
+        stmt->warning_count= mysql_warning_count(&stmt->dbc->mysql);
         goto exit;
       }
     }
@@ -187,20 +206,59 @@ SQLRETURN do_query(STMT *stmt,char *query, SQLULEN query_length)
     }
     else
     {
+      phase_start= myodbc_time_us();
       if (bind_result(stmt) || get_result(stmt))
       {
           set_error(stmt, MYERR_S1000, mysql_error(&stmt->dbc->mysql),
                   mysql_errno(&stmt->dbc->mysql));
           goto exit;
       }
+      stmt->stats.result_us+= myodbc_time_us() - phase_start;
       /* Caching row counts for queries returning resultset as well */
       //update_affected_rows(stmt);
       fix_result_types(stmt);
+
+      /* The worker copies the session state, the connection has to be free */
+      if (scroller)
+      {
+        if (timer)
+        {
+          timer= FALSE;
+          query_timer_stop(stmt->dbc);
+        }
+
+        scroller_start_async(stmt);
+      }
     }
 
     error= SQL_SUCCESS;
 
 exit:
+    /* The timer runs until the result is read, a KILL may hit either */
+    if (timer && query_timer_stop(stmt->dbc) && error == SQL_ERROR)
+    {
+      set_error(stmt, MYERR_HYT00, mysql_error(&stmt->dbc->mysql),
+                mysql_errno(&stmt->dbc->mysql));
+    }
+
+    stats_add_execution(&stmt->stats, myodbc_time_us() - start);
+
+    if (stmt->dbc->query_log)
+    {
+      query_log_execute(stmt, query_length, start,
+                        stmt->result ? num_rows(stmt) : stmt->affected_rows,
+                        SQL_SUCCEEDED(error) ||
+                        error == SQL_PARAM_DATA_AVAILABLE ?
+                          0 : stmt->error.native_error);
+
+      if (stmt->dbc->ds->stats_interval > 0 &&
+          time(NULL) >= stmt->dbc->stats_logged +
+                        (time_t)stmt->dbc->ds->stats_interval)
+      {
+        query_log_stats(stmt->dbc);
+      }
+    }
+    dbc_set_running(stmt->dbc, NULL);
     myodbc_mutex_unlock(&stmt->dbc->lock);
 
 skip_unlock_exit:
@@ -241,17 +299,11 @@ SQLRETURN insert_params(STMT *stmt, SQLULEN row, char **finalquery,
   uint i,length, had_info= 0;
   NET *net;
   SQLRETURN rc= SQL_SUCCESS;
+  my_ulonglong start= myodbc_time_us();
 
-  int mutex_was_locked= myodbc_mutex_trylock(&stmt->dbc->lock);
-
-  net= &stmt->dbc->mysql.net;
+  net= &stmt->query_net;
   to= (char*) net->buff + (finalquery_length!= NULL ? *finalquery_length : 0);
 
-  if (!stmt->dbc->ds->dont_use_set_locale)
-  {
-    setlocale(LC_NUMERIC, "C");  /* force use of '.' as decimal point */
-  }
-
   if (adjust_param_bind_array(stmt) )
   {
     goto memerror;
@@ -346,28 +398,13 @@ SQLRETURN insert_params(STMT *stmt, SQLULEN row, char **finalquery,
     }
   }
 
-  if (!mutex_was_locked)
-  {
-    myodbc_mutex_unlock(&stmt->dbc->lock);
-  }
-
-  if (!stmt->dbc->ds->dont_use_set_locale)
-  {
-    setlocale(LC_NUMERIC,default_locale);
-  }
-
-
-
+  stmt->stats.params_us+= myodbc_time_us() - start;
   return rc;
 
 memerror:      /* Too much data */
   rc= set_error(stmt,MYERR_S1001,NULL,4001);
 error:
-  /* ! was _already_ locked, when we tried to lock */
-  if (!mutex_was_locked)
-    myodbc_mutex_unlock(&stmt->dbc->lock);
-  if (!stmt->dbc->ds->dont_use_set_locale)
-    setlocale(LC_NUMERIC,default_locale);
+  stmt->stats.params_us+= myodbc_time_us() - start;
   return rc;
 }
 
@@ -510,7 +547,6 @@ SQLRETURN check_c2sql_conversion_supported(STMT *stmt, DESCREC *aprec, DESCREC *
               buff_max    Size of the buffer
 
 */
-static
 SQLRETURN convert_c_type2str(STMT *stmt, SQLSMALLINT ctype, DESCREC *iprec,
                              char **res, long *length, char *buff, uint buff_max)
 {
@@ -582,26 +618,26 @@ SQLRETURN convert_c_type2str(STMT *stmt, SQLSMALLINT ctype, DESCREC *iprec,
     case SQL_C_FLOAT:
       if ( iprec->concise_type != SQL_NUMERIC && iprec->concise_type != SQL_DECIMAL )
       {
-        sprintf(buff, "%.17e", *((float*) *res));
+        *length= myodbc_d2str_shortest(*((float*) *res), TRUE, buff);
       }
       else
       {
         /* We should perpare this data for string comparison */
-        sprintf(buff, "%.15e", *((float*) *res));
+        *length= myodbc_d2str(*((float*) *res), 15, buff);
       }
-      *length= strlen(*res= buff);
+      *res= buff;
       break;
     case SQL_C_DOUBLE:
       if ( iprec->concise_type != SQL_NUMERIC && iprec->concise_type != SQL_DECIMAL )
       {
-        sprintf(buff,"%.17e",*((double*) *res));
+        *length= myodbc_d2str_shortest(*((double*) *res), FALSE, buff);
       }
       else
       {
         /* We should perpare this data for string comparison */
-        sprintf(buff,"%.15e",*((double*) *res));
+        *length= myodbc_d2str(*((double*) *res), 15, buff);
       }
-      *length= strlen(*res= buff);
+      *res= buff;
       break;
     case SQL_C_DATE:
     case SQL_C_TYPE_DATE:
@@ -769,7 +805,7 @@ SQLRETURN insert_param(STMT *stmt, uchar *place4param, DESC* apd,
     char buff[128], *data= NULL;
     BOOL convert= FALSE, free_data= FALSE;
     DBC *dbc= stmt->dbc;
-    NET *net= &dbc->mysql.net;
+    NET *net= &stmt->query_net;
     SQLLEN *octet_length_ptr= NULL;
     SQLLEN *indicator_ptr= NULL;
     SQLRETURN result= SQL_SUCCESS;
@@ -1214,7 +1250,7 @@ SQLRETURN insert_param(STMT *stmt, uchar *place4param, DESC* apd,
           goto memerror;
         }
 
-        to+= mysql_real_escape_string(&dbc->mysql, to, data, length);
+        to+= myodbc_escape_data(&dbc->mysql, to, data, length);
         to= add_to_buffer(net, to, "'", 1);
       }
     }
@@ -1291,9 +1327,17 @@ SQLRETURN do_my_pos_cursor( STMT *pStmt, STMT *pStmtCursor )
 
 SQLRETURN SQL_API SQLExecute(SQLHSTMT hstmt)
 {
+  SQLRETURN rc;
+
   CHECK_HANDLE(hstmt);
 
-  return my_SQLExecute((STMT *)hstmt);
+  if (async_poll((STMT *)hstmt, SQL_API_SQLEXECUTE, &rc))
+    return rc;
+
+  if (ASYNC_ENABLED((STMT *)hstmt))
+    return async_start((STMT *)hstmt, SQL_API_SQLEXECUTE, 0, 0);
+
+  return keyset_cursor_info((STMT *)hstmt, my_SQLExecute((STMT *)hstmt));
 }
 
 
@@ -1321,6 +1365,453 @@ BOOL map_error_to_param_status( SQLUSMALLINT *param_status_ptr, SQLRETURN rc)
   return FALSE;
 }
 
+/*
+  Returns maximal length of a query that can be sent to the server. Server's
+  max_allowed_packet is read once per connection.
+*/
+static SQLULEN get_max_query_length(STMT *stmt)
+{
+  DBC  *dbc= stmt->dbc;
+  char  value[32];
+
+  if (dbc->server_max_packet == 0)
+  {
+    if (get_session_variable(stmt, "max_allowed_packet", value) > 0)
+    {
+      dbc->server_max_packet= strtoul(value, NULL, 10);
+    }
+
+    /* Whatever has happened - we can be sure about the buffer length */
+    if (dbc->server_max_packet == 0)
+    {
+      dbc->server_max_packet= dbc->net_buffer_len;
+    }
+  }
+
+  /* Leaving a byte for the command code */
+  return myodbc_min(dbc->server_max_packet, dbc->mysql.net.max_packet_size) - 1;
+}
+
+
+/*
+  Whether the paramsets array can be sent to the server in batches rather
+  than paramset by paramset.
+*/
+static BOOL can_batch_params(STMT *stmt)
+{
+  char *row_end;
+
+  return stmt->dbc->ds->batch_params
+      && stmt->param_count > 0
+      && stmt->apd->array_size > 1
+      && !IS_BATCH(&stmt->query)
+      && is_dml_statement(&stmt->query)
+      && desc_find_dae_rec(stmt->apd) < 0
+      && (stmt->dbc->ds->allow_multiple_statements
+          || get_values_row(&stmt->query, &row_end) != NULL);
+}
+
+
+/*
+  Sends the batch of statements in one go and reads their results.
+  Returns the number of statements successfully executed. If it is less than
+  the number of statements in the batch, the error is set for the statement.
+*/
+static SQLULEN execute_statements_batch(STMT *stmt, DYNAMIC_STRING *batch)
+{
+  DBC       *dbc= stmt->dbc;
+  MYSQL_RES *result;
+  SQLULEN    executed= 0;
+  int        native_error;
+
+  if (!SQL_SUCCEEDED(set_sql_select_limit(dbc, stmt->stmt_options.max_rows,
+                                          TRUE)))
+  {
+    set_stmt_error(stmt, dbc->error.sqlstate, dbc->error.message,
+                   dbc->error.native_error);
+    return 0;
+  }
+
+  MYLOG_QUERY(stmt, batch->str);
+  lock_dbc(dbc);
+  dbc_set_running(dbc, stmt);
+  stmt->warning_count= 0;
+
+  if (check_if_server_is_alive(dbc))
+  {
+    set_stmt_error(stmt, "08S01", mysql_error(&dbc->mysql),
+                   mysql_errno(&dbc->mysql));
+    translate_error(stmt->error.sqlstate, MYERR_08S01, mysql_errno(&dbc->mysql));
+    goto exit;
+  }
+
+  native_error= mysql_real_query(&dbc->mysql, batch->str,
+                                 (unsigned long)batch->length);
+
+  /* mysql_next_result returns -1 if there are no more results */
+  while (native_error == 0)
+  {
+    /* DML statements do not return result, but just in case */
+    if ((result= mysql_store_result(&dbc->mysql)) != NULL)
+    {
+      mysql_free_result(result);
+    }
+    else
+    {
+      update_affected_rows(stmt);
+      stmt->warning_count+= mysql_warning_count(&dbc->mysql);
+    }
+
+    ++executed;
+    native_error= mysql_next_result(&dbc->mysql);
+  }
+
+  if (executed > 0)
+  {
+    stmt->state= ST_EXECUTED;
+  }
+
+  if (native_error > 0)
+  {
+    MYLOG_QUERY(stmt, mysql_error(&dbc->mysql));
+    set_stmt_error(stmt, "HY000", mysql_error(&dbc->mysql),
+                   mysql_errno(&dbc->mysql));
+    translate_error(stmt->error.sqlstate, MYERR_S1000, mysql_errno(&dbc->mysql));
+  }
+
+exit:
+  dbc_set_running(dbc, NULL);
+  myodbc_mutex_unlock(&dbc->lock);
+
+  return executed;
+}
+
+
+/* Paramset of a batch and the result of building it */
+typedef struct
+{
+  SQLULEN   row;
+  SQLRETURN rc;
+} BATCH_ROW;
+
+
+/*
+  @type    : myodbc3 internal
+  @purpose : executes paramsets array in batches. INSERT or REPLACE with
+             single VALUES row is folded into multi-row statement, other DML
+             statements are sent as multi-statement batches(that requires
+             MULTI_STATEMENTS option). Length of a batch is limited by
+             max_allowed_packet. If multi-row statement fails, its paramsets
+             are re-executed one by one, so that statuses and diagnostics of
+             paramsets are the same as without batching.
+*/
+static SQLRETURN execute_param_batches(STMT *stmt)
+{
+  DYNAMIC_STRING batch;
+  DYNAMIC_ARRAY  batch_rows;
+  BATCH_ROW      batch_row, *done;
+  NET           *net= &stmt->query_net;
+  char          *query= GET_QUERY(&stmt->query), *row_begin, *row_end= NULL,
+                *piece;
+  SQLULEN        row, next_row= 0, length, piece_length, i, executed;
+  SQLULEN        max_length= get_max_query_length(stmt);
+  size_t         prefix_length= 0, suffix_length= 0;
+  SQLUSMALLINT  *param_operation_ptr, *param_status_ptr, *lastError= NULL;
+  SQLRETURN      rc= SQL_SUCCESS;
+  int            one_of_params_not_succeded= 0, all_parameters_failed= 1;
+  int            connection_failure= 0;
+
+  row_begin= get_values_row(&stmt->query, &row_end);
+
+  if (row_begin != NULL)
+  {
+    prefix_length= row_begin - query;
+    suffix_length= GET_QUERY_END(&stmt->query) - row_end;
+  }
+
+  if (init_dynamic_string(&batch, "", myodbc_min(max_length, 65536), 8192))
+  {
+    return set_error(stmt, MYERR_S1001, NULL, 4001);
+  }
+
+  if (myodbc_init_dynamic_array(&batch_rows, sizeof(BATCH_ROW), 64, 64))
+  {
+    dynstr_free(&batch);
+    return set_error(stmt, MYERR_S1001, NULL, 4001);
+  }
+
+  /* Batches are executed by direct execution */
+  ssps_close(stmt);
+
+  while (next_row < stmt->apd->array_size)
+  {
+    /* Paramsets up to next_row have been executed or have failed */
+    if (stmt->ipd->rows_processed_ptr)
+    {
+      *stmt->ipd->rows_processed_ptr= next_row;
+    }
+
+    batch.length= 0;
+    reset_dynamic(&batch_rows);
+
+    for (row= next_row; row < stmt->apd->array_size; ++row)
+    {
+      param_operation_ptr= ptr_offset_adjust(stmt->apd->array_status_ptr,
+                                            NULL,
+                                            0/*SQL_BIND_BY_COLUMN*/,
+                                            sizeof(SQLUSMALLINT), row);
+      param_status_ptr= ptr_offset_adjust(stmt->ipd->array_status_ptr,
+                                            NULL,
+                                            0/*SQL_BIND_BY_COLUMN*/,
+                                            sizeof(SQLUSMALLINT), row);
+
+      if (param_operation_ptr && *param_operation_ptr == SQL_PARAM_IGNORE)
+      {
+        if (param_status_ptr)
+          *param_status_ptr= SQL_PARAM_UNUSED;
+
+        continue;
+      }
+
+      length= 0;
+      rc= insert_params(stmt, row, NULL, &length);
+
+      if (connection_failure && SQL_SUCCEEDED(rc))
+      {
+        /* with broken connection we always return error for all next rows */
+        rc= SQL_ERROR;
+      }
+
+      if (!SQL_SUCCEEDED(rc))
+      {
+        if (map_error_to_param_status(param_status_ptr, rc))
+        {
+          lastError= param_status_ptr;
+        }
+
+        one_of_params_not_succeded= 1;
+        continue;
+      }
+
+      /* Status of the paramset is set once its batch has been executed, it
+         may yet be deferred to the next batch */
+      if (row_begin != NULL)
+      {
+        /* Only the row is taken from the built query */
+        piece= (char*)net->buff + prefix_length;
+        piece_length= length - prefix_length - suffix_length;
+      }
+      else
+      {
+        /* Separator will be added by us */
+        piece= (char*)net->buff;
+        for (piece_length= length; piece_length > 0
+             && (isspace((uchar)piece[piece_length - 1])
+                 || piece[piece_length - 1] == ';');
+             --piece_length);
+      }
+
+      if (batch_rows.elements > 0
+        && batch.length + 2 + piece_length + suffix_length > max_length)
+      {
+        /* This paramset will start the next batch */
+        break;
+      }
+
+      if (batch_rows.elements > 0)
+      {
+        /* New line before the separator in case the statement ends with
+           comment */
+        dynstr_append_mem(&batch, row_begin != NULL ? "," : "\n;",
+                          row_begin != NULL ? 1 : 2);
+      }
+      else if (row_begin != NULL)
+      {
+        dynstr_append_mem(&batch, query, prefix_length);
+      }
+
+      batch_row.row= row;
+      batch_row.rc= rc;
+
+      if (dynstr_append_mem(&batch, piece, piece_length)
+        || push_dynamic(&batch_rows, (uchar*)&batch_row))
+      {
+        rc= set_error(stmt, MYERR_S1001, NULL, 4001);
+        goto exit;
+      }
+    }
+
+    next_row= row;
+
+    if (batch_rows.elements == 0)
+    {
+      continue;
+    }
+
+    if (row_begin != NULL)
+    {
+      dynstr_append_mem(&batch, row_end, suffix_length);
+
+      piece= myodbc_memdup(batch.str, batch.length + 1, MYF(0));
+      if (piece == NULL)
+      {
+        rc= set_error(stmt, MYERR_S1001, NULL, 4001);
+        goto exit;
+      }
+
+      stmt->warning_count= 0;
+      rc= do_query(stmt, piece, batch.length);
+      executed= SQL_SUCCEEDED(rc) ? batch_rows.elements : 0;
+    }
+    else
+    {
+      executed= execute_statements_batch(stmt, &batch);
+      rc= executed == batch_rows.elements ? SQL_SUCCESS : SQL_ERROR;
+    }
+
+    /* Warnings of a batch can't be told apart by paramset, all of its
+       paramsets get SUCCESS_WITH_INFO */
+    if (rc == SQL_SUCCESS && stmt->warning_count > 0)
+    {
+      rc= set_error(stmt, MYERR_01000, "Paramsets executed with warnings", 0);
+    }
+
+    for (i= 0; i < executed; ++i)
+    {
+      done= (BATCH_ROW*)batch_rows.buffer + i;
+      map_error_to_param_status(ptr_offset_adjust(stmt->ipd->array_status_ptr,
+                                                  NULL,
+                                                  0/*SQL_BIND_BY_COLUMN*/,
+                                                  sizeof(SQLUSMALLINT),
+                                                  done->row),
+                                rc == SQL_SUCCESS_WITH_INFO ? rc : done->rc);
+      if (done->rc != SQL_SUCCESS)
+      {
+        one_of_params_not_succeded= 1;
+      }
+    }
+
+    if (executed > 0)
+    {
+      all_parameters_failed= 0;
+    }
+
+    if (rc == SQL_SUCCESS_WITH_INFO)
+    {
+      one_of_params_not_succeded= 1;
+    }
+
+    if (SQL_SUCCEEDED(rc))
+    {
+      continue;
+    }
+
+    if (is_connection_lost(stmt->error.native_error)
+      && handle_connection_error(stmt))
+    {
+      connection_failure= 1;
+    }
+
+    if (row_begin == NULL || connection_failure)
+    {
+      /* With statements batch the paramset that has failed is known, the rest
+         of the batch will be re-sent. With lost connection the whole batch
+         has failed */
+      for (i= executed; i < batch_rows.elements; ++i)
+      {
+        row= ((BATCH_ROW*)batch_rows.buffer + i)->row;
+        param_status_ptr= ptr_offset_adjust(stmt->ipd->array_status_ptr,
+                                            NULL,
+                                            0/*SQL_BIND_BY_COLUMN*/,
+                                            sizeof(SQLUSMALLINT), row);
+        if (map_error_to_param_status(param_status_ptr, rc))
+        {
+          lastError= param_status_ptr;
+        }
+
+        if (!connection_failure)
+        {
+          next_row= row + 1;
+          break;
+        }
+      }
+
+      one_of_params_not_succeded= 1;
+      continue;
+    }
+
+    /* Multi-row statement has failed - executing its paramsets separately to
+       find out which of them has caused the error */
+    for (i= 0; i < batch_rows.elements; ++i)
+    {
+      row= ((BATCH_ROW*)batch_rows.buffer + i)->row;
+      param_status_ptr= ptr_offset_adjust(stmt->ipd->array_status_ptr,
+                                          NULL,
+                                          0/*SQL_BIND_BY_COLUMN*/,
+                                          sizeof(SQLUSMALLINT), row);
+      if (connection_failure)
+      {
+        rc= SQL_ERROR;
+      }
+      else
+      {
+        length= 0;
+        rc= insert_params(stmt, row, &piece, &length);
+
+        if (SQL_SUCCEEDED(rc))
+        {
+          rc= do_query(stmt, piece, length);
+        }
+
+        if (is_connection_lost(stmt->error.native_error)
+          && handle_connection_error(stmt))
+        {
+          connection_failure= 1;
+        }
+      }
+
+      if (map_error_to_param_status(param_status_ptr, rc))
+      {
+        lastError= param_status_ptr;
+      }
+
+      if (rc != SQL_SUCCESS)
+      {
+        one_of_params_not_succeded= 1;
+      }
+      else
+      {
+        all_parameters_failed= 0;
+      }
+    }
+  }
+
+  if (stmt->ipd->rows_processed_ptr)
+  {
+    *stmt->ipd->rows_processed_ptr= next_row;
+  }
+
+  rc= SQL_SUCCESS;
+
+exit:
+  dynstr_free(&batch);
+  delete_dynamic(&batch_rows);
+
+  /* Changing status for last detected error to SQL_PARAM_ERROR as we have
+     diagnostics for it */
+  if (lastError != NULL)
+  {
+    *lastError= SQL_PARAM_ERROR;
+  }
+
+  if (!SQL_SUCCEEDED(rc) || all_parameters_failed)
+  {
+    return SQL_ERROR;
+  }
+
+  return one_of_params_not_succeded ? SQL_SUCCESS_WITH_INFO : SQL_SUCCESS;
+}
+
 
 /*
   @type    : myodbc3 internal
@@ -1398,13 +1889,14 @@ SQLRETURN my_SQLExecute( STMT *pStmt )
     *pStmt->ipd->rows_processed_ptr= 0;
   }
 
-  /* Locking if we have params array for "SELECT" statemnt */
-  /* if param_count is zero, the rest probably are artifacts(not reset
-     attributes) from a previously executed statement. besides this lock
-     is not needed when there are no params*/
-  if (pStmt->param_count && pStmt->apd->array_size > 1 && is_select_stmt)
+  if (!is_select_stmt && can_batch_params(pStmt))
   {
-    myodbc_mutex_lock(&pStmt->dbc->lock);
+    rc= execute_param_batches(pStmt);
+
+    if (pStmt->dummy_state == ST_DUMMY_PREPARED)
+      pStmt->dummy_state= ST_DUMMY_EXECUTED;
+
+    return rc;
   }
 
   for (row= 0; row < pStmt->apd->array_size; ++row)
@@ -1441,11 +1933,6 @@ SQLRETURN my_SQLExecute( STMT *pStmt )
         if (param_status_ptr)
           *param_status_ptr= SQL_PARAM_UNUSED;
 
-        /* If this is last paramset - we will miss unlock */
-        if (pStmt->apd->array_size > 1 && is_select_stmt
-            && row == pStmt->apd->array_size - 1)
-          myodbc_mutex_unlock(&pStmt->dbc->lock);
-
         continue;
       }
 
@@ -1461,10 +1948,6 @@ SQLRETURN my_SQLExecute( STMT *pStmt )
                               "with data at execution are not supported", 0);
           lastError= param_status_ptr;
 
-          /* unlocking since we do break*/
-          if (is_select_stmt)
-            myodbc_mutex_unlock(&pStmt->dbc->lock);
-
           one_of_params_not_succeded= 1;
 
           /* For other errors we continue processing of paramsets
@@ -1503,31 +1986,21 @@ SQLRETURN my_SQLExecute( STMT *pStmt )
 
       if (!SQL_SUCCEEDED(rc))
       {
-        if (pStmt->apd->array_size > 1 && is_select_stmt
-          && row == pStmt->apd->array_size - 1)
-          myodbc_mutex_unlock(&pStmt->dbc->lock);
-
         continue/*return rc*/;
       }
 
       /* For "SELECT" statement constructing single statement using
-         "UNION ALL" */
-      if (pStmt->apd->array_size > 1 && is_select_stmt)
+         "UNION ALL". The text is built in the statement's own buffer, so
+         no connection lock is needed until it is sent */
+      if (pStmt->apd->array_size > 1 && is_select_stmt
+          && row < pStmt->apd->array_size - 1)
       {
-        if (row < pStmt->apd->array_size - 1)
-        {
-          const char * stmtsBinder= " UNION ALL ";
-          const ulong binderLength= strlen(stmtsBinder);
+        const char * stmtsBinder= " UNION ALL ";
+        const ulong binderLength= strlen(stmtsBinder);
 
-          add_to_buffer(&pStmt->dbc->mysql.net, (char*)pStmt->dbc->mysql.net.buff + length,
-                     stmtsBinder, binderLength);
-          length+= binderLength;
-        }
-        else
-        {
-          /* last select statement has been constructed - so releasing lock*/
-          myodbc_mutex_unlock(&pStmt->dbc->lock);
-        }
+        add_to_buffer(&pStmt->query_net, (char*)pStmt->query_net.buff + length,
+                   stmtsBinder, binderLength);
+        length+= binderLength;
       }
     }
 
@@ -1536,6 +2009,19 @@ SQLRETURN my_SQLExecute( STMT *pStmt )
       if (!connection_failure)
       {
         rc= do_query(pStmt, query, length);
+
+        /* Cached catalog results may not describe the tables any more */
+        if (changes_metadata(&pStmt->query))
+        {
+          catalog_cache_free(pStmt->dbc);
+        }
+
+        /* Cached statements were prepared in another default database. Any
+           statement of a batch could be USE */
+        if (pStmt->query.query_type == myqtUse || IS_BATCH(&pStmt->query))
+        {
+          ssps_cache_free(pStmt->dbc);
+        }
       }
       else
       {
@@ -1889,8 +2375,8 @@ SQLRETURN SQL_API SQLPutData( SQLHSTMT      hstmt,
 
 /**
   Cancel the query by opening another connection and using KILL when called
-  from another thread while the query lock is being held. Otherwise, treat as
-  SQLFreeStmt(hstmt, SQL_CLOSE).
+  from another thread while the query of the statement holds the connection
+  lock. Otherwise, treat as SQLFreeStmt(hstmt, SQL_CLOSE).
 
   @param[in]  hstmt  Statement handle
 
@@ -1898,56 +2384,58 @@ SQLRETURN SQL_API SQLPutData( SQLHSTMT      hstmt,
 */
 SQLRETURN SQL_API SQLCancel(SQLHSTMT hstmt)
 {
-  MYSQL *second= NULL;
+  STMT *stmt= (STMT *)hstmt;
   int error;
   DBC *dbc;
+  my_bool async, running;
+  my_ulonglong start;
 
   CHECK_HANDLE(hstmt);
 
-  dbc= ((STMT *)hstmt)->dbc;
+  dbc= stmt->dbc;
+  async= async_cancel(stmt);
   error= myodbc_mutex_trylock(&dbc->lock);
 
-  /* If there's no query going on, just close the statement. */
+  /*
+    If there's no query going on, just close the statement. Asynchronous
+    call that has not reached the server is dropped by async_cancel().
+  */
   if (error == 0)
   {
     myodbc_mutex_unlock(&dbc->lock);
-    return my_SQLFreeStmt(hstmt, SQL_CLOSE);
+    return async ? SQL_SUCCESS : my_SQLFreeStmt(hstmt, SQL_CLOSE);
   }
 
   /* If we got a non-BUSY error, it's just an error. */
   if (error != EBUSY)
-    return set_stmt_error((STMT *)hstmt, "HY000",
+    return set_stmt_error(stmt, "HY000",
                           "Unable to get connection mutex status", error);
 
   /*
-    If the mutex was locked, we need to make a new connection and KILL the
-    ongoing query.
+    The lock may be held for the query of another statement of the
+    connection. Then our call is still waiting for it and async_cancel() has
+    flagged it, the other query must go on.
   */
-  second= mysql_init(second);
-
-  /** @todo need to preserve and use ssl params */
+  myodbc_mutex_lock(&dbc->env->cancel_lock);
+  running= dbc->running_stmt == stmt;
+  myodbc_mutex_unlock(&dbc->env->cancel_lock);
 
-  if (!mysql_real_connect(second, dbc->ds->server8, dbc->ds->uid8,
-                          dbc->ds->pwd8, NULL, dbc->ds->port,
-                          dbc->ds->socket8, 0))
-  {
-    /* We do not set the SQLSTATE here, per the ODBC spec. */
-    return SQL_ERROR;
-  }
+  if (!running)
+    return SQL_SUCCESS;
 
-  {
-    char buff[40];
-    /* buff is always big enough because max length of %lu is 15 */
-    sprintf(buff, "KILL /*!50000 QUERY */ %lu", mysql_thread_id(&dbc->mysql));
-    if (mysql_real_query(second, buff, strlen(buff)))
-    {
-      mysql_close(second);
-      /* We do not set the SQLSTATE here, per the ODBC spec. */
-      return SQL_ERROR;
-    }
-  }
+  /*
+    If our query is running, we KILL it through the cancel channel of the
+    environment, which stays open for the next cancels.
+  */
+  start= myodbc_time_us();
+  error= env_cancel_query(dbc, mysql_thread_id(&dbc->mysql));
 
-  mysql_close(second);
+  /* Calls of the statement may read its counters meanwhile */
+  myodbc_mutex_lock(&dbc->env->cancel_lock);
+  ++stmt->stats.cancels;
+  stmt->stats.cancel_us+= myodbc_time_us() - start;
+  myodbc_mutex_unlock(&dbc->env->cancel_lock);
 
-  return SQL_SUCCESS;
+  /* We do not set the SQLSTATE here, per the ODBC spec. */
+  return error ? SQL_ERROR : SQL_SUCCESS;
 }
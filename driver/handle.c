@@ -87,6 +87,9 @@ SQLRETURN SQL_API my_SQLAllocEnv(SQLHENV *phenv)
     }
 #endif /* _UNIX_ */
     myodbc_mutex_init(&(*env)->lock,NULL);
+    myodbc_mutex_init(&(*env)->cancel_lock,NULL);
+    myodbc_mutex_init(&(*env)->timer_lock,NULL);
+    init_parse_cache(&(*env)->parse_cache);
 
 #ifndef USE_IODBC
     ((ENV *) *phenv)->odbc_ver= SQL_OV_ODBC3_80;
@@ -119,7 +122,14 @@ SQLRETURN SQL_API SQLAllocEnv(SQLHENV *phenv)
 SQLRETURN SQL_API my_SQLFreeEnv(SQLHENV henv)
 {
     ENV *env= (ENV *) henv;
+    env_monitor_stop(env);
+    async_stop(env);
+    env_timer_stop(env);
+    env_cancel_free(env);
     myodbc_mutex_destroy(&env->lock);
+    myodbc_mutex_destroy(&env->cancel_lock);
+    myodbc_mutex_destroy(&env->timer_lock);
+    free_parse_cache(&env->parse_cache);
 #ifndef _UNIX_
     GlobalUnlock(GlobalHandle((HGLOBAL) henv));
     GlobalFree(GlobalHandle((HGLOBAL) henv));
@@ -242,12 +252,9 @@ SQLRETURN SQL_API my_SQLAllocConnect(SQLHENV henv, SQLHDBC *phdbc)
     dbc->commit_flag= 0;
     dbc->stmt_options.max_rows= dbc->stmt_options.max_length= 0L;
     dbc->stmt_options.cursor_type= SQL_CURSOR_FORWARD_ONLY;  /* ODBC default */
-    /* 
-      Query timeout is unknown, assign with the first request in 
-      get_constmt_attr. It might never be needed, so we are not getting it
-      at the connect stage
-    */
-    dbc->stmt_options.query_timeout= (SQLULEN)-1;
+    dbc->stmt_options.retrieve_data= TRUE;                  /* SQL_RD_ON */
+    /* Enforced by the driver's timer, the server's default is not used */
+    dbc->stmt_options.query_timeout= SQL_QUERY_TIMEOUT_DEFAULT;
     dbc->login_timeout= 0;
     dbc->last_query_time= (time_t) time((time_t*) 0);
     dbc->txn_isolation= DEFAULT_TXN_ISOLATION;
@@ -261,6 +268,8 @@ SQLRETURN SQL_API my_SQLAllocConnect(SQLHENV henv, SQLHDBC *phdbc)
     dbc->exp_desc= NULL;
     dbc->sql_select_limit= (SQLULEN) -1;
     myodbc_mutex_init(&dbc->lock,NULL);
+    myodbc_mutex_init(&dbc->stmt_cache_lock,NULL);
+    myodbc_mutex_init(&dbc->catalog_cache_lock,NULL);
     myodbc_mutex_lock(&dbc->lock);
     myodbc_ov_init(penv->odbc_ver); /* Initialize based on ODBC version */
     myodbc_mutex_unlock(&dbc->lock);
@@ -310,17 +319,269 @@ int reset_connection(DBC *dbc)
 }
 
 
-int wakeup_connection(DBC *dbc)
+/* Transaction isolation level as @@tx_isolation reports it */
+static const char * txn_isolation_value(int txn_isolation)
+{
+  if (txn_isolation & SQL_TXN_SERIALIZABLE)
+    return "SERIALIZABLE";
+  if (txn_isolation & SQL_TXN_REPEATABLE_READ)
+    return "REPEATABLE-READ";
+  if (txn_isolation & SQL_TXN_READ_COMMITTED)
+    return "READ-COMMITTED";
+  return "READ-UNCOMMITTED";
+}
+
+
+/*
+  Brings the session back to the state it had after connect - account,
+  default database, character set, autocommit, transaction isolation and
+  sql_select_limit. Current state is read with one query, and what differs
+  is restored with one SET, plus COM_INIT_DB if the database has changed.
+
+  @return 0 on success, 1 if the session can't be restored without logging
+          in again
+*/
+static int restore_session_state(DBC *dbc)
+{
+  /* tx_isolation is deprecated since 5.7.20, and removed in 8.0 */
+  const char *isolation_var=
+    is_minimum_version(dbc->mysql.server_version, "5.7.20") ?
+    "transaction_isolation" : "tx_isolation";
+  char state_query[320];
+  const char *uid= dbc->ds->uid8 ? (char *)dbc->ds->uid8 : "";
+  const char *database= (char *)dbc->ds->database8;
+  const char *charset= dbc->cxn_charset_info->csname;
+  const char *isolation;
+  size_t uid_len= strlen(uid);
+  BOOL change_db= FALSE;
+  DYNAMIC_STRING set;
+  MYSQL_RES *res;
+  MYSQL_ROW row;
+  int rc= 1;
+
+  if (database != NULL && *database == '\0')
+  {
+    database= NULL;
+  }
+
+  sprintf(state_query, "SELECT USER(), DATABASE(), @@character_set_client,"
+          " @@character_set_connection, @@character_set_results, @@autocommit,"
+          " @@session.%s, @@global.%s,"
+          " @@session.sql_select_limit, @@global.sql_select_limit",
+          isolation_var, isolation_var);
+
+  MYLOG_DBC_QUERY(dbc, state_query);
+
+  if (mysql_real_query(&dbc->mysql, state_query,
+                       (unsigned long)strlen(state_query))
+      || (res= mysql_store_result(&dbc->mysql)) == NULL)
+  {
+    return 1;
+  }
+
+  if ((row= mysql_fetch_row(res)) == NULL || mysql_num_fields(res) != 10
+      || init_dynamic_string(&set, "SET ", 256, 256))
+  {
+    mysql_free_result(res);
+    return 1;
+  }
+
+  /* USER() is user@host. A database can be changed, but not deselected */
+  if (row[0] == NULL || strncmp(row[0], uid, uid_len) != 0
+      || row[0][uid_len] != '@'
+      || (database == NULL && row[1] != NULL))
+  {
+    goto done;
+  }
+
+  change_db= database != NULL && (row[1] == NULL || strcmp(row[1], database));
+
+  if (row[2] == NULL || myodbc_strcasecmp(row[2], charset))
+  {
+    dynstr_append(&set, "@@character_set_client=");
+    dynstr_append(&set, charset);
+    dynstr_append(&set, ",");
+  }
+  if (row[3] == NULL || myodbc_strcasecmp(row[3], charset))
+  {
+    dynstr_append(&set, "@@character_set_connection=");
+    dynstr_append(&set, charset);
+    dynstr_append(&set, ",");
+  }
+  /* Driver does its own conversion of results */
+  if (row[4] != NULL)
+  {
+    dynstr_append(&set, "@@character_set_results=NULL,");
+  }
+  if (row[5] == NULL || (atoi(row[5]) != 0) != (dbc->login_autocommit != 0))
+  {
+    dynstr_append(&set, dbc->login_autocommit ? "@@autocommit=1,"
+                                              : "@@autocommit=0,");
+  }
+
+  isolation= dbc->login_txn_isolation != DEFAULT_TXN_ISOLATION ?
+             txn_isolation_value(dbc->login_txn_isolation) : row[7];
+  if (row[6] == NULL || isolation == NULL || strcmp(row[6], isolation))
+  {
+    dynstr_append(&set, "@@session.");
+    dynstr_append(&set, isolation_var);
+
+    if (dbc->login_txn_isolation != DEFAULT_TXN_ISOLATION)
+    {
+      dynstr_append(&set, "='");
+      dynstr_append(&set, isolation);
+      dynstr_append(&set, "',");
+    }
+    else
+    {
+      dynstr_append(&set, "=DEFAULT,");
+    }
+  }
+
+  if (row[8] == NULL || row[9] == NULL || strcmp(row[8], row[9]))
+  {
+    dynstr_append(&set, "@@session.sql_select_limit=DEFAULT,");
+  }
+
+  /* Replacing the trailing comma */
+  if (set.length > 4)
+  {
+    set.str[--set.length]= '\0';
+    MYLOG_DBC_QUERY(dbc, set.str);
+
+    if (mysql_real_query(&dbc->mysql, set.str, (unsigned long)set.length))
+    {
+      goto done;
+    }
+  }
+
+  if (change_db && mysql_select_db(&dbc->mysql, database))
+  {
+    goto done;
+  }
+
+  x_free(dbc->database);
+  dbc->database= database ? myodbc_strdup(database, MYF(MY_WME)) : NULL;
+  dbc->txn_isolation= dbc->login_txn_isolation;
+  /* That is what set_sql_select_limit() leaves after setting DEFAULT */
+  dbc->sql_select_limit= 0;
+  rc= 0;
+
+done:
+  mysql_free_result(res);
+  dynstr_free(&set);
+
+  return rc;
+}
+
+
+/* Runs the init statement of the data source, returns 0 on success */
+static int run_init_statement(DBC *dbc)
 {
   DataSource *ds= dbc->ds;
+  MYSQL_RES *res;
+
+  if (!ds->initstmt || !ds->initstmt[0])
+  {
+    return 0;
+  }
+
+  ds_get_utf8attr(ds->initstmt, &ds->initstmt8);
+  MYLOG_DBC_QUERY(dbc, ds->initstmt8);
+
+  if (mysql_real_query(&dbc->mysql, (char *)ds->initstmt8,
+                       (unsigned long)strlen((char *)ds->initstmt8)))
+  {
+    return 1;
+  }
+
+  do
+  {
+    if ((res= mysql_store_result(&dbc->mysql)) != NULL)
+    {
+      mysql_free_result(res);
+    }
+  } while (mysql_next_result(&dbc->mysql) == 0);
+
+  return mysql_errno(&dbc->mysql) != 0;
+}
+
+
+/*
+  Clears what the previous user of the pooled connection has left in the
+  session - open transaction, user variables, temporary tables, locks,
+  prepared statements and session variables - with COM_RESET_CONNECTION,
+  and runs the init statement again.
+
+  @return 0 on success, 1 if the session can't be reset without logging
+          in again
+*/
+static int reset_session(DBC *dbc)
+{
+#if MYSQL_VERSION_ID >= 50703
+  /* The server drops them anyway, they are closed while it knows them */
+  ssps_cache_free(dbc);
 
-  if (mysql_change_user(&dbc->mysql, ds_get_utf8attr(ds->uid, &ds->uid8),
-                                     ds_get_utf8attr(ds->pwd, &ds->pwd8),
-                                     ds_get_utf8attr(ds->database, &ds->database8)))
+  MYLOG_DBC_QUERY(dbc, "COM_RESET_CONNECTION");
+
+  if (mysql_reset_connection(&dbc->mysql))
   {
     return 1;
   }
 
+  return run_init_statement(dbc);
+#else
+  return 1;
+#endif
+}
+
+
+/*
+  Makes the connection taken from the pool to be like just connected. The
+  session is reset, and what the driver sets after connect is restored.
+  Logging in again with mysql_change_user() is only used if the session
+  can't be reset and restored otherwise, because it is a full
+  authentication exchange.
+*/
+int wakeup_connection(DBC *dbc)
+{
+  DataSource *ds= dbc->ds;
+  BOOL reauth= FALSE;
+
+  lock_dbc(dbc);
+
+  if (reset_session(dbc) || restore_session_state(dbc))
+  {
+    reauth= TRUE;
+
+    if (mysql_change_user(&dbc->mysql, ds_get_utf8attr(ds->uid, &ds->uid8),
+                                       ds_get_utf8attr(ds->pwd, &ds->pwd8),
+                                       ds_get_utf8attr(ds->database, &ds->database8)))
+    {
+      myodbc_mutex_unlock(&dbc->lock);
+      return 1;
+    }
+
+    /* New session has no prepared statements, and the user may see
+       different tables */
+    ssps_cache_free(dbc);
+    catalog_cache_free(dbc);
+
+    /* The session is new, but misses what the driver sets after connect */
+    run_init_statement(dbc);
+    restore_session_state(dbc);
+  }
+
+  myodbc_mutex_unlock(&dbc->lock);
+
+  myodbc_mutex_lock(&dbc->env->lock);
+  ++dbc->env->wakeup_count;
+  if (reauth)
+  {
+    ++dbc->env->wakeup_reauth_count;
+  }
+  myodbc_mutex_unlock(&dbc->env->lock);
+
   dbc->need_to_wakeup= 0;
   return 0;
 }
@@ -336,8 +597,11 @@ SQLRETURN SQL_API my_SQLFreeConnect(SQLHDBC hdbc)
 {
     DBC *dbc= (DBC *) hdbc;
 
+    async_dbc_wait(dbc);
+
     myodbc_mutex_lock(&dbc->env->lock);
     dbc->env->connections= list_delete(dbc->env->connections,&dbc->list);
+    stats_add(&dbc->env->stats, &dbc->stats);
     myodbc_mutex_unlock(&dbc->env->lock);
     x_free(dbc->database);
     if (dbc->ds)
@@ -345,6 +609,8 @@ SQLRETURN SQL_API my_SQLFreeConnect(SQLHDBC hdbc)
       ds_delete(dbc->ds);
     }
     myodbc_mutex_destroy(&dbc->lock);
+    myodbc_mutex_destroy(&dbc->stmt_cache_lock);
+    myodbc_mutex_destroy(&dbc->catalog_cache_lock);
 
     free_explicit_descriptors(dbc);
 
@@ -489,8 +755,9 @@ SQLRETURN SQL_API my_SQLAllocStmt(SQLHDBC hdbc,SQLHSTMT *phstmt)
   stmt= (STMT *) *phstmt;
   stmt->dbc= dbc;
 
-  myodbc_mutex_lock(&stmt->dbc->lock);
+  lock_dbc(stmt->dbc);
   dbc->statements= list_add(dbc->statements,&stmt->list);
+  stmt->id= ++dbc->stmt_count;
   myodbc_mutex_unlock(&stmt->dbc->lock);
   stmt->list.data= stmt;
   stmt->stmt_options= dbc->stmt_options;
@@ -499,6 +766,9 @@ SQLRETURN SQL_API my_SQLAllocStmt(SQLHDBC hdbc,SQLHSTMT *phstmt)
   myodbc_stpmov(stmt->error.sqlstate, "00000");
   init_parsed_query(&stmt->query);
   init_parsed_query(&stmt->orig_query);
+  stmt->fetch_plan.direct_row= stmt->fetch_plan.fetched_row= -1;
+  /* The buffer is allocated by the first query built there */
+  stmt->query_net.max_packet_size= dbc->mysql.net.max_packet_size;
 
   if (!dbc->ds->no_ssps && allocate_param_bind(&stmt->param_bind, 10))
   {
@@ -561,6 +831,8 @@ SQLRETURN SQL_API SQLFreeStmt(SQLHSTMT hstmt,SQLUSMALLINT fOption)
 {
     CHECK_HANDLE(hstmt);
 
+    async_wait((STMT *)hstmt);
+
     return my_SQLFreeStmt(hstmt,fOption);
 }
 
@@ -596,6 +868,7 @@ SQLRETURN SQL_API my_SQLFreeStmtExtended(SQLHSTMT hstmt,SQLUSMALLINT fOption,
     {
       stmt->ard->records.elements= 0;
       stmt->ard->count= 0;
+      ++stmt->ard->version;
       return SQL_SUCCESS;
     }
 
@@ -612,6 +885,7 @@ SQLRETURN SQL_API my_SQLFreeStmtExtended(SQLHSTMT hstmt,SQLUSMALLINT fOption,
     stmt->dae_type= 0;
 
     scroller_reset(stmt);
+    keyset_free(stmt);
 
     if (fOption == SQL_RESET_PARAMS)
     {
@@ -683,6 +957,7 @@ SQLRETURN SQL_API my_SQLFreeStmtExtended(SQLHSTMT hstmt,SQLUSMALLINT fOption,
     stmt->table_name= 0;
     stmt->dummy_state= ST_DUMMY_UNKNOWN;
     stmt->cursor.pk_validated= FALSE;
+    stmt->cursor.keyset_validated= FALSE;
     if (stmt->setpos_apd)
     {
       desc_free(stmt->setpos_apd);
@@ -742,9 +1017,14 @@ SQLRETURN SQL_API my_SQLFreeStmtExtended(SQLHSTMT hstmt,SQLUSMALLINT fOption,
     delete_parsed_query(&stmt->query);
     delete_parsed_query(&stmt->orig_query);
     delete_param_bind(stmt->param_bind);
+    x_free(stmt->fetch_plan.cols);
+    myodbc_net_end(&stmt->query_net);
 
-    myodbc_mutex_lock(&stmt->dbc->lock);
+    lock_dbc(stmt->dbc);
     stmt->dbc->statements= list_delete(stmt->dbc->statements,&stmt->list);
+    myodbc_mutex_lock(&stmt->dbc->env->cancel_lock);
+    stats_add(&stmt->dbc->stats, &stmt->stats);
+    myodbc_mutex_unlock(&stmt->dbc->env->cancel_lock);
     myodbc_mutex_unlock(&stmt->dbc->lock);
 #ifndef _UNIX_
     GlobalUnlock(GlobalHandle ((HGLOBAL) hstmt));
@@ -773,7 +1053,7 @@ SQLRETURN my_SQLAllocDesc(SQLHDBC hdbc, SQLHANDLE *pdesc)
   /* add to this connection's list of explicit descriptors */
   e= (LIST *) myodbc_malloc(sizeof(LIST), MYF(0));
   e->data= desc;
-  myodbc_mutex_lock(&dbc->lock);
+  lock_dbc(dbc);
   dbc->exp_desc= list_add(dbc->exp_desc, e);
   myodbc_mutex_unlock(&dbc->lock);
 
@@ -805,7 +1085,7 @@ SQLRETURN my_SQLFreeDesc(SQLHANDLE hdesc)
   {
     if (ldesc->data == desc)
     {
-      myodbc_mutex_lock(&dbc->lock);
+      lock_dbc(dbc);
       dbc->exp_desc= list_delete(dbc->exp_desc, ldesc);
       myodbc_mutex_unlock(&dbc->lock);
       x_free(ldesc);
@@ -924,6 +1204,7 @@ SQLRETURN SQL_API SQLFreeHandle(SQLSMALLINT HandleType,
             break;
 
         case SQL_HANDLE_STMT:
+            async_wait((STMT *)Handle);
             error= my_SQLFreeStmt((STMT *)Handle, SQL_DROP);
             break;
 
@@ -94,11 +94,14 @@ MySQLGetInfo(SQLHDBC hdbc, SQLUSMALLINT fInfoType,
 
 #ifndef USE_IODBC
   case SQL_ASYNC_DBC_FUNCTIONS:
-    MYINFO_SET_ULONG(SQL_ASYNC_DBC_NOT_CAPABLE);
+    MYINFO_SET_ULONG(SQL_ASYNC_DBC_CAPABLE);
 #endif
 
   case SQL_ASYNC_MODE:
-    MYINFO_SET_ULONG(SQL_AM_NONE);
+    MYINFO_SET_ULONG(SQL_AM_STATEMENT);
+
+  case SQL_ASYNC_NOTIFICATION:
+    MYINFO_SET_ULONG(SQL_ASYNC_NOTIFICATION_CAPABLE);
 
   case SQL_BATCH_ROW_COUNT:
     MYINFO_SET_ULONG(SQL_BRC_EXPLICIT);
@@ -50,9 +50,14 @@ static char * my_ul_to_a(char * buf, size_t buf_size, unsigned long long a)
 
 
 /* {{{ my_f_to_a() -I- */
+/* As "%f" would, but with '.' whatever the locale is, and truncated to
+   buf_size */
 static char * my_f_to_a(char * buf, size_t buf_size, double a)
 {
-	myodbc_snprintf(buf, buf_size, "%f", a);
+	char tmp[FLOATING_POINT_BUFFER];
+
+	my_fcvt(a, 6, tmp, NULL);
+	strmake(buf, tmp, buf_size - 1);
 	return buf;
 }
 /* }}} */
@@ -105,7 +110,8 @@ BOOL ssps_get_out_params(STMT *stmt)
     /* Thus function interface has to be changed */
     if (ssps_bind_result(stmt) == 0)
     {
-      values= fetch_row(stmt);
+      /* Called with dbc->lock held */
+      values= fetch_row_nolock(stmt);
 
       /* We need this for fetch_varlength_columns pointed by fix_fields, so it omits
          streamed parameters */
@@ -245,6 +251,43 @@ BOOL ssps_get_out_params(STMT *stmt)
 }
 
 
+/*
+  Streaming (forward-only, not cached) result of a SELECT is read through a
+  read-only server cursor, so rows come in batches of the PREFETCH size or
+  of the rowset size rather than all at once, and the connection is free
+  between fetches. With neither of them set there is nothing to gain - one
+  row per round trip is slower than plain streaming.
+*/
+void ssps_set_cursor_type(STMT *stmt)
+{
+  unsigned long cursor_type= CURSOR_TYPE_NO_CURSOR, rows= 1;
+
+  if (if_forward_cache(stmt) && is_select_statement(&stmt->query))
+  {
+    if (stmt->dbc->ds->cursor_prefetch_number > 0)
+    {
+      rows= calc_prefetch_number(stmt->dbc->ds->cursor_prefetch_number,
+                                 stmt->ard->array_size,
+                                 stmt->stmt_options.max_rows);
+    }
+    else if (stmt->ard->array_size > 1)
+    {
+      rows= (unsigned long)stmt->ard->array_size;
+    }
+
+    if (rows > 1)
+    {
+      cursor_type= CURSOR_TYPE_READ_ONLY;
+    }
+  }
+
+  /* Set both every time, the statement can be executed again with other
+     attributes */
+  mysql_stmt_attr_set(stmt->ssps, STMT_ATTR_CURSOR_TYPE, &cursor_type);
+  mysql_stmt_attr_set(stmt->ssps, STMT_ATTR_PREFETCH_ROWS, &rows);
+}
+
+
 int ssps_get_result(STMT *stmt)
 {
   if (stmt->result)
@@ -273,7 +316,17 @@ void free_result_bind(STMT *stmt)
     /* buffer was allocated for each column */
     for (i= 0; i < field_cnt; i++)
     {
-      x_free(stmt->result_bind[i].buffer);
+      /* Column fetched directly to the application buffer keeps its own
+         buffer in the array */
+      if (stmt->fetch_plan.fetched_row >= 0 && stmt->array[i] != NULL
+        && stmt->result_bind[i].buffer != stmt->array[i])
+      {
+        x_free(stmt->array[i]);
+      }
+      else
+      {
+        x_free(stmt->result_bind[i].buffer);
+      }
 
       if (stmt->lengths)
       {
@@ -287,7 +340,246 @@ void free_result_bind(STMT *stmt)
     x_free(stmt->array);
     stmt->array= 0;
   }
+
+  stmt->fetch_plan.direct_row= stmt->fetch_plan.fetched_row= -1;
+}
+
+
+/* ----------- Cache of prepared statements (STMT_CACHE_SIZE) ----------- */
+
+static void ssps_cache_entry_free(MY_SSPS_CACHE_ENTRY *entry)
+{
+  if (entry->ssps != NULL)
+  {
+    mysql_stmt_close(entry->ssps);
+  }
+  x_free(entry->key);
+  x_free(entry);
+}
+
+
+/* {{{ ssps_cache_take() -I- */
+/*
+  Takes the entry of the query out of the cache of the connection. If the
+  entry has no handle, there was none prepared for the query and the caller
+  has to prepare one and set the entry's prepared flag.
+
+  Returns NULL if the cache is disabled or out of memory.
+*/
+MY_SSPS_CACHE_ENTRY *ssps_cache_take(DBC *dbc, const char *query,
+                                     size_t query_length)
+{
+  MY_SSPS_CACHE_ENTRY *entry= NULL;
+  LIST                *element;
+  char                *key;
+  uint                epoch;
+
+  if (dbc->ds->stmt_cache_size == 0
+    || !(key= myodbc_malloc(query_length, MYF(0))))
+  {
+    return NULL;
+  }
+
+  memcpy(key, query, query_length);
+
+  myodbc_mutex_lock(&dbc->stmt_cache_lock);
+
+  epoch= dbc->stmt_cache_epoch;
+
+  for (element= dbc->stmt_cache; element; element= element->next)
+  {
+    MY_SSPS_CACHE_ENTRY *cached= (MY_SSPS_CACHE_ENTRY *)element->data;
+
+    if (cached->key_length == query_length
+      && !memcmp(cached->key, key, cached->key_length))
+    {
+      dbc->stmt_cache= list_delete(dbc->stmt_cache, element);
+      --dbc->stmt_cache_count;
+      entry= cached;
+      break;
+    }
+  }
+
+  if (entry != NULL && entry->thread_id == mysql_thread_id(&dbc->mysql))
+  {
+    ++dbc->stmt_cache_hits;
+  }
+  else
+  {
+    ++dbc->stmt_cache_misses;
+  }
+
+  myodbc_mutex_unlock(&dbc->stmt_cache_lock);
+
+  if (entry != NULL && entry->thread_id != mysql_thread_id(&dbc->mysql))
+  {
+    ssps_cache_entry_free(entry);
+    entry= NULL;
+  }
+
+  if (entry != NULL)
+  {
+    x_free(key);
+    return entry;
+  }
+
+  if ((entry= (MY_SSPS_CACHE_ENTRY *)myodbc_malloc(sizeof(MY_SSPS_CACHE_ENTRY),
+                                                   MYF(MY_ZEROFILL))))
+  {
+    entry->key= key;
+    entry->key_length= query_length;
+    entry->epoch= epoch;
+    entry->list.data= entry;
+  }
+  else
+  {
+    x_free(key);
+  }
+
+  return entry;
+}
+/* }}} */
+
+
+/* {{{ ssps_cache_return() -I- */
+/*
+  Puts the handle taken with ssps_cache_take() back to the cache of the
+  connection, evicting the least recently used ones if the cache is full.
+  The entry is freed if the handle is not cached.
+
+  Returns FALSE if the handle is not for caching and has to be closed.
+*/
+BOOL ssps_cache_return(DBC *dbc, MY_SSPS_CACHE_ENTRY *entry,
+                       MYSQL_STMT *ssps)
+{
+  LIST *element, *evicted= NULL;
+  unsigned long cursor_type= CURSOR_TYPE_NO_CURSOR;
+
+  if (entry == NULL)
+  {
+    return FALSE;
+  }
+
+  /* Client errors mean the handle or the connection is broken. Server ones,
+     like a duplicate key on execution, do not affect the statement.
+     The handle is cached as if just prepared: without the result, long data
+     and server cursor of the last execution. If that fails, it is closed */
+  if (!entry->prepared || ssps == NULL || !is_connected(dbc)
+    || (mysql_stmt_errno(ssps) >= CR_MIN_ERROR
+        && mysql_stmt_errno(ssps) <= CR_MAX_ERROR)
+    || mysql_stmt_free_result(ssps) || mysql_stmt_reset(ssps)
+    || mysql_stmt_attr_set(ssps, STMT_ATTR_CURSOR_TYPE, &cursor_type))
+  {
+    ssps_cache_entry_free(entry);
+    return FALSE;
+  }
+
+  myodbc_mutex_lock(&dbc->stmt_cache_lock);
+
+  /* The cache has been flushed since the handle was taken from it */
+  if (entry->epoch != dbc->stmt_cache_epoch)
+  {
+    myodbc_mutex_unlock(&dbc->stmt_cache_lock);
+    ssps_cache_entry_free(entry);
+    return FALSE;
+  }
+
+  /* Another statement has returned the same query already */
+  for (element= dbc->stmt_cache; element; element= element->next)
+  {
+    MY_SSPS_CACHE_ENTRY *cached= (MY_SSPS_CACHE_ENTRY *)element->data;
+
+    if (cached->key_length == entry->key_length
+      && !memcmp(cached->key, entry->key, entry->key_length))
+    {
+      myodbc_mutex_unlock(&dbc->stmt_cache_lock);
+      ssps_cache_entry_free(entry);
+      return FALSE;
+    }
+  }
+
+  entry->ssps= ssps;
+  entry->thread_id= mysql_thread_id(&dbc->mysql);
+  dbc->stmt_cache= list_add(dbc->stmt_cache, &entry->list);
+  ++dbc->stmt_cache_count;
+
+  while (dbc->stmt_cache_count > dbc->ds->stmt_cache_size)
+  {
+    for (element= dbc->stmt_cache; element->next; element= element->next);
+
+    dbc->stmt_cache= list_delete(dbc->stmt_cache, element);
+    --dbc->stmt_cache_count;
+    ++dbc->stmt_cache_evictions;
+    evicted= list_add(evicted, element);
+  }
+
+  myodbc_mutex_unlock(&dbc->stmt_cache_lock);
+
+  while (evicted)
+  {
+    element= evicted;
+    evicted= list_delete(evicted, element);
+    ssps_cache_entry_free((MY_SSPS_CACHE_ENTRY *)element->data);
+  }
+
+  return TRUE;
+}
+/* }}} */
+
+
+/* {{{ ssps_cache_get() -I- */
+/*
+  Gives the statement the handle prepared for the query earlier on the
+  connection, or a new handle if there is none. In the latter case the
+  handle is remembered to go to the cache when the statement closes it.
+
+  Returns TRUE if the handle is prepared already.
+*/
+BOOL ssps_cache_get(STMT *stmt, const char *query, size_t query_length)
+{
+  MY_SSPS_CACHE_ENTRY *entry= ssps_cache_take(stmt->dbc, query, query_length);
+
+  if (entry != NULL && entry->ssps != NULL)
+  {
+    stmt->ssps= entry->ssps;
+    stmt->result_bind= 0;
+    entry->ssps= NULL;
+    stmt->ssps_entry= entry;
+
+    return TRUE;
+  }
+
+  ssps_init(stmt);
+  stmt->ssps_entry= entry;
+
+  return FALSE;
+}
+/* }}} */
+
+
+/* {{{ ssps_cache_free() -I- */
+/*
+  Closes all cached handles, when the connection is closed, the session
+  has been changed and the server does not know them anymore, or the default
+  database has changed. Handles in use are not cached when returned.
+*/
+void ssps_cache_free(DBC *dbc)
+{
+  LIST *element;
+
+  myodbc_mutex_lock(&dbc->stmt_cache_lock);
+
+  while ((element= dbc->stmt_cache))
+  {
+    dbc->stmt_cache= list_delete(dbc->stmt_cache, element);
+    ssps_cache_entry_free((MY_SSPS_CACHE_ENTRY *)element->data);
+  }
+  dbc->stmt_cache_count= 0;
+  ++dbc->stmt_cache_epoch;
+
+  myodbc_mutex_unlock(&dbc->stmt_cache_lock);
 }
+/* }}} */
 
 
 void ssps_close(STMT *stmt)
@@ -301,9 +593,20 @@ void ssps_close(STMT *stmt)
       It can fail because the connection to the server is lost, which
       is still ok because the memory is freed anyway.
     */
-    mysql_stmt_close(stmt->ssps);
+    MY_SSPS_CACHE_ENTRY *entry= stmt->ssps_entry;
+
+    stmt->ssps_entry= NULL;
+    if (!ssps_cache_return(stmt->dbc, entry, stmt->ssps))
+    {
+      mysql_stmt_close(stmt->ssps);
+    }
     stmt->ssps= NULL;
   }
+  else if (stmt->ssps_entry != NULL)
+  {
+    ssps_cache_entry_free(stmt->ssps_entry);
+    stmt->ssps_entry= NULL;
+  }
 }
 
 
@@ -597,6 +900,134 @@ int ssps_bind_result(STMT *stmt)
 }
 
 
+/*
+  Whether the value of the type is fetched to the buffer of C type exactly as
+  libmysql stores it, so the application buffer can be bound directly.
+  Temporal types are not, MYSQL_TIME is not SQL_TIMESTAMP_STRUCT.
+*/
+BOOL ssps_direct_fetch_type(MYSQL_FIELD *field, SQLSMALLINT c_type)
+{
+  BOOL is_unsigned= (field->flags & UNSIGNED_FLAG) != 0;
+
+  switch (field->type)
+  {
+    case MYSQL_TYPE_TINY:
+      return is_unsigned ? c_type == SQL_C_UTINYINT
+                         : c_type == SQL_C_STINYINT || c_type == SQL_C_TINYINT;
+
+    case MYSQL_TYPE_SHORT:
+      return is_unsigned ? c_type == SQL_C_USHORT
+                         : c_type == SQL_C_SSHORT || c_type == SQL_C_SHORT;
+
+    case MYSQL_TYPE_INT24:
+    case MYSQL_TYPE_LONG:
+      return is_unsigned ? c_type == SQL_C_ULONG
+                         : c_type == SQL_C_SLONG || c_type == SQL_C_LONG;
+
+    case MYSQL_TYPE_LONGLONG:
+      return is_unsigned ? c_type == SQL_C_UBIGINT : c_type == SQL_C_SBIGINT;
+
+    case MYSQL_TYPE_FLOAT:
+      return c_type == SQL_C_FLOAT;
+
+    case MYSQL_TYPE_DOUBLE:
+      return c_type == SQL_C_DOUBLE;
+
+    default:
+      return FALSE;
+  }
+}
+
+
+/*
+  Points result binds of the direct columns of the fetch plan to the
+  application buffers of the row set by the caller of fetch_row(), or back
+  to the driver's buffers if no row is set, and rebinds the result if
+  anything has changed.
+*/
+int ssps_bind_direct(STMT *stmt)
+{
+  MY_FETCH_PLAN     *plan= &stmt->fetch_plan;
+  MY_FETCH_PLAN_COL *col= plan->cols, *end= plan->cols;
+  const unsigned int num_fields= field_count(stmt);
+  long              rownum= plan->direct_row;
+  size_t            offset= 0;
+  BOOL              rebind= FALSE;
+  unsigned int      i;
+
+  plan->direct_row= -1;
+
+  if (rownum < 0 && plan->fetched_row < 0)
+  {
+    return 0;
+  }
+
+  plan->fetched_row= rownum;
+
+  if (rownum >= 0)
+  {
+    offset= stmt->ard->bind_offset_ptr ? (size_t)*stmt->ard->bind_offset_ptr
+                                       : 0;
+    end= plan->cols + plan->count;
+  }
+
+  /* Fixed length columns always have own buffer in stmt->array, that is
+     where they go back to */
+  for (i= 0; i < num_fields; ++i)
+  {
+    char *buffer= stmt->array[i];
+
+    while (col < end && col->column < i)
+    {
+      ++col;
+    }
+
+    if (col < end && col->column == i && col->direct)
+    {
+      buffer= col->data_ptr + offset + col->data_stride * rownum;
+    }
+
+    if (buffer != NULL && stmt->result_bind[i].buffer != buffer)
+    {
+      stmt->result_bind[i].buffer= buffer;
+      rebind= TRUE;
+    }
+  }
+
+  return rebind ? mysql_stmt_bind_result(stmt->ssps, stmt->result_bind) : 0;
+}
+
+
+/*
+  Copies the values fetched right into the application buffers to the
+  driver's buffers, so the row returned by fetch_row() is the fetched one for
+  SQLGetData() and positioned operations, whatever the application does with
+  its buffers. Direct columns are fixed width, that is at most 8 bytes per
+  column instead of the conversion.
+*/
+void ssps_copy_direct(STMT *stmt)
+{
+  const unsigned int num_fields= field_count(stmt);
+  unsigned int       i;
+
+  if (stmt->fetch_plan.fetched_row < 0)
+  {
+    return;
+  }
+
+  for (i= 0; i < num_fields; ++i)
+  {
+    MYSQL_BIND *bind= &stmt->result_bind[i];
+
+    if (stmt->array[i] != NULL && bind->buffer != stmt->array[i]
+      && !*bind->is_null)
+    {
+      memcpy(stmt->array[i], bind->buffer, bind->buffer_length);
+    }
+  }
+}
+
+
 BOOL ssps_0buffers_truncated_only(STMT *stmt)
 {
   if (stmt->fix_fields == NULL)
@@ -791,8 +1222,9 @@ long double ssps_get_double(STMT *stmt, ulong column_number, char *value, ulong
     case MYSQL_TYPE_VAR_STRING:
     {
       char buf[50];
-      long double ret = strtold(ssps_get_string(stmt, column_number, value,
-                                                &length, buf), NULL);
+      long double ret = myodbc_strtold(ssps_get_string(stmt, column_number,
+                                                       value, &length, buf),
+                                       NULL);
       return ret;
     }
 
@@ -204,12 +204,13 @@ my_ulonglong num_rows(STMT *stmt)
 }
 
 
-MYSQL_ROW fetch_row(STMT *stmt)
+/* Caller must hold dbc->lock if the rows are read from the connection */
+MYSQL_ROW fetch_row_nolock(STMT *stmt)
 {
   if (ssps_used(stmt))
   {
     int error;
-    if (ssps_bind_result(stmt))
+    if (ssps_bind_result(stmt) || ssps_bind_direct(stmt))
     {
       return NULL;
     }
@@ -222,6 +223,7 @@ MYSQL_ROW fetch_row(STMT *stmt)
       }
     }
 
+    ssps_copy_direct(stmt);
     return stmt->array;
   }
   else
@@ -231,6 +233,25 @@ MYSQL_ROW fetch_row(STMT *stmt)
 }
 
 
+MYSQL_ROW fetch_row(STMT *stmt)
+{
+  MYSQL_ROW row;
+
+  /* Buffered rows are already on the client, only reading of the rows
+     from the connection has to be serialized with the other statements */
+  if (!if_forward_cache(stmt))
+  {
+    return fetch_row_nolock(stmt);
+  }
+
+  lock_dbc(stmt->dbc);
+  row= fetch_row_nolock(stmt);
+  myodbc_mutex_unlock(&stmt->dbc->lock);
+
+  return row;
+}
+
+
 unsigned long* fetch_lengths(STMT *stmt)
 {
   if (ssps_used(stmt))
@@ -370,6 +391,8 @@ BOOL is_null(STMT *stmt, ulong column_number, char *value)
    server can produce errors, memory allocation to name one.  */
 SQLRETURN prepare(STMT *stmt, char * query, SQLINTEGER query_length)
 {
+  my_ulonglong start;
+
   /* TODO: I guess we always have to have query length here */
   if (query_length <= 0)
   {
@@ -381,10 +404,12 @@ SQLRETURN prepare(STMT *stmt, char * query, SQLINTEGER query_length)
   /* Tokenising string, detecting and storing parameters placeholders, removing {}
      So far the only possible error is memory allocation. Thus setting it here.
      If that changes we will need to make "parse" to set error and return rc */
-  if (parse(&stmt->query))
+  start= myodbc_time_us();
+  if (parse_cached(&stmt->query, &stmt->dbc->env->parse_cache))
   {
     return set_error(stmt, MYERR_S1001, NULL, 4001);
   }
+  stmt->stats.parse_us+= myodbc_time_us() - start;
 
   ssps_close(stmt);
   stmt->param_count= PARAM_COUNT(&stmt->query);
@@ -394,13 +419,20 @@ SQLRETURN prepare(STMT *stmt, char * query, SQLINTEGER query_length)
     && preparable_on_server(&stmt->query, stmt->dbc->mysql.server_version))
   {
     MYLOG_QUERY(stmt, "Using prepared statement");
-    ssps_init(stmt);
 
     /* If the query is in the form of "WHERE CURRENT OF" - we do not need to prepare
        it at the moment */
-    if (!get_cursor_name(&stmt->query))
+    if (get_cursor_name(&stmt->query))
+    {
+      ssps_init(stmt);
+    }
+    else
     {
-      if (mysql_stmt_prepare(stmt->ssps, query, query_length))
+      if (ssps_cache_get(stmt, query, query_length))
+      {
+        MYLOG_QUERY(stmt, "Prepared statement is taken from the cache");
+      }
+      else if (mysql_stmt_prepare(stmt->ssps, query, query_length))
       {
         MYLOG_QUERY(stmt, mysql_error(&stmt->dbc->mysql));
 
@@ -411,6 +443,10 @@ SQLRETURN prepare(STMT *stmt, char * query, SQLINTEGER query_length)
 
         return SQL_ERROR;
       }
+      else if (stmt->ssps_entry != NULL)
+      {
+        stmt->ssps_entry->prepared= TRUE;
+      }
 
       stmt->param_count= mysql_stmt_param_count(stmt->ssps);
 
@@ -515,8 +551,809 @@ SQLRETURN send_long_data (STMT *stmt, unsigned int param_num, DESCREC * aprec, c
 
 
 /*------------------- Scrolled cursor related stuff -------------------*/
+typedef struct st_keyset_column
+{
+  char          name[NAME_LEN + 1];
+  /* Index of the column in the result */
+  unsigned int  field;
+  /* Charset to introduce the value with, NULL for numbers */
+  const char    *charset;
+} MY_KEYSET_COLUMN;
+
+typedef struct st_keyset_position
+{
+  /* Condition selecting rows following the last one read */
+  DYNAMIC_STRING      after;
+  /* Offset of the first row selected by the condition */
+  unsigned long long  base;
+  DYNAMIC_STRING      query;
+} MY_KEYSET_POSITION;
+
+/*
+  If leading ORDER BY columns of the scrolled query make up a unique key,
+  windows are selected by the key of the last row read instead of growing
+  LIMIT offset, which server would have to read and throw away.
+*/
+typedef struct st_scroller_keyset
+{
+  /* Query without LIMIT, and the rest of the query following it */
+  char                *query, *query_end, *rest;
+  size_t              rest_len;
+  /* Condition after WHERE, if there is one, and ORDER BY clause */
+  char                *where, *order;
+  MY_ORDER_BY_COLUMN  order_by[MY_MAX_PK_PARTS];
+  uint                order_by_count;
+  MY_KEYSET_COLUMN    column[MY_MAX_PK_PARTS];
+  uint                column_count;
+  BOOL                resolved, desc;
+  /* Offset of the window in the statement's result */
+  unsigned long long  result_offset;
+  MY_KEYSET_POSITION  position;
+} MY_SCROLLER_KEYSET;
+
+
+static void keyset_position_init(MY_KEYSET_POSITION *pos, const char *after,
+                                 unsigned long long base)
+{
+  init_dynamic_string(&pos->after, after, 256, 256);
+  init_dynamic_string(&pos->query, "", 1024, 1024);
+  pos->base= base;
+}
+
+
+static void keyset_position_free(MY_KEYSET_POSITION *pos)
+{
+  dynstr_free(&pos->after);
+  dynstr_free(&pos->query);
+}
+
+
+static my_bool keyset_append_comparison(DYNAMIC_STRING *str,
+                                        MY_KEYSET_COLUMN *column,
+                                        const char *op, MYSQL_ROW row,
+                                        unsigned long *lengths)
+{
+  static const char hex[]= "0123456789ABCDEF";
+  const char *value= row[column->field];
+  unsigned long i, length= lengths[column->field];
+  char *pos;
+
+  if (value == NULL
+      || dynstr_append_quoted_name(str, column->name)
+      || dynstr_append(str, op))
+  {
+    return TRUE;
+  }
+
+  if (column->charset == NULL)
+  {
+    return dynstr_append_mem(str, value, length);
+  }
+
+  /* Hex literal introduced with column's charset needs neither escaping
+     nor conversion of the value */
+  if (dynstr_append_mem(str, "_", 1) || dynstr_append(str, column->charset)
+      || dynstr_append_mem(str, " X'", 3)
+      || dynstr_realloc(str, length * 2 + 1))
+  {
+    return TRUE;
+  }
+
+  pos= str->str + str->length;
+  for (i= 0; i < length; ++i)
+  {
+    *pos++= hex[(unsigned char)value[i] >> 4];
+    *pos++= hex[(unsigned char)value[i] & 0x0F];
+  }
+  str->length+= length * 2;
+
+  return dynstr_append_mem(str, "'", 1);
+}
+
+
+/*
+  Makes position to follow the last row of the window read at given offset.
+  For (k1, k2) key the condition is "(k1 > v1 OR k1 = v1 AND (k2 > v2))"
+*/
+static my_bool keyset_position_update(MY_SCROLLER_KEYSET *keyset,
+                                      MY_KEYSET_POSITION *pos,
+                                      MYSQL_RES *result,
+                                      unsigned long long offset)
+{
+  my_ulonglong rows= mysql_num_rows(result);
+  const char *op= keyset->desc ? " < " : " > ";
+  MYSQL_ROW row;
+  unsigned long *lengths;
+  my_bool error= FALSE;
+  uint i;
+
+  if (rows == 0)
+  {
+    return FALSE;
+  }
+
+  mysql_data_seek(result, rows - 1);
+  row= mysql_fetch_row(result);
+  lengths= mysql_fetch_lengths(result);
+
+  pos->after.length= 0;
+
+  for (i= 0; i < keyset->column_count && !error; ++i)
+  {
+    error= dynstr_append_mem(&pos->after, "(", 1)
+        || keyset_append_comparison(&pos->after, keyset->column + i, op,
+                                    row, lengths);
+
+    if (!error && i + 1 < keyset->column_count)
+    {
+      error= dynstr_append_mem(&pos->after, " OR ", 4)
+          || keyset_append_comparison(&pos->after, keyset->column + i,
+                                      " = ", row, lengths)
+          || dynstr_append_mem(&pos->after, " AND ", 5);
+    }
+  }
+
+  for (i= 0; i < keyset->column_count && !error; ++i)
+  {
+    error= dynstr_append_mem(&pos->after, ")", 1);
+  }
+
+  mysql_data_seek(result, 0);
+
+  if (error)
+  {
+    pos->after.length= 0;
+    return TRUE;
+  }
+
+  pos->base= offset + rows;
+
+  return FALSE;
+}
+
+
+/*
+  Composes query for the window at given offset relative to the position
+  into pos->query. Fails if the window precedes the position.
+*/
+static my_bool keyset_build_query(MY_SCROLLER_KEYSET *keyset,
+                                  MY_KEYSET_POSITION *pos,
+                                  unsigned long long offset,
+                                  unsigned int count)
+{
+  char limit[7/*" LIMIT "*/ + MAX64_BUFF_SIZE + MAX32_BUFF_SIZE + 1];
+  DYNAMIC_STRING *query= &pos->query;
+  my_bool error;
+
+  if (offset < pos->base)
+  {
+    return TRUE;
+  }
+
+  query->length= 0;
+
+  if (pos->after.length == 0)
+  {
+    /* Nothing has been read yet */
+    error= dynstr_append_mem(query, keyset->query,
+                             keyset->order - keyset->query);
+  }
+  else if (keyset->where != NULL)
+  {
+    error= dynstr_append_mem(query, keyset->query,
+                             keyset->where - keyset->query)
+        || dynstr_append_mem(query, " ", 1)
+        || dynstr_append_mem(query, pos->after.str, pos->after.length)
+        || dynstr_append_mem(query, " AND (", 6)
+        || dynstr_append_mem(query, keyset->where,
+                             keyset->order - keyset->where)
+        || dynstr_append_mem(query, ") ", 2);
+  }
+  else
+  {
+    error= dynstr_append_mem(query, keyset->query,
+                             keyset->order - keyset->query)
+        || dynstr_append_mem(query, " WHERE ", 7)
+        || dynstr_append_mem(query, pos->after.str, pos->after.length)
+        || dynstr_append_mem(query, " ", 1);
+  }
+
+  myodbc_snprintf(limit, sizeof(limit), " LIMIT %llu,%u ",
+                  offset - pos->base, count);
+
+  return error
+      || dynstr_append_mem(query, keyset->order,
+                           keyset->query_end - keyset->order)
+      || dynstr_append(query, limit)
+      || dynstr_append_mem(query, keyset->rest, keyset->rest_len);
+}
+
+
+static void scroller_keyset_create(STMT *stmt, char *query, char *query_end,
+                                   MY_LIMIT_CLAUSE *limit)
+{
+  MY_SCROLLER_KEYSET *keyset;
+  MY_PARSED_QUERY parsed;
+  size_t len= limit->begin - query, rest_len= query_end - limit->end;
+  char *copy;
+
+  if (if_forward_cache(stmt))
+  {
+    return;
+  }
+
+  keyset= (MY_SCROLLER_KEYSET *)myodbc_malloc(sizeof(MY_SCROLLER_KEYSET),
+                                              MYF(MY_ZEROFILL));
+  copy= (char *)myodbc_malloc(len + rest_len + 1, MYF(0));
+
+  if (keyset == NULL || copy == NULL)
+  {
+    x_free(keyset);
+    x_free(copy);
+    return;
+  }
+
+  memcpy(copy, query, len);
+  memcpy(copy + len, limit->end, rest_len);
+  copy[len + rest_len]= '\0';
+
+  /* Parsed query takes the ownership of the copy */
+  init_parsed_query(&parsed);
+  reset_parsed_query(&parsed, copy, copy + len, stmt->dbc->cxn_charset_info);
+
+  if (!parse(&parsed))
+  {
+    keyset->order_by_count= get_order_by_columns(&parsed, keyset->order_by,
+                                                 MY_MAX_PK_PARTS,
+                                                 &keyset->where,
+                                                 &keyset->order);
+  }
+
+  if (keyset->order_by_count == 0)
+  {
+    delete_parsed_query(&parsed);
+    x_free(keyset);
+    return;
+  }
+
+  parsed.query= NULL;
+  delete_parsed_query(&parsed);
+
+  keyset->query=     copy;
+  keyset->query_end= copy + len;
+  keyset->rest=      keyset->query_end;
+  keyset->rest_len=  rest_len;
+  keyset_position_init(&keyset->position, "", 0);
+
+  stmt->scroller.keyset= keyset;
+}
+
+
+static void scroller_keyset_free(STMT *stmt)
+{
+  MY_SCROLLER_KEYSET *keyset= stmt->scroller.keyset;
+
+  keyset_position_free(&keyset->position);
+  x_free(keyset->query);
+  x_free(keyset);
+
+  stmt->scroller.keyset= NULL;
+}
+
+
+static BOOL order_by_matches(MY_ORDER_BY_COLUMN *column, const char *name)
+{
+  return name != NULL && strlen(name) == column->name_len
+      && !myodbc_casecmp(name, column->name, column->name_len);
+}
+
+
+/*
+  Decides if the keyset can be used, i.e. if leading ORDER BY columns of the
+  query are NOT NULL columns of the result and make up a unique key of the
+  table. It needs the result metadata, thus is done once 1st window is read.
+*/
+static void scroller_keyset_resolve(STMT *stmt)
+{
+  MY_SCROLLER_KEYSET *keyset= stmt->scroller.keyset;
+  MYSQL_RES *result= stmt->result;
+  BOOL used[MY_MAX_PK_PARTS];
+  uint i, j, k;
+
+  keyset->resolved= TRUE;
+
+  /* Keys are looked up for the table of the 1st column */
+  if (result == NULL || result->fields->org_table == NULL
+      || *result->fields->org_table == '\0'
+      || !check_if_usable_unique_key_exists(stmt)
+      || stmt->cursor.pk_count > keyset->order_by_count)
+  {
+    scroller_keyset_free(stmt);
+    return;
+  }
+
+  memset(used, 0, sizeof(used));
+
+  for (i= 0; i < stmt->cursor.pk_count; ++i)
+  {
+    MY_ORDER_BY_COLUMN *order_by= keyset->order_by + i;
+    MYSQL_FIELD *field= NULL;
+
+    /* Like the server, looking in aliases first */
+    for (j= 0; j < result->field_count && field == NULL; ++j)
+    {
+      if (order_by_matches(order_by, result->fields[j].name))
+      {
+        field= result->fields + j;
+      }
+    }
+    for (j= 0; j < result->field_count && field == NULL; ++j)
+    {
+      if (order_by_matches(order_by, result->fields[j].org_name))
+      {
+        field= result->fields + j;
+      }
+    }
+
+    /* ENUM and SET are ordered by their numbers, but would be compared
+       with the key values as strings */
+    if (field == NULL || order_by->desc != keyset->order_by[0].desc
+        || !(field->flags & NOT_NULL_FLAG)
+        || field->type == MYSQL_TYPE_FLOAT || field->type == MYSQL_TYPE_DOUBLE
+        || field->type == MYSQL_TYPE_BIT
+        || (field->flags & (ENUM_FLAG | SET_FLAG)))
+    {
+      break;
+    }
+
+    for (k= 0; k < stmt->cursor.pk_count; ++k)
+    {
+      if (!used[k] && !myodbc_strcasecmp(stmt->cursor.pkcol[k].name,
+                                         field->org_name))
+      {
+        break;
+      }
+    }
+
+    if (k == stmt->cursor.pk_count)
+    {
+      break;
+    }
+
+    used[k]= TRUE;
+    myodbc_stpmov(keyset->column[i].name, field->org_name);
+    keyset->column[i].field= (unsigned int)(field - result->fields);
+    keyset->column[i].charset= NULL;
+
+    if (!is_numeric_mysql_type(field))
+    {
+      CHARSET_INFO *cs= get_charset(field->charsetnr, MYF(0));
+
+      if (cs == NULL)
+      {
+        break;
+      }
+      keyset->column[i].charset= cs->csname;
+    }
+  }
+
+  if (i < stmt->cursor.pk_count)
+  {
+    scroller_keyset_free(stmt);
+    return;
+  }
+
+  keyset->column_count= stmt->cursor.pk_count;
+  keyset->desc=         keyset->order_by[0].desc;
+}
+
+
+typedef struct st_scroller_window
+{
+  MYSQL_RES          *result;
+  unsigned long long offset;
+} MY_SCROLLER_WINDOW;
+
+/*
+  Windows of the scrolled query fetched ahead by a worker thread on its own
+  connection, while the application reads the current window.
+*/
+typedef struct st_scroller_async
+{
+  MYSQL               mysql;
+  myodbc_thread_t     thread;
+  myodbc_mutex_t      lock;
+  myodbc_cond_t       cond;
+  /* Worker's own copy of the scroller query */
+  char                *query, *offset_pos;
+  unsigned long long  query_len;
+  /* If set, windows are selected by key from worker's own position */
+  MY_SCROLLER_KEYSET  *keyset;
+  MY_KEYSET_POSITION  position;
+  unsigned int        row_count;
+  /* Offset of the window to be fetched next */
+  unsigned long long  next_offset;
+  /* Offset the query ends at, 0 if the number of rows isn't limited */
+  unsigned long long  end_offset;
+  /* Ring buffer of fetched windows */
+  MY_SCROLLER_WINDOW  *windows;
+  unsigned int        depth, head, count;
+  BOOL                eof, stop;
+} MY_SCROLLER_ASYNC;
+
+
+static void * scroller_async_worker(void *arg)
+{
+  MY_SCROLLER_ASYNC *async= (MY_SCROLLER_ASYNC *)arg;
+
+  mysql_thread_init();
+
+  myodbc_mutex_lock(&async->lock);
+
+  while (!async->stop)
+  {
+    unsigned long long offset= async->next_offset;
+    unsigned int count= async->row_count;
+    MYSQL_RES *res= NULL;
+    char *query= NULL;
+    unsigned long query_len= 0;
+
+    if (async->eof || async->count == async->depth)
+    {
+      myodbc_cond_wait(&async->cond, &async->lock);
+      continue;
+    }
+
+    if (async->end_offset > 0)
+    {
+      if (offset >= async->end_offset)
+      {
+        async->eof= TRUE;
+        myodbc_cond_broadcast(&async->cond);
+        continue;
+      }
+      if (offset + count > async->end_offset)
+      {
+        count= (unsigned int)(async->end_offset - offset);
+      }
+    }
+
+    myodbc_mutex_unlock(&async->lock);
+
+    if (async->keyset != NULL)
+    {
+      if (!keyset_build_query(async->keyset, &async->position, offset, count))
+      {
+        query=     async->position.query.str;
+        query_len= (unsigned long)async->position.query.length;
+      }
+    }
+    else
+    {
+      myodbc_snprintf(async->offset_pos, MAX64_BUFF_SIZE, "%*llu",
+                      MAX64_BUFF_SIZE - 1, offset);
+      async->offset_pos[MAX64_BUFF_SIZE - 1]= ',';
+      myodbc_snprintf(async->offset_pos + MAX64_BUFF_SIZE, MAX32_BUFF_SIZE,
+                      "%*u", MAX32_BUFF_SIZE - 1, count);
+      async->offset_pos[MAX64_BUFF_SIZE + MAX32_BUFF_SIZE - 1]= ' ';
+      query=     async->query;
+      query_len= (unsigned long)async->query_len;
+    }
+
+    if (query != NULL && !mysql_real_query(&async->mysql, query, query_len))
+    {
+      res= mysql_store_result(&async->mysql);
+    }
+
+    /* Skipped window is still good to move the position */
+    if (res != NULL && async->keyset != NULL
+        && keyset_position_update(async->keyset, &async->position, res,
+                                  offset))
+    {
+      mysql_free_result(res);
+      res= NULL;
+    }
+
+    myodbc_mutex_lock(&async->lock);
+
+    if (res == NULL)
+    {
+      /* The statement will run this window itself and report the error */
+      async->eof= TRUE;
+    }
+    else if (offset != async->next_offset)
+    {
+      /* The statement has skipped this window meanwhile */
+      mysql_free_result(res);
+    }
+    else
+    {
+      MY_SCROLLER_WINDOW *window=
+        &async->windows[(async->head + async->count) % async->depth];
+
+      /* The result is stored entirely, and can outlive this connection */
+      res->handle= NULL;
+      window->result= res;
+      window->offset= offset;
+      ++async->count;
+      async->next_offset+= async->row_count;
+
+      if (mysql_num_rows(res) < count)
+      {
+        async->eof= TRUE;
+      }
+    }
+
+    myodbc_cond_broadcast(&async->cond);
+  }
+
+  myodbc_mutex_unlock(&async->lock);
+
+  mysql_close(&async->mysql);
+
+  mysql_thread_end();
+
+  return NULL;
+}
+
+
+/*
+  Gives the worker's connection the sql_mode and time_zone of the
+  statement's one, so that its windows are ordered, compared and formatted
+  as the 1st one. The init statement of the data source has been run by
+  myodbc_connect_internal(). Returns 0 on success.
+*/
+static int scroller_async_session(STMT *stmt, MYSQL *mysql)
+{
+  static const char select[]= "SELECT @@SESSION.sql_mode, @@SESSION.time_zone";
+  MYSQL_RES *res;
+  MYSQL_ROW row;
+  unsigned long *lengths;
+  char *query, *to;
+  int error= 1;
+
+  if (mysql_real_query(&stmt->dbc->mysql, select, sizeof(select) - 1)
+      || !(res= mysql_store_result(&stmt->dbc->mysql)))
+  {
+    return 1;
+  }
+
+  if ((row= mysql_fetch_row(res)) && row[0] && row[1]
+      && (lengths= mysql_fetch_lengths(res))
+      && (query= (char *)myodbc_malloc(2 * (lengths[0] + lengths[1]) + 48,
+                                       MYF(0))))
+  {
+    to= myodbc_stpmov(query, "SET SESSION sql_mode='");
+    to+= mysql_real_escape_string(mysql, to, row[0], lengths[0]);
+    to= myodbc_stpmov(to, "', time_zone='");
+    to+= mysql_real_escape_string(mysql, to, row[1], lengths[1]);
+    to= myodbc_stpmov(to, "'");
+
+    error= mysql_real_query(mysql, query, (unsigned long)(to - query));
+    x_free(query);
+  }
+
+  mysql_free_result(res);
+
+  return error;
+}
+
+
+/*
+  Starts fetching windows from the given offset on in the background, if
+  the data source asks for it. Called while no result is being read from
+  the statement's connection.
+  The other connection does not see uncommitted changes and session state of
+  the statement's one, thus it is only used outside of transactions.
+*/
+static void scroller_async_start(STMT *stmt, unsigned long long offset)
+{
+  MY_SCROLLER_ASYNC *async;
+  unsigned int depth= stmt->dbc->ds->cursor_prefetch_async;
+
+  if (depth == 0 || if_forward_cache(stmt)
+      || !autocommit_on(stmt->dbc)
+      || (stmt->dbc->mysql.server_status & SERVER_STATUS_IN_TRANS)
+      || (stmt->scroller.total_rows > 0 && offset >=
+          stmt->scroller.start_offset + stmt->scroller.total_rows))
+  {
+    return;
+  }
+
+  async= (MY_SCROLLER_ASYNC *)myodbc_malloc(sizeof(MY_SCROLLER_ASYNC),
+                                            MYF(MY_ZEROFILL));
+  if (async == NULL)
+  {
+    return;
+  }
+
+  async->windows= (MY_SCROLLER_WINDOW *)myodbc_malloc(
+                                        sizeof(MY_SCROLLER_WINDOW) * depth,
+                                        MYF(MY_ZEROFILL));
+  async->query= (char *)myodbc_memdup(stmt->scroller.query,
+                                      (size_t)stmt->scroller.query_len + 1,
+                                      MYF(0));
+
+  if (async->windows == NULL || async->query == NULL)
+  {
+    x_free(async->windows);
+    x_free(async->query);
+    x_free(async);
+    return;
+  }
+
+  async->offset_pos=  async->query + (stmt->scroller.offset_pos -
+                                      stmt->scroller.query);
+  async->query_len=   stmt->scroller.query_len;
+  async->row_count=   stmt->scroller.row_count;
+  async->next_offset= offset;
+  async->end_offset=  stmt->scroller.total_rows > 0 ?
+                      stmt->scroller.start_offset + stmt->scroller.total_rows :
+                      0;
+  async->depth=       depth;
+
+  if (myodbc_connect_internal(stmt->dbc, &async->mysql))
+  {
+    MYLOG_QUERY(stmt, "Could not open connection for PREFETCH_ASYNC");
+    x_free(async->windows);
+    x_free(async->query);
+    x_free(async);
+    return;
+  }
+
+  if (scroller_async_session(stmt, &async->mysql))
+  {
+    MYLOG_QUERY(stmt, "Could not copy session state for PREFETCH_ASYNC");
+    mysql_close(&async->mysql);
+    x_free(async->windows);
+    x_free(async->query);
+    x_free(async);
+    return;
+  }
+
+  if (stmt->scroller.keyset != NULL)
+  {
+    async->keyset= stmt->scroller.keyset;
+    keyset_position_init(&async->position,
+                         stmt->scroller.keyset->position.after.str,
+                         stmt->scroller.keyset->position.base);
+  }
+
+  myodbc_mutex_init(&async->lock, NULL);
+  myodbc_cond_init(&async->cond);
+
+  if (myodbc_thread_create(&async->thread, scroller_async_worker, async))
+  {
+    mysql_close(&async->mysql);
+    if (async->keyset != NULL)
+    {
+      keyset_position_free(&async->position);
+    }
+    myodbc_cond_destroy(&async->cond);
+    myodbc_mutex_destroy(&async->lock);
+    x_free(async->windows);
+    x_free(async->query);
+    x_free(async);
+    return;
+  }
+
+  stmt->scroller.async= async;
+}
+
+
+/*
+  To be called once the first window is read. With keyset the start waits
+  until the position is known as well.
+*/
+void scroller_start_async(STMT *stmt)
+{
+  if (stmt->scroller.keyset == NULL)
+  {
+    scroller_async_start(stmt, stmt->scroller.next_offset);
+  }
+}
+
+
+static void scroller_async_stop(STMT *stmt)
+{
+  MY_SCROLLER_ASYNC *async= stmt->scroller.async;
+
+  myodbc_mutex_lock(&async->lock);
+  async->stop= TRUE;
+  myodbc_cond_broadcast(&async->cond);
+  myodbc_mutex_unlock(&async->lock);
+
+  /* Waits for the window being fetched, if any */
+  myodbc_thread_join(&async->thread);
+
+  while (async->count > 0)
+  {
+    mysql_free_result(async->windows[async->head].result);
+    async->head= (async->head + 1) % async->depth;
+    --async->count;
+  }
+
+  if (async->keyset != NULL)
+  {
+    keyset_position_free(&async->position);
+  }
+  myodbc_cond_destroy(&async->cond);
+  myodbc_mutex_destroy(&async->lock);
+  x_free(async->windows);
+  x_free(async->query);
+  x_free(async);
+
+  stmt->scroller.async= NULL;
+}
+
+
+/*
+  Returns the window at the given offset if the worker has fetched it, or
+  NULL if the statement has to run the query for it itself.
+*/
+static MYSQL_RES * scroller_async_take(STMT *stmt, unsigned long long offset)
+{
+  MY_SCROLLER_ASYNC *async= stmt->scroller.async;
+  MYSQL_RES *res= NULL;
+
+  myodbc_mutex_lock(&async->lock);
+
+  for (;;)
+  {
+    if (async->count > 0)
+    {
+      MY_SCROLLER_WINDOW *window= &async->windows[async->head];
+
+      if (window->offset > offset)
+      {
+        break;
+      }
+
+      async->head= (async->head + 1) % async->depth;
+      --async->count;
+
+      if (window->offset == offset)
+      {
+        res= window->result;
+        break;
+      }
+
+      /* Application has jumped over this window */
+      mysql_free_result(window->result);
+    }
+    else if (offset == async->next_offset && !async->eof)
+    {
+      /* It is being fetched right now */
+      myodbc_cond_wait(&async->cond, &async->lock);
+    }
+    else
+    {
+      if (offset > async->next_offset)
+      {
+        /* This one is fetched by the statement, worker continues after it */
+        async->next_offset= offset + async->row_count;
+      }
+      break;
+    }
+  }
+
+  myodbc_cond_broadcast(&async->cond);
+  myodbc_mutex_unlock(&async->lock);
+
+  return res;
+}
+
+
 void scroller_reset(STMT *stmt)
 {
+  if (stmt->scroller.async != NULL)
+  {
+    scroller_async_stop(stmt);
+  }
+  if (stmt->scroller.keyset != NULL)
+  {
+    scroller_keyset_free(stmt);
+  }
   x_free(stmt->scroller.query);
   stmt->scroller.next_offset= 0;
   stmt->scroller.query= stmt->scroller.offset_pos= NULL;
@@ -590,6 +1427,12 @@ void scroller_create(STMT * stmt, char *query, SQLULEN query_len)
 
   stmt->scroller.next_offset= myodbc_max(limit.offset, 0);
 
+  scroller_keyset_create(stmt, query, query + query_len, &limit);
+  if (stmt->scroller.keyset != NULL)
+  {
+    stmt->scroller.keyset->result_offset= stmt->scroller.next_offset;
+  }
+
   /*extend_buffer(&stmt->dbc->mysql.net, stmt->query_end, len2add);*/
   stmt->scroller.query_len= query_len + len2add;
   stmt->scroller.query= (char*)myodbc_malloc((size_t)stmt->scroller.query_len + 1,
@@ -619,6 +1462,8 @@ void scroller_create(STMT * stmt, char *query, SQLULEN query_len)
 /* Returns next offset/maxrow for current fetch*/
 unsigned long long scroller_move(STMT * stmt)
 {
+  ++stmt->stats.scroller_windows;
+
   myodbc_snprintf(stmt->scroller.offset_pos, MAX64_BUFF_SIZE, "%*llu", MAX64_BUFF_SIZE - 1,
     stmt->scroller.next_offset);
   stmt->scroller.offset_pos[MAX64_BUFF_SIZE - 1]=',';
@@ -631,6 +1476,13 @@ unsigned long long scroller_move(STMT * stmt)
 
 SQLRETURN scroller_prefetch(STMT * stmt)
 {
+  MY_SCROLLER_KEYSET *keyset= stmt->scroller.keyset;
+  unsigned long long offset= stmt->scroller.next_offset -
+                             stmt->scroller.row_count;
+  unsigned int row_count= stmt->scroller.row_count;
+  char *query= stmt->scroller.query;
+  unsigned long query_len= (unsigned long)stmt->scroller.query_len;
+
   if (stmt->scroller.total_rows > 0
       && stmt->scroller.next_offset >= (stmt->scroller.total_rows + stmt->scroller.start_offset))
   {
@@ -645,6 +1497,7 @@ SQLRETURN scroller_prefetch(STMT * stmt)
       myodbc_snprintf(stmt->scroller.offset_pos + MAX64_BUFF_SIZE, MAX32_BUFF_SIZE,
               "%*u", MAX32_BUFF_SIZE - 1, (unsigned long)count);
       stmt->scroller.offset_pos[MAX64_BUFF_SIZE + MAX32_BUFF_SIZE - 1] = ' ';
+      row_count= (unsigned int)count;
     }
     else
     {
@@ -652,12 +1505,63 @@ SQLRETURN scroller_prefetch(STMT * stmt)
     }
   }
 
-  MYLOG_QUERY(stmt, stmt->scroller.query);
+  if (keyset != NULL)
+  {
+    BOOL first_window= !keyset->resolved;
 
-  myodbc_mutex_lock(&stmt->dbc->lock);
+    if (first_window)
+    {
+      scroller_keyset_resolve(stmt);
+      keyset= stmt->scroller.keyset;
+    }
+
+    /* Position follows the window being replaced */
+    if (keyset != NULL && stmt->result != NULL
+        && keyset_position_update(keyset, &keyset->position, stmt->result,
+                                  keyset->result_offset))
+    {
+      return set_error(stmt, MYERR_S1001, NULL, 4001);
+    }
 
-  if (exec_stmt_query(stmt, stmt->scroller.query,
-                        (unsigned long)stmt->scroller.query_len, FALSE))
+    /* Start of the worker has been put off until the position is known */
+    if (first_window)
+    {
+      scroller_async_start(stmt, offset);
+    }
+  }
+
+  if (stmt->scroller.async != NULL)
+  {
+    MYSQL_RES *res= scroller_async_take(stmt, offset);
+    if (res != NULL)
+    {
+      MYLOG_QUERY(stmt, "Using prefetched window of the query");
+      free_internal_result_buffers(stmt);
+      mysql_free_result(stmt->result);
+      stmt->result= res;
+
+      if (keyset != NULL)
+      {
+        keyset->result_offset= offset;
+        ++stmt->stats.keyset_windows;
+      }
+      return SQL_SUCCESS;
+    }
+  }
+
+  if (keyset != NULL
+      && !keyset_build_query(keyset, &keyset->position, offset, row_count))
+  {
+    query=     keyset->position.query.str;
+    query_len= (unsigned long)keyset->position.query.length;
+    ++stmt->stats.keyset_windows;
+  }
+
+  MYLOG_QUERY(stmt, query);
+
+  lock_dbc(stmt->dbc);
+
+  if (exec_stmt_query(stmt, query, query_len, FALSE))
   {
     myodbc_mutex_unlock(&stmt->dbc->lock);
     return SQL_ERROR;
@@ -665,6 +1569,11 @@ SQLRETURN scroller_prefetch(STMT * stmt)
 
   get_result_metadata(stmt, FALSE);
 
+  if (keyset != NULL)
+  {
+    keyset->result_offset= offset;
+  }
+
   /* I think there is no need to do fix_result_types here */
   myodbc_mutex_unlock(&stmt->dbc->lock);
 
@@ -50,10 +50,10 @@
 #define digit(A) ((int) (A - '0'))
 
 #define MYLOG_QUERY(A,B) {if ((A)->dbc->ds->save_queries) \
-               query_print((A)->dbc->query_log,(char*) B);}
+               query_log_print((A)->dbc, (A), (char*) B);}
 
 #define MYLOG_DBC_QUERY(A,B) {if((A)->ds->save_queries) \
-               query_print((A)->query_log,(char*) B);}
+               query_log_print((A), NULL, (char*) B);}
 
 /* A few character sets we care about. */
 #define ASCII_CHARSET_NUMBER  11
@@ -133,6 +133,7 @@ SQLRETURN         my_SQLExecute         (STMT * stmt);
 SQLRETURN SQL_API my_SQLFreeStmt        (SQLHSTMT hstmt,SQLUSMALLINT fOption);
 SQLRETURN SQL_API my_SQLFreeStmtExtended(SQLHSTMT hstmt,
                                         SQLUSMALLINT fOption, uint clearAllResults);
+SQLRETURN         my_SQLMoreResults     (STMT *stmt);
 SQLRETURN SQL_API my_SQLAllocStmt       (SQLHDBC hdbc,SQLHSTMT *phstmt);
 SQLRETURN         do_query              (STMT *stmt,char *query, SQLULEN query_length);
 SQLRETURN         insert_params         (STMT *stmt, SQLULEN row, char **finalquery,
@@ -140,6 +141,8 @@ SQLRETURN         insert_params         (STMT *stmt, SQLULEN row, char **finalqu
 SQLRETURN odbc_stmt(DBC *dbc, const char *query, SQLULEN query_length,
                     my_bool reqLock);
 void      myodbc_link_fields (STMT *stmt,MYSQL_FIELD *fields,uint field_count);
+void      lock_dbc           (DBC *dbc);
+void      dbc_set_running    (DBC *dbc, STMT *stmt);
 void      fix_row_lengths   (STMT *stmt, const long* fix_rules, uint row, uint field_count);
 void      fix_result_types  (STMT *stmt);
 char *    fix_str           (char *to,const char *from,int length);
@@ -151,6 +154,9 @@ SQLRETURN my_pos_update (STMT *stmt,STMT *stmtParam,
 char *    check_if_positioned_cursor_exists (STMT *stmt, STMT **stmtNew);
 SQLRETURN insert_param  (STMT *stmt, uchar *to, DESC *apd,
                         DESCREC *aprec, DESCREC *iprec, SQLULEN row);
+SQLRETURN convert_c_type2str(STMT *stmt, SQLSMALLINT ctype, DESCREC *iprec,
+                             char **res, long *length, char *buff,
+                             uint buff_max);
 char *    add_to_buffer (NET *net,char *to,const char *from,ulong length);
 
 void reset_getdata_position   (STMT *stmt);
@@ -281,6 +287,13 @@ my_bool myodbc_net_realloc(NET *net, size_t length);
 void myodbc_net_end(NET *net);
 my_bool set_dynamic_result        (STMT *stmt);
 void    set_current_cursor_data   (STMT *stmt,SQLUINTEGER irow);
+my_bool check_if_usable_unique_key_exists(STMT *stmt);
+my_bool keyset_usable             (STMT *stmt);
+SQLRETURN keyset_cursor_info      (STMT *stmt, SQLRETURN rc);
+SQLRETURN keyset_refresh          (STMT *stmt, SQLULEN rows);
+MYSQL_ROW keyset_row              (STMT *stmt, MYSQL_ROW values,
+                                   SQLULEN row, SQLUSMALLINT *status);
+void    keyset_free               (STMT *stmt);
 my_bool is_minimum_version        (const char *server_version,const char *version);
 int     myodbc_strcasecmp         (const char *s, const char *t);
 int     myodbc_casecmp            (const char *s, const char *t, uint len);
@@ -288,6 +301,8 @@ my_bool reget_current_catalog     (DBC *dbc);
 
 ulong   myodbc_escape_string      (MYSQL *mysql, char *to, ulong to_length,
                                   const char *from, ulong length, int escape_id);
+ulong   myodbc_escape_data        (MYSQL *mysql, char *to, const char *from,
+                                  ulong length);
 
 DESCREC*  desc_get_rec            (DESC *desc, int recnum, my_bool expand);
 
@@ -319,11 +334,23 @@ void *ptr_offset_adjust   (void *ptr, SQLULEN *bind_offset,
                           SQLULEN row);
 
 void free_internal_result_buffers(STMT *stmt);
+my_ulonglong myodbc_time_us(void);
+my_ulonglong myodbc_wall_time_us(void);
+void stats_add_execution  (MY_STATS *stats, my_ulonglong usec);
+void stats_add            (MY_STATS *to, const MY_STATS *from);
+void dbc_get_stats        (DBC *dbc, MY_STATS *stats);
+void env_get_stats        (ENV *env, MY_STATS *stats);
 
 /* Functions used when debugging */
-void query_print          (FILE *log_file,char *query);
-FILE *init_query_log      (void);
-void end_query_log        (FILE *query_log);
+void         query_log_init   (void);
+void         query_log_end    (void);
+my_bool      query_log_open   (DataSource *ds);
+void         query_log_close  (void);
+void         query_log_print  (DBC *dbc, STMT *stmt, const char *text);
+void         query_log_start  (STMT *stmt, const char *query, size_t length);
+void         query_log_execute(STMT *stmt, size_t length, my_ulonglong start,
+                               my_ulonglong rows, uint error);
+void         query_log_stats  (DBC *dbc);
 
 LIST *list_delete_forward (LIST *elem);
 
@@ -353,6 +380,8 @@ const char *get_fractional_part   (const char * str, int len,
 /* Convert MySQL timestamp to full ANSI timestamp format. */
 char *          complete_timestamp  (const char * value, ulong length, char buff[21]);
 long double     myodbc_strtold             (const char *nptr, char **endptr);
+size_t          myodbc_d2str        (double value, int precision, char *buff);
+size_t          myodbc_d2str_shortest(double value, BOOL is_float, char *buff);
 char *          extend_buffer       (NET *net, char *to, ulong length);
 char *          add_to_buffer       (NET *net,char *to,const char *from,ulong length);
 MY_LIMIT_CLAUSE find_position4limit (CHARSET_INFO* cs, char *query,
@@ -366,8 +395,6 @@ BOOL            myodbc_isnum        (CHARSET_INFO* cs, const char * begin, const
 
 int           got_out_parameters  (STMT *stmt);
 const char    get_identifier_quote(STMT *stmt);
-SQLULEN get_query_timeout(STMT *stmt);
-SQLRETURN set_query_timeout(STMT *stmt, SQLULEN new_value);
 int get_session_variable(STMT *stmt, const char *var, char *result);
 
 /* handle.c*/
@@ -405,6 +432,7 @@ my_ulonglong      affected_rows       (STMT *stmt);
 my_ulonglong      update_affected_rows(STMT *stmt);
 my_ulonglong      num_rows            (STMT *stmt);
 MYSQL_ROW         fetch_row           (STMT *stmt);
+MYSQL_ROW         fetch_row_nolock    (STMT *stmt);
 unsigned long*    fetch_lengths       (STMT *stmt);
 MYSQL_ROW_OFFSET  row_seek            (STMT *stmt, MYSQL_ROW_OFFSET offset);
 void              data_seek           (STMT *stmt, my_ulonglong offset);
@@ -434,16 +462,31 @@ void          scroller_create     (STMT * stmt, char *query, SQLULEN len);
 unsigned long long  scroller_move (STMT * stmt);
 
 SQLRETURN     scroller_prefetch   (STMT * stmt);
+void          scroller_start_async(STMT * stmt);
 BOOL          scrollable          (STMT * stmt, char * query, char * query_end);
 
+/* catalog.c */
+void        catalog_cache_free    (DBC *dbc);
+
 /* my_prepared_stmt.c */
 void        ssps_init             (STMT *stmt);
 BOOL        ssps_get_out_params   (STMT *stmt);
 int         ssps_get_result       (STMT *stmt);
+void        ssps_set_cursor_type  (STMT *stmt);
 void        ssps_close            (STMT *stmt);
+BOOL        ssps_cache_get        (STMT *stmt, const char *query,
+                                  size_t query_length);
+MY_SSPS_CACHE_ENTRY *ssps_cache_take(DBC *dbc, const char *query,
+                                     size_t query_length);
+BOOL        ssps_cache_return     (DBC *dbc, MY_SSPS_CACHE_ENTRY *entry,
+                                  MYSQL_STMT *ssps);
+void        ssps_cache_free       (DBC *dbc);
 SQLRETURN   ssps_fetch_chunk      (STMT *stmt, char *dest, unsigned long dest_bytes,
                                   unsigned long *avail_bytes);
 int         ssps_bind_result      (STMT *stmt);
+BOOL        ssps_direct_fetch_type(MYSQL_FIELD *field, SQLSMALLINT c_type);
+int         ssps_bind_direct      (STMT *stmt);
+void        ssps_copy_direct      (STMT *stmt);
 void        free_result_bind      (STMT *stmt);
 BOOL        ssps_0buffers_truncated_only(STMT *stmt);
 long long   ssps_get_int64        (STMT *stmt, ulong column_number, char *value,
@@ -458,6 +501,32 @@ MYSQL_BIND * get_param_bind       (STMT *stmt, unsigned int param_number, int re
 
 /* connect.c */
 void free_connection_stmts(DBC *dbc);
+SQLRETURN my_SQLDisconnect(DBC *dbc);
+unsigned int myodbc_connect_internal(DBC *dbc, MYSQL *mysql);
+void env_monitor_stop(ENV *env);
+unsigned int env_cancel_query(DBC *dbc, unsigned long thread_id);
+void env_cancel_free(ENV *env);
+my_bool query_timer_start(DBC *dbc, SQLULEN timeout);
+my_bool query_timer_stop(DBC *dbc);
+void env_timer_stop(ENV *env);
+
+/* async.c */
+#define ASYNC_ENABLED(S) ((S)->stmt_options.async_enable == SQL_ASYNC_ENABLE_ON)
+/* Fetches from a stored result do not wait for the server, they are not
+   worth a trip to a worker */
+#define ASYNC_FETCH(S) (ASYNC_ENABLED(S) && \
+                        (if_forward_cache(S) || if_dynamic_cursor(S) || \
+                         scroller_exists(S)))
+my_bool   async_poll  (STMT *stmt, SQLUSMALLINT function, SQLRETURN *rc);
+SQLRETURN async_start (STMT *stmt, SQLUSMALLINT function,
+                       SQLSMALLINT orientation, SQLLEN offset);
+my_bool   async_cancel(STMT *stmt);
+my_bool   async_canceled(STMT *stmt);
+void      async_wait  (STMT *stmt);
+my_bool   async_dbc_start(DBC *dbc, SQLUSMALLINT function, DataSource *ds);
+my_bool   async_dbc_poll (DBC *dbc, SQLUSMALLINT function, SQLRETURN *rc);
+void      async_dbc_wait (DBC *dbc);
+void      async_stop  (ENV *env);
 
 #ifdef __WIN__
 #define cmp_database(A,B) myodbc_strcasecmp((const char *)(A),(const char *)(B))
@@ -45,8 +45,9 @@ static SQLRETURN set_constmt_attr(SQLSMALLINT  HandleType,
     {
         case SQL_ATTR_ASYNC_ENABLE:
             if (ValuePtr == (SQLPOINTER) SQL_ASYNC_ENABLE_ON)
-                return set_handle_error(HandleType,Handle,MYERR_01S02,
-                                        "Doesn't support asynchronous, changed to default",0);
+                options->async_enable= SQL_ASYNC_ENABLE_ON;
+            else
+                options->async_enable= SQL_ASYNC_ENABLE_OFF;
             break;
 
         case SQL_ATTR_CURSOR_SENSITIVITY:
@@ -107,6 +108,7 @@ static SQLRETURN set_constmt_attr(SQLSMALLINT  HandleType,
             break;
 
         case SQL_ATTR_RETRIEVE_DATA:
+            options->retrieve_data= (SQLULEN)ValuePtr != SQL_RD_OFF;
             break;
 
         case SQL_ATTR_SIMULATE_CURSOR:
@@ -133,11 +135,8 @@ static SQLRETURN set_constmt_attr(SQLSMALLINT  HandleType,
           break;
 
         case SQL_ATTR_QUERY_TIMEOUT:
-            /* Do something only if the handle is STMT */
-            if (HandleType == SQL_HANDLE_STMT)
-            {
-              return set_query_timeout((STMT*)Handle, (SQLULEN)ValuePtr);
-            }
+            /* Kept by the driver, see query_timer_start() */
+            options->query_timeout= (SQLULEN)ValuePtr;
             break;
 
         case SQL_ATTR_KEYSET_SIZE:
@@ -167,7 +166,7 @@ get_constmt_attr(SQLSMALLINT  HandleType,
     switch (Attribute)
     {
         case SQL_ATTR_ASYNC_ENABLE:
-            *((SQLUINTEGER *) ValuePtr)= SQL_ASYNC_ENABLE_OFF;
+            *((SQLUINTEGER *) ValuePtr)= options->async_enable;
             break;
 
         case SQL_ATTR_CURSOR_SENSITIVITY:
@@ -176,6 +175,12 @@ get_constmt_attr(SQLSMALLINT  HandleType,
 
         case SQL_ATTR_CURSOR_TYPE:
             *((SQLUINTEGER *) ValuePtr)= options->cursor_type;
+            /* Dynamic cursor reading its rowset by the unique key */
+            if (HandleType == SQL_HANDLE_STMT &&
+                options->cursor_type == SQL_CURSOR_DYNAMIC &&
+                ((STMT *)Handle)->cursor.keyset_validated &&
+                ((STMT *)Handle)->cursor.keyset_usable)
+                *((SQLUINTEGER *) ValuePtr)= SQL_CURSOR_KEYSET_DRIVEN;
             break;
 
         case SQL_ATTR_MAX_LENGTH:
@@ -191,20 +196,12 @@ get_constmt_attr(SQLSMALLINT  HandleType,
             break;
 
         case SQL_ATTR_QUERY_TIMEOUT:
-            /* Do something only if the handle is STMT */
-            if (HandleType == SQL_HANDLE_STMT)
-            {
-              /* Check if the query timeout was requested before */
-              if (options->query_timeout == (SQLULEN)-1)
-              {
-                options->query_timeout= get_query_timeout((STMT*)Handle);
-              }
-              *((SQLULEN *) ValuePtr)= options->query_timeout;
-            }
+            *((SQLULEN *) ValuePtr)= options->query_timeout;
             break;
 
         case SQL_ATTR_RETRIEVE_DATA:
-            *((SQLUINTEGER *) ValuePtr)= SQL_RD_DEFAULT;
+            *((SQLUINTEGER *) ValuePtr)= options->retrieve_data ? SQL_RD_ON
+                                                                : SQL_RD_OFF;
             break;
 
         case SQL_ATTR_SIMULATE_CURSOR:
@@ -332,7 +329,7 @@ MySQLSetConnectAttr(SQLHDBC hdbc, SQLINTEGER Attribute,
         if (!(db= fix_str((char *)ldb, (char *)ValuePtr, StringLengthPtr)))
           return set_conn_error(hdbc,MYERR_S1009,NULL, 0);
 
-        myodbc_mutex_lock(&dbc->lock);
+        lock_dbc(dbc);
         if (is_connected(dbc))
         {
           if (mysql_select_db(&dbc->mysql,(char*) db))
@@ -341,6 +338,7 @@ MySQLSetConnectAttr(SQLHDBC hdbc, SQLINTEGER Attribute,
             myodbc_mutex_unlock(&dbc->lock);
             return SQL_ERROR;
           }
+          ssps_cache_free(dbc);
         }
         x_free(dbc->database);
         dbc->database= myodbc_strdup(db,MYF(MY_WME));
@@ -426,6 +424,22 @@ MySQLSetConnectAttr(SQLHDBC hdbc, SQLINTEGER Attribute,
       return set_dbc_error(dbc, "HYC00",
                            "Optional feature not supported", 0);
 
+    case SQL_ATTR_ASYNC_DBC_FUNCTIONS_ENABLE:
+      dbc->async_enable= ValuePtr == (SQLPOINTER)SQL_ASYNC_DBC_ENABLE_ON;
+      break;
+
+    case SQL_ATTR_ASYNC_DBC_EVENT:
+      dbc->async.event= ValuePtr;
+      break;
+
+    case SQL_ATTR_ASYNC_DBC_PCALLBACK:
+      dbc->async.callback= (MY_ASYNC_CALLBACK)ValuePtr;
+      break;
+
+    case SQL_ATTR_ASYNC_DBC_PCONTEXT:
+      dbc->async.context= ValuePtr;
+      break;
+
       /*
         3.x driver doesn't support any statement attributes
         at connection level, but to make sure all 2.x apps
@@ -579,7 +593,77 @@ MySQLGetConnectAttr(SQLHDBC hdbc, SQLINTEGER attrib, SQLCHAR **char_attr,
     *((SQLINTEGER *)num_attr)= dbc->txn_isolation;
     break;
 
+  case SQL_ATTR_ASYNC_DBC_FUNCTIONS_ENABLE:
+    *((SQLUINTEGER *)num_attr)= dbc->async_enable ? SQL_ASYNC_DBC_ENABLE_ON :
+                                                   SQL_ASYNC_DBC_ENABLE_OFF;
+    break;
+
+  case SQL_ATTR_ASYNC_DBC_EVENT:
+    *((SQLPOINTER *)num_attr)= dbc->async.event;
+    break;
+
+  case SQL_ATTR_MYODBC_WAKEUPS:
+  case SQL_ATTR_MYODBC_WAKEUPS_REAUTH:
+    myodbc_mutex_lock(&dbc->env->lock);
+    *((SQLULEN *)num_attr)= attrib == SQL_ATTR_MYODBC_WAKEUPS ?
+                            dbc->env->wakeup_count :
+                            dbc->env->wakeup_reauth_count;
+    myodbc_mutex_unlock(&dbc->env->lock);
+    break;
+
+  case SQL_ATTR_MYODBC_STMT_CACHE_HITS:
+  case SQL_ATTR_MYODBC_STMT_CACHE_MISSES:
+  case SQL_ATTR_MYODBC_STMT_CACHE_EVICTIONS:
+    myodbc_mutex_lock(&dbc->stmt_cache_lock);
+    *((SQLULEN *)num_attr)= attrib == SQL_ATTR_MYODBC_STMT_CACHE_HITS ?
+                            dbc->stmt_cache_hits :
+                            attrib == SQL_ATTR_MYODBC_STMT_CACHE_MISSES ?
+                            dbc->stmt_cache_misses :
+                            dbc->stmt_cache_evictions;
+    myodbc_mutex_unlock(&dbc->stmt_cache_lock);
+    break;
+
+  case SQL_ATTR_MYODBC_LOCK_WAITS:
+    myodbc_mutex_lock(&dbc->lock);
+    *((SQLULEN *)num_attr)= dbc->lock_waits;
+    myodbc_mutex_unlock(&dbc->lock);
+    break;
+
+  case SQL_ATTR_MYODBC_LIVENESS_PINGS:
+    myodbc_mutex_lock(&dbc->lock);
+    *((SQLULEN *)num_attr)= dbc->liveness_pings;
+    myodbc_mutex_unlock(&dbc->lock);
+    break;
+
+  case SQL_ATTR_MYODBC_PARSE_CACHE_HITS:
+  case SQL_ATTR_MYODBC_PARSE_CACHE_MISSES:
+    myodbc_mutex_lock(&dbc->env->parse_cache.lock);
+    *((SQLULEN *)num_attr)= attrib == SQL_ATTR_MYODBC_PARSE_CACHE_HITS ?
+                            dbc->env->parse_cache.hits :
+                            dbc->env->parse_cache.misses;
+    myodbc_mutex_unlock(&dbc->env->parse_cache.lock);
+    break;
+
   default:
+    if (IS_STATS_ATTR(attrib & ~SQL_ATTR_MYODBC_STATS_ENV))
+    {
+      MY_STATS stats;
+
+      if (attrib & SQL_ATTR_MYODBC_STATS_ENV)
+      {
+        env_get_stats(dbc->env, &stats);
+      }
+      else
+      {
+        myodbc_mutex_lock(&dbc->lock);
+        dbc_get_stats(dbc, &stats);
+        myodbc_mutex_unlock(&dbc->lock);
+      }
+
+      *((SQLULEN *)num_attr)= STATS_COUNTER(&stats,
+                                            attrib & ~SQL_ATTR_MYODBC_STATS_ENV);
+      break;
+    }
     return set_handle_error(SQL_HANDLE_DBC, hdbc, MYERR_S1092, NULL, 0);
   }
 
@@ -770,6 +854,18 @@ MySQLSetStmtAttr(SQLHSTMT hstmt, SQLINTEGER Attribute, SQLPOINTER ValuePtr,
             options->simulateCursor= (SQLUINTEGER)(SQLULEN)ValuePtr;
             break;
 
+        case SQL_ATTR_ASYNC_STMT_EVENT:
+            stmt->async.event= ValuePtr;
+            break;
+
+        case SQL_ATTR_ASYNC_STMT_PCALLBACK:
+            stmt->async.callback= (MY_ASYNC_CALLBACK)ValuePtr;
+            break;
+
+        case SQL_ATTR_ASYNC_STMT_PCONTEXT:
+            stmt->async.context= ValuePtr;
+            break;
+
             /*
               3.x driver doesn't support any statement attributes
               at connection level, but to make sure all 2.x apps
@@ -875,6 +971,10 @@ MySQLGetStmtAttr(SQLHSTMT hstmt, SQLINTEGER Attribute, SQLPOINTER ValuePtr,
             *(SQLUINTEGER *)ValuePtr= options->simulateCursor;
             break;
 
+        case SQL_ATTR_ASYNC_STMT_EVENT:
+            *(SQLPOINTER *)ValuePtr= stmt->async.event;
+            break;
+
         case SQL_ATTR_APP_ROW_DESC:
             *(SQLPOINTER *)ValuePtr= stmt->ard;
             *StringLengthPtr= sizeof(SQLPOINTER);
@@ -901,6 +1001,14 @@ MySQLGetStmtAttr(SQLHSTMT hstmt, SQLINTEGER Attribute, SQLPOINTER ValuePtr,
               works fine...lets support it..nothing to lose..
             */
         default:
+            if (IS_STATS_ATTR(Attribute))
+            {
+                /* Cancel counters are updated by SQLCancel */
+                myodbc_mutex_lock(&stmt->dbc->env->cancel_lock);
+                *(SQLULEN *)ValuePtr= STATS_COUNTER(&stmt->stats, Attribute);
+                myodbc_mutex_unlock(&stmt->dbc->env->cancel_lock);
+                break;
+            }
             result= get_constmt_attr(3,hstmt,options,
                                      Attribute,ValuePtr,
                                      StringLengthPtr);
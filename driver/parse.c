@@ -29,6 +29,12 @@
 
 #include "driver.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# include <emmintrin.h>
+# define PARSE_SSE2 1
+#endif
+
 static const MY_QUERY_TYPE query_type[]=
 {
   /*myqtSelect*/      {'\1', '\1', NULL},
@@ -68,6 +74,21 @@ static const MY_STRING current=    {"CURRENT"  , 7, 7};
 static const MY_STRING of=         {"OF"       , 2, 2};
 static const MY_STRING limit=      {"LIMIT"    , 5, 5};
 static const MY_STRING optimize=   {"OPTIMIZE" , 8, 8};
+static const MY_STRING replace=    {"REPLACE"  , 7, 7};
+static const MY_STRING delete_=    {"DELETE"   , 6, 6};
+static const MY_STRING values=     {"VALUES"   , 6, 6};
+static const MY_STRING value=      {"VALUE"    , 5, 5};
+static const MY_STRING from=       {"FROM"     , 4, 4};
+static const MY_STRING order=      {"ORDER"    , 5, 5};
+static const MY_STRING by=         {"BY"       , 2, 2};
+static const MY_STRING group=      {"GROUP"    , 5, 5};
+static const MY_STRING having=     {"HAVING"   , 6, 6};
+static const MY_STRING union_=     {"UNION"    , 5, 5};
+static const MY_STRING join=       {"JOIN"     , 4, 4};
+static const MY_STRING asc=        {"ASC"      , 3, 3};
+static const MY_STRING desc=       {"DESC"     , 4, 4};
+static const MY_STRING alter=      {"ALTER"    , 5, 5};
+static const MY_STRING rename=     {"RENAME"   , 6, 6};
 
 static const MY_SYNTAX_MARKERS ansi_syntax_markers= {/*quote*/
                                               {
@@ -511,6 +532,357 @@ BOOL is_call_procedure(const MY_PARSED_QUERY * query)
 }
 
 
+/* INSERT, REPLACE, UPDATE or DELETE */
+BOOL is_dml_statement(MY_PARSED_QUERY *query)
+{
+  char *token;
+
+  if (query->query_type == myqtInsert || query->query_type == myqtUpdate)
+  {
+    return TRUE;
+  }
+
+  token= get_token(query, 0);
+
+  return token != NULL && (case_compare(query, token, &replace)
+                        || case_compare(query, token, &delete_));
+}
+
+
+/*
+  CREATE, ALTER, DROP or RENAME, or USE changing the default database.
+  Only the first statement of a batch is classified, so a batch is assumed
+  to be one of them.
+*/
+BOOL changes_metadata(MY_PARSED_QUERY *query)
+{
+  char *token;
+
+  if (query->query_type == myqtCreateTable || query->query_type == myqtUse
+    || IS_BATCH(query))
+  {
+    return TRUE;
+  }
+
+  token= get_token(query, 0);
+
+  return token != NULL && (case_compare(query, token, &create)
+                        || case_compare(query, token, &alter)
+                        || case_compare(query, token, &drop)
+                        || case_compare(query, token, &rename));
+}
+
+
+/*
+  Finds the row constructor of INSERT/REPLACE ... VALUES(...) statement, i.e.
+  parenthesized list following VALUES keyword. Returns pointer to the opening
+  parenthesis and sets row_end to the character next after the closing one.
+  Returns NULL if the statement is not INSERT/REPLACE with exactly one row
+  constructor, or if any parameter marker is outside of it.
+*/
+char * get_values_row(MY_PARSED_QUERY *query, char **row_end)
+{
+  MY_PARSER parser;
+  char *token, *row= NULL;
+  uint i;
+  int depth= 0;
+
+  token= get_token(query, 0);
+
+  if (token == NULL || IS_BATCH(query)
+    || !(query->query_type == myqtInsert
+         || case_compare(query, token, &replace)))
+  {
+    return NULL;
+  }
+
+  for (i= 1; i < TOKEN_COUNT(query) && row == NULL; ++i)
+  {
+    token= get_token(query, i);
+
+    if (case_compare(query, token, &values))
+    {
+      row= token + values.bytes;
+    }
+    else if (case_compare(query, token, &value))
+    {
+      row= token + value.bytes;
+    }
+    else
+    {
+      continue;
+    }
+
+    init_parser(&parser, query);
+    parser.pos= row;
+    get_ctype(&parser);
+
+    /* Not a keyword, but something like VALUES_COLUMN */
+    if (END_NOT_REACHED(&parser) && !IS_SPACE(&parser)
+      && !(parser.bytes_at_pos == 1 && *parser.pos == '('))
+    {
+      row= NULL;
+    }
+  }
+
+  if (row == NULL || skip_spaces(&parser)
+    || parser.bytes_at_pos != 1 || *parser.pos != '(')
+  {
+    return NULL;
+  }
+
+  row= parser.pos;
+  *row_end= NULL;
+
+  while (END_NOT_REACHED(&parser))
+  {
+    if (parser.quote)
+    {
+      find_closing_quote(&parser);
+      CLOSE_QUOTE(&parser);
+      continue;
+    }
+
+    if (!open_quote(&parser, is_quote(&parser)) && parser.bytes_at_pos == 1)
+    {
+      if (*parser.pos == '(')
+      {
+        ++depth;
+      }
+      else if (*parser.pos == ')' && --depth == 0)
+      {
+        step_char(&parser);
+        *row_end= parser.pos;
+        break;
+      }
+    }
+
+    step_char(&parser);
+  }
+
+  if (*row_end == NULL
+    || (PARAM_COUNT(query) > 0
+        && (get_param_pos(query, 0) < row
+            || get_param_pos(query, PARAM_COUNT(query) - 1) >= *row_end)))
+  {
+    return NULL;
+  }
+
+  /* Already multi-row insert */
+  if (!skip_spaces(&parser) && parser.bytes_at_pos == 1 && *parser.pos == ',')
+  {
+    return NULL;
+  }
+
+  return row;
+}
+
+
+/* Identifier character, multibyte ones are always treated as such */
+static BOOL is_ident_char(MY_PARSER *parser)
+{
+  return parser->bytes_at_pos > 1
+      || (parser->bytes_at_pos == 1 && (isalnum((uchar)*parser->pos)
+                                        || *parser->pos == '_'
+                                        || *parser->pos == '$'));
+}
+
+
+/* Token is the keyword, and not just starts with it */
+static BOOL is_keyword(MY_PARSED_QUERY *query, const char *token,
+                       const MY_STRING *keyword)
+{
+  const char *after= token + keyword->bytes;
+
+  return case_compare(query, token, keyword)
+      && (after >= query->query_end
+          || !(isalnum((uchar)*after) || *after == '_' || *after == '$'));
+}
+
+
+/*
+  Reads ORDER BY list item: column name, possibly quoted with backticks
+  and/or qualified with the table name, and optional ASC/DESC.
+  Returns TRUE if the item is anything else.
+*/
+static BOOL get_order_by_item(MY_PARSER *parser, MY_ORDER_BY_COLUMN *column)
+{
+  do
+  {
+    if (parser->bytes_at_pos == 1 && *parser->pos == '`')
+    {
+      step_char(parser);
+      column->name= parser->pos;
+      open_quote(parser, &parser->syntax->quote[2]);
+
+      if (find_closing_quote(parser) == NULL)
+      {
+        return TRUE;
+      }
+      CLOSE_QUOTE(parser);
+      column->name_len= (uint)(parser->pos - 1 - column->name);
+    }
+    else
+    {
+      column->name= parser->pos;
+
+      while (END_NOT_REACHED(parser) && is_ident_char(parser))
+      {
+        step_char(parser);
+      }
+      column->name_len= (uint)(parser->pos - column->name);
+    }
+
+    if (column->name_len == 0)
+    {
+      return TRUE;
+    }
+
+    /* Qualified name - what we've read so far was not a column name */
+    if (!END_NOT_REACHED(parser) || *parser->pos != '.')
+    {
+      break;
+    }
+    step_char(parser);
+  } while (END_NOT_REACHED(parser));
+
+  column->desc= FALSE;
+
+  if (skip_spaces(parser))
+  {
+    return FALSE;
+  }
+
+  if (is_keyword(parser->query, parser->pos, &desc))
+  {
+    column->desc= TRUE;
+    parser->pos+= desc.bytes;
+  }
+  else if (is_keyword(parser->query, parser->pos, &asc))
+  {
+    parser->pos+= asc.bytes;
+  }
+  else
+  {
+    return FALSE;
+  }
+
+  if (END_NOT_REACHED(parser))
+  {
+    get_ctype(parser);
+    skip_spaces(parser);
+  }
+
+  return FALSE;
+}
+
+
+/*
+  Checks if the query is a SELECT from a single table, without grouping,
+  unions or subqueries, that ends with ORDER BY on plain column names. Query
+  end is supposed to be at its LIMIT clause, if there is one.
+  That is what is needed to page through the result by values of ORDER BY
+  columns. Types of the columns are not known here, columns that can't be
+  compared by value(FLOAT, DOUBLE, BIT, ENUM, SET) are rejected once the
+  result metadata is there.
+
+  Returns the number of ORDER BY columns put to columns, or 0 if the query
+  does not fit. where is set to the position right after WHERE keyword, or
+  to NULL if there is none, and order to the ORDER keyword.
+*/
+uint get_order_by_columns(MY_PARSED_QUERY *query, MY_ORDER_BY_COLUMN *columns,
+                          uint max_columns, char **where, char **order)
+{
+  MY_PARSER parser;
+  char *token, *next, *from_pos= NULL;
+  uint i, count= 0, table_tokens= 0;
+
+  *where= *order= NULL;
+
+  if (query->query_type != myqtSelect || IS_BATCH(query))
+  {
+    return 0;
+  }
+
+  for (i= 1; i < TOKEN_COUNT(query) && *order == NULL; ++i)
+  {
+    token= get_token(query, i);
+
+    while (*token == '(' && token < query->query_end)
+    {
+      ++token;
+    }
+
+    if (is_keyword(query, token, &select_) || is_keyword(query, token, &union_)
+      || is_keyword(query, token, &group) || is_keyword(query, token, &having)
+      || is_keyword(query, token, &join))
+    {
+      return 0;
+    }
+
+    if (from_pos == NULL)
+    {
+      if (is_keyword(query, token, &from))
+      {
+        from_pos= token;
+      }
+    }
+    else if (*where == NULL && is_keyword(query, token, &where_))
+    {
+      *where= token + where_.bytes;
+    }
+    else if (is_keyword(query, token, &order) && i + 1 < TOKEN_COUNT(query)
+          && is_keyword(query, get_token(query, i + 1), &by))
+    {
+      *order= token;
+    }
+    else if (*where == NULL)
+    {
+      /* Table name with optional alias */
+      next= i + 1 < TOKEN_COUNT(query) ? get_token(query, i + 1)
+                                       : query->query_end;
+
+      if (++table_tokens > 3 || memchr(token, ',', next - token)
+        || memchr(token, '(', next - token) || memchr(token, ')', next - token))
+      {
+        return 0;
+      }
+    }
+  }
+
+  if (*order == NULL || table_tokens == 0)
+  {
+    return 0;
+  }
+
+  init_parser(&parser, query);
+  parser.pos= get_token(query, i) + by.bytes;
+  get_ctype(&parser);
+
+  while (!skip_spaces(&parser))
+  {
+    if (count == max_columns || get_order_by_item(&parser, columns + count))
+    {
+      return 0;
+    }
+    ++count;
+
+    if (!END_NOT_REACHED(&parser))
+    {
+      break;
+    }
+
+    if (parser.bytes_at_pos != 1 || *parser.pos != ',')
+    {
+      return 0;
+    }
+    step_char(&parser);
+  }
+
+  return count;
+}
+
+
 /*!
     \brief  Returns true if we are dealing with a statement which
             is likely to result in reading only (SELECT || SHOW).
@@ -736,11 +1108,126 @@ BOOL is_query_separator(MY_PARSER *parser)
 }
 
 
+/*
+  Bytes tokenize() has to look at outside of quotes: spaces, quotes, "?",
+  starts of comments and of query separators, and bytes of multibyte
+  characters. Others only move last_char.
+*/
+static const char tokenizer_special[256]=
+{
+  0,0,0,0,0,0,0,0,0,1,1,1,1,1,0,0, /* 00-0F: \t \n \v \f \r */
+  0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* 10-1F */
+  1,0,1,1,0,0,0,1,0,0,0,0,0,1,0,1, /* 20-2F: space " # ' - / */
+  0,0,0,0,0,0,0,0,0,0,0,1,0,0,0,1, /* 30-3F: ; ? */
+  0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* 40-4F */
+  0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,0, /* 50-5F: \ */
+  1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* 60-6F: ` */
+  0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* 70-7F */
+  1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1, /* 80-FF */
+  1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,
+  1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,
+  1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,
+  1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,
+  1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,
+  1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,
+  1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1
+};
+
+
+/*
+  Returns the first byte from pos on that is special for the tokenizer, or
+  end. With SSE2 16 bytes are checked at a time.
+*/
+static const char *skip_plain_bytes(const char *pos, const char *end)
+{
+#ifdef PARSE_SSE2
+  const __m128i space_from= _mm_set1_epi8(0x08), space_to= _mm_set1_epi8(0x0E);
+  const __m128i space= _mm_set1_epi8(' '), dquote= _mm_set1_epi8('"');
+  const __m128i hash= _mm_set1_epi8('#'), squote= _mm_set1_epi8('\'');
+  const __m128i dash= _mm_set1_epi8('-'), slash= _mm_set1_epi8('/');
+  const __m128i semicolon= _mm_set1_epi8(';'), question= _mm_set1_epi8('?');
+  const __m128i backslash= _mm_set1_epi8('\\'), backtick= _mm_set1_epi8('`');
+
+  while (end - pos >= 16)
+  {
+    __m128i bytes= _mm_loadu_si128((const __m128i *)pos);
+    /* Signed comparisons, bytes >= 0x80 are caught by movemask anyway */
+    __m128i special= _mm_and_si128(_mm_cmpgt_epi8(bytes, space_from),
+                                   _mm_cmplt_epi8(bytes, space_to));
+    int mask;
+
+    special= _mm_or_si128(special, _mm_cmpeq_epi8(bytes, space));
+    special= _mm_or_si128(special, _mm_cmpeq_epi8(bytes, dquote));
+    special= _mm_or_si128(special, _mm_cmpeq_epi8(bytes, hash));
+    special= _mm_or_si128(special, _mm_cmpeq_epi8(bytes, squote));
+    special= _mm_or_si128(special, _mm_cmpeq_epi8(bytes, dash));
+    special= _mm_or_si128(special, _mm_cmpeq_epi8(bytes, slash));
+    special= _mm_or_si128(special, _mm_cmpeq_epi8(bytes, semicolon));
+    special= _mm_or_si128(special, _mm_cmpeq_epi8(bytes, question));
+    special= _mm_or_si128(special, _mm_cmpeq_epi8(bytes, backslash));
+    special= _mm_or_si128(special, _mm_cmpeq_epi8(bytes, backtick));
+
+    mask= _mm_movemask_epi8(_mm_or_si128(special, bytes));
+    if (mask)
+    {
+      int i= 0;
+      while (!(mask & (1 << i)))
+      {
+        ++i;
+      }
+      return pos + i;
+    }
+
+    pos+= 16;
+  }
+#endif
+
+  while (pos < end && !tokenizer_special[(uchar)*pos])
+  {
+    ++pos;
+  }
+
+  return pos;
+}
+
+
+/*
+  TRUE if only spaces and comments are left from the parser's position on.
+  The parser itself is not moved.
+*/
+static BOOL only_comments_left(MY_PARSER *parser)
+{
+  MY_PARSER rest= *parser;
+  uint i;
+
+  while (!skip_spaces(&rest))
+  {
+    if (!is_comment(&rest))
+    {
+      return FALSE;
+    }
+
+    /* skip_comment stops at the closing sequence of a C style comment */
+    if (!skip_comment(&rest) && rest.c_style_comment)
+    {
+      for (i= 0; i < rest.syntax->c_style_close_comment.chars; ++i)
+      {
+        step_char(&rest);
+      }
+    }
+  }
+
+  return TRUE;
+}
+
+
 /* Perhaps it can be just int(failed/succeeded) */
 BOOL tokenize(MY_PARSER *parser)
 {
   /* TODO: token info should contain length of a token */
-  
+  /* Bytes below 0x80 are whole characters in such charsets */
+  BOOL ascii_compatible= parser->query->cs->mbminlen == 1;
+
   skip_spaces(parser);
   /* 1st token - otherwise we lose it if it is on 0 position without spaces
      ahead of it */
@@ -763,6 +1250,20 @@ BOOL tokenize(MY_PARSER *parser)
     }
     else
     {
+      if (ascii_compatible)
+      {
+        /* Skipping at once what would be stepped over char by char below */
+        char *special= (char *)skip_plain_bytes(parser->pos,
+                                                parser->query->query_end);
+        if (special > parser->pos)
+        {
+          parser->query->last_char= special - 1;
+          parser->pos= special;
+          get_ctype(parser);
+          continue;
+        }
+      }
+
       if (IS_SPACE(parser))
       {
         step_char(parser);
@@ -784,6 +1285,13 @@ BOOL tokenize(MY_PARSER *parser)
       {
         skip_spaces(parser);
 
+        /* Trailing separator does not make the query a batch, neither do
+           comments after it */
+        if (parser->query->is_batch == NULL && !only_comments_left(parser))
+        {
+          parser->query->is_batch= parser->pos;
+        }
+
         if (add_token(parser))
         {
           return TRUE;
@@ -920,6 +1428,197 @@ BOOL parse(MY_PARSED_QUERY *pq)
 }
 
 
+/* FNV-1a of the query text and its charset */
+static ulong parse_cache_hash(const char *query, uint length, uint cs_number)
+{
+  ulong hash= 2166136261UL ^ cs_number;
+  const char *end= query + length;
+
+  while (query < end)
+  {
+    hash= ((hash ^ (uchar)*query++) * 16777619UL) & 0xFFFFFFFFUL;
+  }
+
+  return hash;
+}
+
+
+static void free_parse_cache_entry(MY_PARSE_CACHE_ENTRY *entry)
+{
+  if (entry)
+  {
+    x_free(entry->query);
+    x_free(entry);
+  }
+}
+
+
+/*
+  Makes the cache entry of a parsed query. orig is the query before
+  parse(), the entry takes it over.
+*/
+static MY_PARSE_CACHE_ENTRY *
+new_parse_cache_entry(MY_PARSED_QUERY *pq, char *orig, uint cs_number,
+                      ulong hash)
+{
+  MY_PARSE_CACHE_ENTRY *entry;
+  uint length= (uint)GET_QUERY_LENGTH(pq), i;
+
+  entry= (MY_PARSE_CACHE_ENTRY *)myodbc_malloc(sizeof(MY_PARSE_CACHE_ENTRY) +
+                                               sizeof(uint) *
+                                               (TOKEN_COUNT(pq) +
+                                                PARAM_COUNT(pq)),
+                                               MYF(0));
+  if (!entry)
+  {
+    x_free(orig);
+    return NULL;
+  }
+
+  entry->query=       orig;
+  entry->length=      length;
+  entry->cs_number=   cs_number;
+  entry->hash=        hash;
+  entry->query_type=  pq->query_type;
+  entry->last_char=   pq->last_char ? (int)(pq->last_char - pq->query) : -1;
+  entry->is_batch=    pq->is_batch ? (int)(pq->is_batch - pq->query) : -1;
+  entry->token_count= TOKEN_COUNT(pq);
+  entry->param_count= PARAM_COUNT(pq);
+  entry->offsets=     (uint *)(entry + 1);
+
+  memcpy(entry->offsets, pq->token.buffer, sizeof(uint) * entry->token_count);
+  memcpy(entry->offsets + entry->token_count, pq->param_pos.buffer,
+         sizeof(uint) * entry->param_count);
+
+  /* remove_braces() is the only change parse() makes to the query */
+  entry->brace_open= entry->brace_close= -1;
+  for (i= 0; i < length && orig[i] == pq->query[i]; ++i);
+  if (i < length)
+  {
+    entry->brace_open= i;
+    for (i= length - 1; orig[i] == pq->query[i]; --i);
+    entry->brace_close= i;
+  }
+
+  return entry;
+}
+
+
+/* Fills the parsed query from the cache entry of the same query text */
+static BOOL apply_parse_cache_entry(MY_PARSE_CACHE_ENTRY *entry,
+                                    MY_PARSED_QUERY *pq)
+{
+  if (myodbc_allocate_dynamic(&pq->token, entry->token_count) ||
+      myodbc_allocate_dynamic(&pq->param_pos, entry->param_count))
+  {
+    return TRUE;
+  }
+
+  memcpy(pq->token.buffer, entry->offsets, sizeof(uint) * entry->token_count);
+  pq->token.elements= entry->token_count;
+  memcpy(pq->param_pos.buffer, entry->offsets + entry->token_count,
+         sizeof(uint) * entry->param_count);
+  pq->param_pos.elements= entry->param_count;
+
+  if (entry->brace_open >= 0)
+  {
+    pq->query[entry->brace_open]= ' ';
+    pq->query[entry->brace_close]= ' ';
+  }
+
+  pq->query_type= entry->query_type;
+  pq->last_char=  entry->last_char >= 0 ? pq->query + entry->last_char : NULL;
+  pq->is_batch=   entry->is_batch >= 0 ? pq->query + entry->is_batch : NULL;
+
+  return FALSE;
+}
+
+
+void init_parse_cache(MY_PARSE_CACHE *cache)
+{
+  memset(cache->entry, 0, sizeof(cache->entry));
+  cache->hits= cache->misses= 0;
+  myodbc_mutex_init(&cache->lock, NULL);
+}
+
+
+void free_parse_cache(MY_PARSE_CACHE *cache)
+{
+  uint i;
+
+  for (i= 0; i < PARSE_CACHE_SIZE; ++i)
+  {
+    free_parse_cache_entry(cache->entry[i]);
+    cache->entry[i]= NULL;
+  }
+
+  myodbc_mutex_destroy(&cache->lock);
+}
+
+
+/*
+  Same as parse(), but the result for the same query text and charset is
+  taken from the cache, which has a slot per hash value. Applications
+  executing the same queries over and over don't tokenize them again.
+*/
+BOOL parse_cached(MY_PARSED_QUERY *pq, MY_PARSE_CACHE *cache)
+{
+  uint length= (uint)GET_QUERY_LENGTH(pq);
+  uint cs_number= pq->cs ? pq->cs->number : 0;
+  MY_PARSE_CACHE_ENTRY *entry, **slot;
+  ulong hash;
+  char *orig;
+
+  if (length > PARSE_CACHE_MAX_QUERY)
+  {
+    return parse(pq);
+  }
+
+  hash= parse_cache_hash(GET_QUERY(pq), length, cs_number);
+  slot= &cache->entry[hash % PARSE_CACHE_SIZE];
+
+  myodbc_mutex_lock(&cache->lock);
+  entry= *slot;
+  if (entry && entry->hash == hash && entry->length == length
+    && entry->cs_number == cs_number
+    && !memcmp(entry->query, GET_QUERY(pq), length))
+  {
+    BOOL error= apply_parse_cache_entry(entry, pq);
+    ++cache->hits;
+    myodbc_mutex_unlock(&cache->lock);
+    return error;
+  }
+  ++cache->misses;
+  myodbc_mutex_unlock(&cache->lock);
+
+  /* The text has to be kept before parse() removes braces from it */
+  if (!(orig= myodbc_memdup(GET_QUERY(pq), length, MYF(0))))
+  {
+    return parse(pq);
+  }
+
+  if (parse(pq))
+  {
+    x_free(orig);
+    return TRUE;
+  }
+
+  if ((entry= new_parse_cache_entry(pq, orig, cs_number, hash)))
+  {
+    MY_PARSE_CACHE_ENTRY *old;
+
+    myodbc_mutex_lock(&cache->lock);
+    old= *slot;
+    *slot= entry;
+    myodbc_mutex_unlock(&cache->lock);
+
+    free_parse_cache_entry(old);
+  }
+
+  return FALSE;
+}
+
+
 /* Removes qurly braces off embraced query. Query has to be parsed
    Returns TRUE if braces were removed */
 BOOL remove_braces(MY_PARSER *parser)
@@ -128,6 +128,47 @@ typedef struct parsed_query
 } MY_PARSED_QUERY;
 
 
+/* Slots of the parse cache of the environment */
+#define PARSE_CACHE_SIZE      256
+/* Longer queries are parsed every time */
+#define PARSE_CACHE_MAX_QUERY 4096
+
+/*
+  Result of parse() for a query text, see parse_cached(). Offsets are
+  relative to the beginning of the query, -1 when not set.
+*/
+typedef struct parse_cache_entry
+{
+  char            *query;       /* Query as it was before parsing */
+  uint            length;
+  uint            cs_number;
+  ulong           hash;
+  QUERY_TYPE_ENUM query_type;
+  int             last_char;
+  int             is_batch;
+  int             brace_open;   /* Braces replaced by spaces */
+  int             brace_close;
+  uint            token_count;
+  uint            param_count;
+  uint            *offsets;     /* Tokens followed by parameters */
+} MY_PARSE_CACHE_ENTRY;
+
+typedef struct parse_cache
+{
+  MY_PARSE_CACHE_ENTRY *entry[PARSE_CACHE_SIZE];
+  ulong                hits, misses;  /* SQL_ATTR_MYODBC_PARSE_CACHE_* */
+  myodbc_mutex_t       lock;
+} MY_PARSE_CACHE;
+
+
+typedef struct order_by_column
+{
+  const char *name;   /* Points into the query, not null-terminated */
+  uint        name_len;
+  BOOL        desc;
+} MY_ORDER_BY_COLUMN;
+
+
 typedef struct parser
 {
   char              *pos;
@@ -195,6 +236,9 @@ BOOL              case_compare(MY_PARSED_QUERY *parser, const char *pos,
                                const MY_STRING *str);
 
 BOOL              parse(MY_PARSED_QUERY *pq);
+BOOL              parse_cached(MY_PARSED_QUERY *pq, MY_PARSE_CACHE *cache);
+void              init_parse_cache(MY_PARSE_CACHE *cache);
+void              free_parse_cache(MY_PARSE_CACHE *cache);
 
 
 const char *mystr_get_prev_token(CHARSET_INFO *charset,
@@ -216,6 +260,13 @@ BOOL        is_create_function      (const SQLCHAR * query);
 BOOL        is_use_db               (const SQLCHAR * query);
 BOOL        is_call_procedure       (const MY_PARSED_QUERY *query);
 BOOL        stmt_returns_result     (const MY_PARSED_QUERY *query);
+BOOL        is_dml_statement        (MY_PARSED_QUERY *query);
+BOOL        changes_metadata        (MY_PARSED_QUERY *query);
+char *      get_values_row          (MY_PARSED_QUERY *query, char **row_end);
+uint        get_order_by_columns    (MY_PARSED_QUERY *query,
+                                     MY_ORDER_BY_COLUMN *columns,
+                                     uint max_columns, char **where,
+                                     char **order);
 
 BOOL        remove_braces           (MY_PARSER *query);
 
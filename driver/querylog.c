@@ -0,0 +1,607 @@
+/*
+  Copyright (c) 2018-Present MongoDB Inc.
+
+  The MySQL Connector/ODBC is licensed under the terms of the GPLv2
+  <http://www.gnu.org/licenses/old-licenses/gpl-2.0.html>, like most
+  MySQL Connectors. There are special exceptions to the terms and
+  conditions of the GPLv2 as it is applied to this software, see the
+  FLOSS License Exception
+  <http://www.mysql.com/about/legal/licensing/foss-exception.html>.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; version 2 of the License.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+  for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+*/
+
+/**
+  @file  querylog.c
+  @brief Query log (LOG_QUERY option).
+
+  Events are written as JSON lines to DRIVER_QUERY_LOGFILE. Connections
+  format them into slots of a ring shared by the process and go on; a
+  writer thread started with the first connection that logs writes them to
+  the file. Slots are reserved with compare-and-swap, nothing waits for the
+  file. If the ring is full, events are dropped and the writer records how
+  many.
+*/
+
+#include "driver.h"
+
+#define QUERY_LOG_SLOTS     1024  /* power of 2 */
+#define QUERY_LOG_RECORD    1024  /* longer texts are truncated */
+#define QUERY_LOG_WAIT_MS   100   /* writer's sleep when the ring is empty */
+
+#ifdef _WIN32
+typedef volatile LONG log_counter_t;
+# define counter_get(A)       InterlockedCompareExchange((A), 0, 0)
+# define counter_set(A,B)     InterlockedExchange((A), (B))
+# define counter_add(A,B)     InterlockedExchangeAdd((A), (B))
+# define counter_cas(A,B,C)   (InterlockedCompareExchange((A), (C), (B)) == (B))
+#else
+typedef volatile long log_counter_t;
+# define counter_get(A)       __sync_fetch_and_add((A), 0)
+# define counter_set(A,B)     { __sync_synchronize(); *(A)= (B); }
+# define counter_add(A,B)     __sync_fetch_and_add((A), (B))
+# define counter_cas(A,B,C)   __sync_bool_compare_and_swap((A), (B), (C))
+#endif
+
+/* Difference of sequence numbers that may have wrapped around */
+#define SEQ_DIFF(A,B) ((long)((unsigned long)(A) - (unsigned long)(B)))
+
+
+typedef struct
+{
+  /*
+    Equals the position of the slot in the ring when it is free for the
+    producer at that position, and the position + 1 when the record has
+    been written to it
+  */
+  log_counter_t sequence;
+  uint          length;
+  char          record[QUERY_LOG_RECORD];
+} QUERY_LOG_SLOT;
+
+
+static struct
+{
+  myodbc_mutex_t  lock;     /* Protects opening and closing */
+  myodbc_cond_t   cond;     /* Wakes up the writer to stop */
+  myodbc_thread_t writer;
+  uint            users;    /* Connections that have opened the log */
+  my_bool         stop;
+  FILE            *file;
+  char            filename[FN_REFLEN];
+  my_ulonglong    size, max_size;
+
+  QUERY_LOG_SLOT  *slots;
+  log_counter_t   head;     /* Next position to be reserved */
+  long            tail;     /* Next position to be written, writer only */
+  log_counter_t   dropped;
+} query_log;
+
+
+/* Writes UTC time in ISO 8601 format with microseconds, 27 chars */
+static void format_time(char *buff, my_ulonglong usec)
+{
+  time_t sec= (time_t)(usec / 1000000);
+  struct tm tm;
+
+#ifdef _WIN32
+  gmtime_s(&tm, &sec);
+#else
+  gmtime_r(&sec, &tm);
+#endif
+
+  sprintf(buff, "%04d-%02d-%02dT%02d:%02d:%02d.%06uZ", tm.tm_year + 1900,
+          tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec,
+          (uint)(usec % 1000000));
+}
+
+
+/*
+  Copies text into a JSON string, escaping what has to be. Stops before an
+  escape sequence that doesn't fit.
+
+  @return Number of bytes written, *complete is set to FALSE if the text
+          was cut
+*/
+static size_t json_escape(char *to, size_t size, const char *text,
+                          size_t length, my_bool *complete)
+{
+  const char *end= text + length;
+  char *pos= to, *to_end= to + size;
+
+  for (; text < end; ++text)
+  {
+    uchar c= (uchar)*text;
+    char escape[7];
+    size_t n;
+
+    switch (c)
+    {
+    case '"':  n= 2; escape[0]= '\\'; escape[1]= '"'; break;
+    case '\\': n= 2; escape[0]= '\\'; escape[1]= '\\'; break;
+    case '\n': n= 2; escape[0]= '\\'; escape[1]= 'n'; break;
+    case '\r': n= 2; escape[0]= '\\'; escape[1]= 'r'; break;
+    case '\t': n= 2; escape[0]= '\\'; escape[1]= 't'; break;
+    default:
+      if (c < 0x20)
+      {
+        n= 6;
+        sprintf(escape, "\\u%04x", c);
+      }
+      else
+      {
+        n= 1;
+        escape[0]= (char)c;
+      }
+    }
+
+    if ((size_t)(to_end - pos) < n)
+    {
+      /* Not leaving a part of a UTF-8 sequence */
+      while (pos > to && ((uchar)pos[-1] & 0xC0) == 0x80)
+      {
+        --pos;
+      }
+      if (pos > to && (uchar)pos[-1] >= 0xC0)
+      {
+        --pos;
+      }
+      *complete= FALSE;
+      break;
+    }
+
+    memcpy(pos, escape, n);
+    pos+= n;
+  }
+
+  return pos - to;
+}
+
+
+/*
+  Puts a record into the ring, or counts it as dropped if the ring is full.
+  Record starts with the given prefix, which ends with a string field that
+  text is the value of.
+*/
+static void query_log_push(const char *prefix, size_t prefix_length,
+                           const char *text, size_t text_length)
+{
+  static const char truncated[]= "\",\"truncated\":true}\n";
+  QUERY_LOG_SLOT *slot;
+  long pos= counter_get(&query_log.head);
+  my_bool complete= TRUE;
+  size_t length;
+
+  for (;;)
+  {
+    long diff;
+
+    slot= &query_log.slots[pos & (QUERY_LOG_SLOTS - 1)];
+    diff= SEQ_DIFF(counter_get(&slot->sequence), pos);
+
+    if (diff == 0)
+    {
+      if (counter_cas(&query_log.head, pos, pos + 1))
+      {
+        break;
+      }
+    }
+    else if (diff < 0)
+    {
+      /* The writer has not freed the slot yet */
+      counter_add(&query_log.dropped, 1);
+      return;
+    }
+
+    pos= counter_get(&query_log.head);
+  }
+
+  length= myodbc_min(prefix_length, QUERY_LOG_RECORD - sizeof(truncated));
+  memcpy(slot->record, prefix, length);
+  length+= json_escape(slot->record + length,
+                       QUERY_LOG_RECORD - sizeof(truncated) - length,
+                       text, text_length, &complete);
+
+  if (complete)
+  {
+    memcpy(slot->record + length, "\"}\n", 3);
+    length+= 3;
+  }
+  else
+  {
+    memcpy(slot->record + length, truncated, sizeof(truncated) - 1);
+    length+= sizeof(truncated) - 1;
+  }
+  slot->length= (uint)length;
+
+  counter_set(&slot->sequence, pos + 1);
+}
+
+
+static void query_log_rotate()
+{
+  char old_name[FN_REFLEN + 2];
+
+  fclose(query_log.file);
+
+  sprintf(old_name, "%s.1", query_log.filename);
+  remove(old_name);
+  rename(query_log.filename, old_name);
+
+  query_log.file= fopen(query_log.filename, "a");
+  query_log.size= 0;
+}
+
+
+/* Writes records of the ring to the file, returns how many */
+static uint query_log_flush()
+{
+  long dropped= counter_get(&query_log.dropped);
+  uint count= 0;
+
+  for (;; ++count)
+  {
+    QUERY_LOG_SLOT *slot= &query_log.slots[query_log.tail &
+                                           (QUERY_LOG_SLOTS - 1)];
+
+    if (SEQ_DIFF(counter_get(&slot->sequence), query_log.tail + 1) < 0)
+    {
+      break;
+    }
+
+    if (query_log.file != NULL)
+    {
+      fwrite(slot->record, 1, slot->length, query_log.file);
+      query_log.size+= slot->length;
+    }
+
+    counter_set(&slot->sequence, query_log.tail + QUERY_LOG_SLOTS);
+    ++query_log.tail;
+
+    if (query_log.max_size > 0 && query_log.size >= query_log.max_size &&
+        query_log.file != NULL)
+    {
+      query_log_rotate();
+    }
+  }
+
+  if (dropped > 0 && query_log.file != NULL)
+  {
+    char ts[32];
+
+    counter_add(&query_log.dropped, -dropped);
+    format_time(ts, myodbc_wall_time_us());
+    query_log.size+= fprintf(query_log.file,
+                             "{\"ts\":\"%s\",\"event\":\"dropped\","
+                             "\"count\":%ld}\n", ts, dropped);
+  }
+
+  if (count > 0 && query_log.file != NULL)
+  {
+    fflush(query_log.file);
+  }
+
+  return count;
+}
+
+
+static void * query_log_writer(void *arg)
+{
+  myodbc_mutex_lock(&query_log.lock);
+
+  while (!query_log.stop)
+  {
+    /* The file is written without the lock held */
+    myodbc_mutex_unlock(&query_log.lock);
+    if (query_log_flush() == 0)
+    {
+      myodbc_mutex_lock(&query_log.lock);
+      if (!query_log.stop)
+      {
+        myodbc_cond_timedwait(&query_log.cond, &query_log.lock,
+                              QUERY_LOG_WAIT_MS);
+      }
+      continue;
+    }
+    myodbc_mutex_lock(&query_log.lock);
+  }
+
+  myodbc_mutex_unlock(&query_log.lock);
+
+  query_log_flush();
+
+  return NULL;
+}
+
+
+void query_log_init()
+{
+  myodbc_mutex_init(&query_log.lock, NULL);
+}
+
+
+void query_log_end()
+{
+  myodbc_mutex_destroy(&query_log.lock);
+}
+
+
+/*
+  Opens the query log for a connection. The first connection starts the
+  writer, its LOG_QUERY_MAX_SIZE applies to the log until the last one
+  closes it.
+
+  @return FALSE if the log is open
+*/
+my_bool query_log_open(DataSource *ds)
+{
+  my_bool error= FALSE;
+
+  myodbc_mutex_lock(&query_log.lock);
+
+  if (query_log.users == 0)
+  {
+    long i;
+#ifdef _WIN32
+    size_t buffsize;
+
+    getenv_s(&buffsize, query_log.filename, sizeof(query_log.filename),
+             "TEMP");
+
+    if (buffsize)
+    {
+      sprintf(query_log.filename + buffsize - 1, "\\%s",
+              DRIVER_QUERY_LOGFILE);
+    }
+    else
+    {
+      sprintf(query_log.filename, "c:\\%s", DRIVER_QUERY_LOGFILE);
+    }
+#else
+    strmov(query_log.filename, DRIVER_QUERY_LOGFILE);
+#endif
+
+    query_log.slots= (QUERY_LOG_SLOT *)myodbc_malloc(sizeof(QUERY_LOG_SLOT) *
+                                                     QUERY_LOG_SLOTS,
+                                                     MYF(0));
+    if (query_log.slots == NULL ||
+        !(query_log.file= fopen(query_log.filename, "a")))
+    {
+      x_free(query_log.slots);
+      query_log.slots= NULL;
+      error= TRUE;
+      goto exit;
+    }
+
+    for (i= 0; i < QUERY_LOG_SLOTS; ++i)
+    {
+      query_log.slots[i].sequence= i;
+    }
+    query_log.head= query_log.tail= 0;
+    query_log.dropped= 0;
+    query_log.stop= FALSE;
+    query_log.max_size= (my_ulonglong)ds->log_query_max_size * 1024 * 1024;
+
+    fseek(query_log.file, 0, SEEK_END);
+    query_log.size= ftell(query_log.file);
+
+    {
+      char ts[32];
+
+      format_time(ts, myodbc_wall_time_us());
+      query_log.size+= fprintf(query_log.file,
+                               "{\"ts\":\"%s\",\"event\":\"open\","
+                               "\"driver\":\"%s\",\"version\":\"%s\"}\n",
+                               ts, DRIVER_NAME, DRIVER_VERSION);
+      fflush(query_log.file);
+    }
+
+    myodbc_cond_init(&query_log.cond);
+
+    if (myodbc_thread_create(&query_log.writer, query_log_writer, NULL))
+    {
+      myodbc_cond_destroy(&query_log.cond);
+      fclose(query_log.file);
+      query_log.file= NULL;
+      x_free(query_log.slots);
+      query_log.slots= NULL;
+      error= TRUE;
+      goto exit;
+    }
+  }
+
+  ++query_log.users;
+
+exit:
+  myodbc_mutex_unlock(&query_log.lock);
+
+  return error;
+}
+
+
+/* Closes the query log for a connection, the last one stops the writer */
+void query_log_close()
+{
+  myodbc_mutex_lock(&query_log.lock);
+
+  if (query_log.users == 0 || --query_log.users > 0)
+  {
+    myodbc_mutex_unlock(&query_log.lock);
+    return;
+  }
+
+  query_log.stop= TRUE;
+  myodbc_cond_signal(&query_log.cond);
+  myodbc_mutex_unlock(&query_log.lock);
+
+  /* Writes what is left in the ring */
+  myodbc_thread_join(&query_log.writer);
+  myodbc_cond_destroy(&query_log.cond);
+
+  fclose(query_log.file);
+  query_log.file= NULL;
+  x_free(query_log.slots);
+  query_log.slots= NULL;
+}
+
+
+/* Logs a query or message of the connection, or of its statement */
+void query_log_print(DBC *dbc, STMT *stmt, const char *text)
+{
+  char prefix[160], ts[32];
+  int length;
+
+  if (!dbc->query_log || text == NULL)
+  {
+    return;
+  }
+
+  format_time(ts, myodbc_wall_time_us());
+  length= sprintf(prefix, "{\"ts\":\"%s\",\"conn\":%lu,\"stmt\":%lu,"
+                  "\"event\":\"query\",\"text\":\"", ts,
+                  mysql_thread_id(&dbc->mysql), stmt ? stmt->id : 0UL);
+
+  query_log_push(prefix, length, text, strlen(text));
+}
+
+
+/*
+  Logs the start of an execution of the statement, if it is sampled. The
+  text is logged before the query is sent, so a query that never returns
+  is in the log too. Called with dbc->lock held.
+
+  @param[in] stmt      Statement
+  @param[in] query     Query to be executed
+  @param[in] length    Its length
+*/
+void query_log_start(STMT *stmt, const char *query, size_t length)
+{
+  DBC *dbc= stmt->dbc;
+  char prefix[160], ts[32];
+  int prefix_length;
+
+  dbc->query_log_sampled= dbc->query_log &&
+                          (dbc->ds->log_query_sample <= 1 ||
+                           dbc->query_log_count++ %
+                             dbc->ds->log_query_sample == 0);
+  if (!dbc->query_log_sampled)
+  {
+    return;
+  }
+
+  format_time(ts, myodbc_wall_time_us());
+  prefix_length= sprintf(prefix, "{\"ts\":\"%s\",\"conn\":%lu,\"stmt\":%lu,"
+                         "\"event\":\"start\",\"text\":\"", ts,
+                         mysql_thread_id(&dbc->mysql), stmt->id);
+
+  query_log_push(prefix, prefix_length, query, length);
+}
+
+
+/*
+  Logs the end of the execution started by query_log_start(), if it is
+  sampled. It follows the "start" event of the same conn and stmt.
+
+  @param[in] stmt      Statement
+  @param[in] length    Bytes sent for the query to the server
+  @param[in] start     myodbc_time_us() when the execution started
+  @param[in] rows      Rows in the result, or affected rows
+  @param[in] error     Native error code, 0 if it has succeeded
+*/
+void query_log_execute(STMT *stmt, size_t length, my_ulonglong start,
+                       my_ulonglong rows, uint error)
+{
+  DBC *dbc= stmt->dbc;
+  char prefix[320], ts[32];
+  const char *sqlstate= error ? (const char *)stmt->error.sqlstate : "00000";
+  my_ulonglong now;
+  int prefix_length;
+
+  if (!dbc->query_log_sampled)
+  {
+    return;
+  }
+  dbc->query_log_sampled= FALSE;
+
+  now= myodbc_time_us();
+  format_time(ts, myodbc_wall_time_us());
+  prefix_length= sprintf(prefix, "{\"ts\":\"%s\",\"conn\":%lu,\"stmt\":%lu,"
+                         "\"event\":\"execute\",\"ssps\":%s,"
+                         "\"duration_us\":%llu,\"rows\":%llu,\"bytes\":%lu,"
+                         "\"error\":%u,\"sqlstate\":\"", ts,
+                         mysql_thread_id(&dbc->mysql), stmt->id,
+                         ssps_used(stmt) ? "true" : "false",
+                         (unsigned long long)(now - start),
+                         (unsigned long long)rows, (unsigned long)length,
+                         error);
+
+  query_log_push(prefix, prefix_length, sqlstate, strlen(sqlstate));
+}
+
+
+/*
+  Logs the counters of the connection and its statements, see
+  STATS_INTERVAL. Called with dbc->lock held.
+*/
+void query_log_stats(DBC *dbc)
+{
+  char prefix[1024], ts[32], *pos= prefix;
+  const char *dsn= "";
+  MY_STATS stats;
+  uint i;
+
+  dbc->stats_logged= time(NULL);
+
+  if (!dbc->query_log)
+  {
+    return;
+  }
+
+  dbc_get_stats(dbc, &stats);
+
+  if (dbc->ds->name)
+  {
+    dsn= (const char *)ds_get_utf8attr(dbc->ds->name, &dbc->ds->name8);
+  }
+
+  format_time(ts, myodbc_wall_time_us());
+  pos+= sprintf(pos, "{\"ts\":\"%s\",\"conn\":%lu,\"event\":\"stats\","
+                "\"executions\":%llu,\"parse_us\":%llu,\"params_us\":%llu,"
+                "\"query_us\":%llu,\"result_us\":%llu,\"fetch_us\":%llu,"
+                "\"rows_fetched\":%llu,\"bytes_fetched\":%llu,"
+                "\"scroller_windows\":%llu,\"latency_ms\":[", ts,
+                mysql_thread_id(&dbc->mysql),
+                (unsigned long long)stats.executions,
+                (unsigned long long)stats.parse_us,
+                (unsigned long long)stats.params_us,
+                (unsigned long long)stats.query_us,
+                (unsigned long long)stats.result_us,
+                (unsigned long long)stats.fetch_us,
+                (unsigned long long)stats.rows_fetched,
+                (unsigned long long)stats.bytes_fetched,
+                (unsigned long long)stats.scroller_windows);
+
+  for (i= 0; i < MY_STATS_BUCKETS; ++i)
+  {
+    pos+= sprintf(pos, i ? ",%llu" : "%llu",
+                  (unsigned long long)stats.latency[i]);
+  }
+  pos+= sprintf(pos, "],\"cancels\":%llu,\"cancel_us\":%llu,"
+                "\"keyset_windows\":%llu,\"dsn\":\"",
+                (unsigned long long)stats.cancels,
+                (unsigned long long)stats.cancel_us,
+                (unsigned long long)stats.keyset_windows);
+
+  query_log_push(prefix, pos - prefix, dsn, strlen(dsn));
+}
@@ -30,7 +30,6 @@
 #include "driver.h"
 #include <errmsg.h>
 #include <ctype.h>
-#include <locale.h>
 
 #define SQL_MY_PRIMARY_KEY 1212
 
@@ -362,28 +361,37 @@ sql_get_bookmark_data(STMT *stmt, SQLSMALLINT fCType, uint column_number,
 }
 
 
-/**
-  Retrieve the data from a field as a specified ODBC C type.
+/* Whether data of the field can be returned as fCType */
+static my_bool is_conversion_supported(STMT *stmt, MYSQL_FIELD *field,
+                                       SQLSMALLINT fCType)
+{
+  return odbc_supported_conversion(get_sql_data_type(stmt, field, 0), fCType)
+      || driver_supported_conversion(field, fCType);
+}
 
-  TODO arrec->indicator_ptr could be different than pcbValue
-  ideally, two separate pointers would be passed here
 
-  @param[in]  stmt        Handle of statement
-  @param[in]  fCType      ODBC C type to return data as
-  @param[in]  field       Field describing the type of the data
-  @param[out] rgbValue    Pointer to buffer for returning data
-  @param[in]  cbValueMax  Length of buffer
-  @param[out] pcbValue    Bytes used in the buffer, or SQL_NULL_DATA
-  @param[out] value       The field data to be converted and returned
-  @param[in]  length      Length of value
-  @param[in]  arrec       ARD record for this column (can be NULL)
+/**
+  Does the actual job of sql_get_data() for the field when the C type is
+  already resolved and the conversion is checked.
+
+  @param[in]  stmt          Handle of statement
+  @param[in]  fCType        ODBC C type to return data as(not SQL_C_DEFAULT)
+  @param[in]  column_number 0-based column number
+  @param[in]  field         Field describing the type of the data
+  @param[in]  conversion_ok Whether the conversion to fCType is supported
+  @param[out] rgbValue      Pointer to buffer for returning data
+  @param[in]  cbValueMax    Length of buffer
+  @param[out] pcbValue      Bytes used in the buffer, or SQL_NULL_DATA
+  @param[out] value         The field data to be converted and returned
+  @param[in]  length        Length of value
+  @param[in]  arrec         ARD record for this column (can be NULL)
 */
-SQLRETURN SQL_API
-sql_get_data(STMT *stmt, SQLSMALLINT fCType, uint column_number,
-             SQLPOINTER rgbValue, SQLLEN cbValueMax, SQLLEN *pcbValue,
-             char *value, ulong length, DESCREC *arrec)
+static SQLRETURN
+convert_field_data(STMT *stmt, SQLSMALLINT fCType, uint column_number,
+                   MYSQL_FIELD *field, my_bool conversion_ok,
+                   SQLPOINTER rgbValue, SQLLEN cbValueMax, SQLLEN *pcbValue,
+                   char *value, ulong length, DESCREC *arrec)
 {
-  MYSQL_FIELD *field= mysql_fetch_field_direct(stmt->result, column_number);
   SQLLEN    tmp;
   long long numericValue;
   my_bool   convert= 1;
@@ -391,26 +399,6 @@ sql_get_data(STMT *stmt, SQLSMALLINT fCType, uint column_number,
   char      as_string[50]; /* Buffer that might be required to convert other
                               types data to its string representation */
 
-  /* get the exact type if we don't already have it */
-  if (fCType == SQL_C_DEFAULT)
-  {
-    fCType= unireg_to_c_datatype(field);
-
-    if (!cbValueMax)
-    {
-      cbValueMax= bind_length(fCType, 0);
-    }
-  }
-  else if (fCType == SQL_ARD_TYPE)
-  {
-    if (!arrec)
-    {
-      return set_stmt_error(stmt, "07009", "Invalid descriptor index", 0);
-    }
-
-    fCType= arrec->concise_type;
-  }
-
   /* set prec and scale for numeric */
   if (fCType == SQL_C_NUMERIC && rgbValue)
   {
@@ -441,8 +429,7 @@ sql_get_data(STMT *stmt, SQLSMALLINT fCType, uint column_number,
   }
   else
   {
-    if (!odbc_supported_conversion(get_sql_data_type(stmt, field, 0), fCType)
-     && !driver_supported_conversion(field,fCType))
+    if (!conversion_ok)
     {
       /*The state 07009 was incorrect
       (http://msdn.microsoft.com/en-us/library/ms715441%28v=VS.85%29.aspx)
@@ -915,6 +902,56 @@ sql_get_data(STMT *stmt, SQLSMALLINT fCType, uint column_number,
 }
 
 
+/**
+  Retrieve the data from a field as a specified ODBC C type.
+
+  TODO arrec->indicator_ptr could be different than pcbValue
+  ideally, two separate pointers would be passed here
+
+  @param[in]  stmt        Handle of statement
+  @param[in]  fCType      ODBC C type to return data as
+  @param[in]  field       Field describing the type of the data
+  @param[out] rgbValue    Pointer to buffer for returning data
+  @param[in]  cbValueMax  Length of buffer
+  @param[out] pcbValue    Bytes used in the buffer, or SQL_NULL_DATA
+  @param[out] value       The field data to be converted and returned
+  @param[in]  length      Length of value
+  @param[in]  arrec       ARD record for this column (can be NULL)
+*/
+SQLRETURN SQL_API
+sql_get_data(STMT *stmt, SQLSMALLINT fCType, uint column_number,
+             SQLPOINTER rgbValue, SQLLEN cbValueMax, SQLLEN *pcbValue,
+             char *value, ulong length, DESCREC *arrec)
+{
+  MYSQL_FIELD *field= mysql_fetch_field_direct(stmt->result, column_number);
+
+  /* get the exact type if we don't already have it */
+  if (fCType == SQL_C_DEFAULT)
+  {
+    fCType= unireg_to_c_datatype(field);
+
+    if (!cbValueMax)
+    {
+      cbValueMax= bind_length(fCType, 0);
+    }
+  }
+  else if (fCType == SQL_ARD_TYPE)
+  {
+    if (!arrec)
+    {
+      return set_stmt_error(stmt, "07009", "Invalid descriptor index", 0);
+    }
+
+    fCType= arrec->concise_type;
+  }
+
+  return convert_field_data(stmt, fCType, column_number, field,
+                            is_conversion_supported(stmt, field, fCType),
+                            rgbValue, cbValueMax, pcbValue, value, length,
+                            arrec);
+}
+
+
 /*
   @type    : myodbc3 internal
   @purpose : execute the query if it is only prepared. This is needed
@@ -1318,6 +1355,8 @@ SQLRETURN SQL_API SQLBindCol(SQLHSTMT      StatementHandle,
 
   if (!TargetValuePtr && !StrLen_or_IndPtr) /* Handling unbinding */
   {
+    ++stmt->ard->version;
+
     /*
        If unbinding the last bound column, we reduce the
        ARD records until the highest remaining bound column.
@@ -1490,10 +1529,6 @@ SQLRETURN SQL_API SQLGetData(SQLHSTMT      StatementHandle,
 
     assert(irrec);
 
-    if (!stmt->dbc->ds->dont_use_set_locale)
-      setlocale(LC_NUMERIC, "C");
-
-
     if ((sColNum == -1 && stmt->stmt_options.bookmarks == SQL_UB_VARIABLE))
     {
       char _value[21];
@@ -1520,9 +1555,6 @@ SQLRETURN SQL_API SQLGetData(SQLHSTMT      StatementHandle,
                           arrec);
     }
 
-    if (!stmt->dbc->ds->dont_use_set_locale)
-        setlocale(LC_NUMERIC,default_locale);
-
     return result;
 }
 
@@ -1536,13 +1568,28 @@ SQLRETURN SQL_API SQLGetData(SQLHSTMT      StatementHandle,
 
 SQLRETURN SQL_API SQLMoreResults( SQLHSTMT hStmt )
 {
-  STMT *  pStmt   = (STMT *)hStmt;
-  int         nRetVal;
-  SQLRETURN   nReturn = SQL_SUCCESS;
+  SQLRETURN rc;
 
   CHECK_HANDLE(hStmt);
 
-  myodbc_mutex_lock( &pStmt->dbc->lock );
+  if (async_poll((STMT *)hStmt, SQL_API_SQLMORERESULTS, &rc))
+    return rc;
+
+  if (ASYNC_ENABLED((STMT *)hStmt))
+    return async_start((STMT *)hStmt, SQL_API_SQLMORERESULTS, 0, 0);
+
+  return my_SQLMoreResults((STMT *)hStmt);
+}
+
+
+/* Body of SQLMoreResults(), run by an async worker as well */
+SQLRETURN my_SQLMoreResults(STMT *pStmt)
+{
+  int         nRetVal;
+  SQLRETURN   nReturn = SQL_SUCCESS;
+
+  lock_dbc(pStmt->dbc);
+  dbc_set_running(pStmt->dbc, pStmt);
 
   CLEAR_STMT_ERROR( pStmt );
 
@@ -1560,6 +1607,12 @@ SQLRETURN SQL_API SQLMoreResults( SQLHSTMT hStmt )
     goto exitSQLMoreResults;
   }
 
+  if (async_canceled(pStmt))
+  {
+    nReturn= set_error(pStmt, MYERR_S1008, NULL, 0);
+    goto exitSQLMoreResults;
+  }
+
   /* try to get next resultset */
   nRetVal = next_result(pStmt);
 
@@ -1647,6 +1700,7 @@ SQLRETURN SQL_API SQLMoreResults( SQLHSTMT hStmt )
   }
 
 exitSQLMoreResults:
+  dbc_set_running(pStmt->dbc, NULL);
   myodbc_mutex_unlock( &pStmt->dbc->lock );
   return nReturn;
 }
@@ -1775,6 +1829,142 @@ fill_fetch_bookmark_buffers(STMT *stmt, ulong value, uint rownum)
 }
 
 
+/**
+  Makes sure the fetch plan of the statement corresponds to the current
+  result and ARD bindings, and rebuilds it if it does not. Thus the type
+  resolution and conversion checks are done once, and not for every fetched
+  cell.
+
+  @param[in]  stmt        Handle of statement
+*/
+static SQLRETURN prepare_fetch_plan(STMT *stmt)
+{
+  MY_FETCH_PLAN     *plan= &stmt->fetch_plan;
+  MY_FETCH_PLAN_COL *col;
+  DESCREC           *irrec, *arrec;
+  uint              i, count= (uint)myodbc_min(stmt->ird->count,
+                                               stmt->ard->count);
+
+  if (plan->valid && plan->result == stmt->result
+    && plan->fields == stmt->result->fields
+    && plan->ard == stmt->ard
+    && plan->ard_version == stmt->ard->version
+    && plan->ird_version == stmt->ird->version
+    && plan->column_count == count)
+  {
+    return SQL_SUCCESS;
+  }
+
+  plan->valid= FALSE;
+  plan->count= 0;
+  plan->direct_count= 0;
+
+  if (count > plan->allocated)
+  {
+    col= (MY_FETCH_PLAN_COL *)myodbc_realloc(plan->cols,
+                                    count * sizeof(MY_FETCH_PLAN_COL),
+                                    MYF(MY_ALLOW_ZERO_PTR));
+    if (col == NULL)
+    {
+      return set_error(stmt, MYERR_S1001, NULL, 4001);
+    }
+
+    plan->cols= col;
+    plan->allocated= count;
+  }
+
+  for (i= 0; i < count; ++i)
+  {
+    irrec= desc_get_rec(stmt->ird, i, FALSE);
+    arrec= desc_get_rec(stmt->ard, i, FALSE);
+    assert(irrec && arrec);
+
+    if (!ARD_IS_BOUND(arrec))
+    {
+      continue;
+    }
+
+    col= plan->cols + plan->count++;
+
+    col->column=        i;
+    col->arrec=         arrec;
+    col->irrec=         irrec;
+    col->field=         mysql_fetch_field_direct(stmt->result, i);
+    col->c_type=        arrec->concise_type;
+    col->buffer_length= arrec->octet_length;
+
+    if (col->c_type == SQL_C_DEFAULT)
+    {
+      col->c_type= unireg_to_c_datatype(col->field);
+
+      if (!col->buffer_length)
+      {
+        col->buffer_length= bind_length(col->c_type, 0);
+      }
+    }
+
+    col->conversion_ok= is_conversion_supported(stmt, col->field, col->c_type);
+
+    /* Same as ptr_offset_adjust does, but the bind offset is added for each
+       row, since the value it points to can be changed between fetches */
+    col->data_ptr=      (char *)arrec->data_ptr;
+    col->length_ptr=    (char *)arrec->octet_length_ptr;
+    if (stmt->ard->bind_type == SQL_BIND_BY_COLUMN)
+    {
+      col->data_stride=   arrec->octet_length;
+      col->length_stride= sizeof(SQLLEN);
+    }
+    else
+    {
+      col->data_stride=   stmt->ard->bind_type;
+      col->length_stride= stmt->ard->bind_type;
+    }
+
+    /* Binary value of the exact C type needs no conversion and can be put by
+       libmysql right where the application wants it. Unbuffered results are
+       left alone, since positioned operations could not refetch the row */
+    col->direct= ssps_used(stmt) && col->data_ptr != NULL
+              && stmt->out_params_state == OPS_UNKNOWN
+              && !if_forward_cache(stmt)
+              && ssps_direct_fetch_type(col->field, col->c_type);
+    if (col->direct)
+    {
+      col->buffer_length= bind_length(col->c_type, 0);
+      ++plan->direct_count;
+    }
+  }
+
+  plan->result=       stmt->result;
+  plan->fields=       stmt->result->fields;
+  plan->ard=          stmt->ard;
+  plan->ard_version=  stmt->ard->version;
+  plan->ird_version=  stmt->ird->version;
+  plan->column_count= count;
+  plan->valid=        TRUE;
+
+  return SQL_SUCCESS;
+}
+
+
+/**
+  Lets the next fetch_row() put values of the columns, that need no
+  conversion, right into the application buffers of the row.
+
+  @param[in]  stmt        Handle of statement
+  @param[in]  rownum      Row number of current fetch block
+*/
+static void set_direct_fetch_row(STMT *stmt, uint rownum)
+{
+  if (ssps_used(stmt) && stmt->out_params_state == OPS_UNKNOWN
+    && stmt->stmt_options.retrieve_data
+    && prepare_fetch_plan(stmt) == SQL_SUCCESS
+    && stmt->fetch_plan.direct_count > 0)
+  {
+    stmt->fetch_plan.direct_row= rownum;
+  }
+}
+
+
 /**
   Populate a single row of fetch buffers
 
@@ -1786,68 +1976,86 @@ static SQLRETURN
 fill_fetch_buffers(STMT *stmt, MYSQL_ROW values, uint rownum)
 {
   SQLRETURN res= SQL_SUCCESS, tmp_res;
-  int i;
   ulong length= 0;
-  DESCREC *irrec, *arrec;
- 
-  for (i= 0; i < myodbc_min(stmt->ird->count, stmt->ard->count); ++i, ++values)
+  size_t offset;
+  MY_FETCH_PLAN_COL *col, *end;
+
+  /* SQL_RD_OFF only positions the cursor */
+  if (!stmt->stmt_options.retrieve_data)
   {
-    irrec= desc_get_rec(stmt->ird, i, FALSE);
-    arrec= desc_get_rec(stmt->ard, i, FALSE);
-    assert(irrec && arrec);
+    return SQL_SUCCESS;
+  }
+
+  if (prepare_fetch_plan(stmt) != SQL_SUCCESS)
+  {
+    return SQL_ERROR;
+  }
+
+  offset= stmt->ard->bind_offset_ptr ? (size_t)*stmt->ard->bind_offset_ptr : 0;
 
-    if (ARD_IS_BOUND(arrec))
+  for (col= stmt->fetch_plan.cols, end= col + stmt->fetch_plan.count;
+       col < end; ++col)
+  {
+    SQLLEN *pcbValue= NULL;
+    SQLPOINTER TargetValuePtr= NULL;
+    char *value= values[col->column];
+
+    reset_getdata_position(stmt);
+
+    if (col->data_ptr)
     {
-      SQLLEN *pcbValue= NULL;
-      SQLPOINTER TargetValuePtr= NULL;
+      TargetValuePtr= col->data_ptr + offset + col->data_stride * rownum;
+    }
 
-      reset_getdata_position(stmt);
+    /* catalog functions with "fake" results won't have lengths */
+    length= col->irrec->row.datalen;
 
-      if (arrec->data_ptr)
-      {
-        TargetValuePtr= ptr_offset_adjust(arrec->data_ptr, 
-                                          stmt->ard->bind_offset_ptr, 
-                                          stmt->ard->bind_type, 
-                                          arrec->octet_length, rownum);
-      }
+    if (!length && value)
+    {
+      length= strlen(value);
+    }
+    stmt->stats.bytes_fetched+= length;
 
-      /* catalog functions with "fake" results won't have lengths */
-      length= irrec->row.datalen;
+    /* We need to pass that pointer to the sql_get_data so it could detect
+       22002 error - for NULL values that pointer has to be supplied by user.
+     */
+    if (col->length_ptr)
+    {
+      pcbValue= (SQLLEN *)(col->length_ptr + offset
+                           + col->length_stride * rownum);
+    }
 
-      if (!length && *values)
+    if (col->direct && stmt->fetch_plan.fetched_row == (long)rownum
+      && !is_null(stmt, col->column, value))
+    {
+      /* Already there */
+      if (pcbValue)
       {
-        length= strlen(*values);
+        *pcbValue= col->buffer_length;
       }
+      continue;
+    }
 
-      /* We need to pass that pointer to the sql_get_data so it could detect
-         22002 error - for NULL values that pointer has to be supplied by user.
-       */
-      if (arrec->octet_length_ptr)
+    tmp_res= convert_field_data(stmt, col->c_type, col->column, col->field,
+                                col->conversion_ok, TargetValuePtr,
+                                col->buffer_length, pcbValue, value, length,
+                                col->arrec);
+    if (tmp_res != SQL_SUCCESS)
+    {
+      if (tmp_res == SQL_SUCCESS_WITH_INFO)
       {
-        pcbValue= ptr_offset_adjust(arrec->octet_length_ptr, 
-                                      stmt->ard->bind_offset_ptr, 
-                                      stmt->ard->bind_type, 
-                                      sizeof(SQLLEN), rownum);
+        if (res == SQL_SUCCESS)
+          res= tmp_res;
       }
-
-      tmp_res= sql_get_data(stmt, arrec->concise_type, (uint)i,
-                            TargetValuePtr, arrec->octet_length, pcbValue,
-                            *values, length, arrec);
-      if (tmp_res != SQL_SUCCESS)
+      else
       {
-        if (tmp_res == SQL_SUCCESS_WITH_INFO)
-        {
-          if (res == SQL_SUCCESS)
-            res= tmp_res;
-        }
-        else
-        {
-          res= SQL_ERROR;
-        }
+        res= SQL_ERROR;
       }
     }
   }
 
+  ++stmt->stats.rows_fetched;
+
   return res;
 }
 
@@ -1868,6 +2076,7 @@ SQLRETURN SQL_API myodbc_single_fetch( SQLHSTMT             hstmt,
     SQLULEN           rows_to_fetch;
     long              cur_row, max_row;
     SQLRETURN         row_res, res;
+    my_ulonglong      start;
     STMT              *stmt= (STMT *) hstmt;
     MYSQL_ROW         values= 0;
     MYSQL_ROW_OFFSET  save_position= 0;
@@ -2041,14 +2250,10 @@ SQLRETURN SQL_API myodbc_single_fetch( SQLHSTMT             hstmt,
       }
     }
 
-    if (!stmt->dbc->ds->dont_use_set_locale)
-    {
-      setlocale(LC_NUMERIC, "C");
-    }
-
     res= SQL_SUCCESS;
     {
       save_position= row_tell(stmt);
+      set_direct_fetch_row(stmt, cur_row);
       /* - Actual fetching happens here - */
       if (!(values= fetch_row(stmt)) )
       {
@@ -2091,7 +2296,9 @@ SQLRETURN SQL_API myodbc_single_fetch( SQLHSTMT             hstmt,
                               stmt->result->field_count);
     }
 
+    start= myodbc_time_us();
     row_res= fill_fetch_buffers(stmt, values, cur_row);
+    stmt->stats.fetch_us+= myodbc_time_us() - start;
 
     /* For SQL_SUCCESS we need all rows to be SQL_SUCCESS */
     if (res != row_res)
@@ -2161,11 +2368,6 @@ exitSQLSingleFetch:
       stmt->end_of_set= row_seek(stmt, save_position);
     }
 
-    if (!stmt->dbc->ds->dont_use_set_locale)
-    {
-      setlocale(LC_NUMERIC,default_locale);
-    }
-
     if (SQL_SUCCEEDED(res)
       && stmt->rows_found_in_set < stmt->ard->array_size)
     {
@@ -2203,6 +2405,7 @@ SQLRETURN SQL_API my_SQLExtendedFetch( SQLHSTMT             hstmt,
     long              cur_row, max_row;
     SQLULEN           i;
     SQLRETURN         row_res, res, row_book= SQL_SUCCESS;
+    my_ulonglong      start;
     STMT              *stmt= (STMT *) hstmt;
     MYSQL_ROW         values= 0;
     MYSQL_ROW_OFFSET  save_position= 0;
@@ -2239,7 +2442,9 @@ SQLRETURN SQL_API my_SQLExtendedFetch( SQLHSTMT             hstmt,
                           "Wrong fetchtype with FORWARD ONLY cursor", 0);
     }
 
-    if ( if_dynamic_cursor(stmt) && set_dynamic_result(stmt) )
+    /* Dynamic cursor with a unique key reads only the rowset again, below */
+    if ( if_dynamic_cursor(stmt) && !keyset_usable(stmt) &&
+         set_dynamic_result(stmt) )
       return set_error(stmt,MYERR_S1000,
                        "Driver Failed to set the internal dynamic result", 0);
 
@@ -2383,14 +2588,19 @@ SQLRETURN SQL_API my_SQLExtendedFetch( SQLHSTMT             hstmt,
       }
     }
 
-    if (!stmt->dbc->ds->dont_use_set_locale)
+    if (if_dynamic_cursor(stmt) && keyset_usable(stmt) &&
+        keyset_refresh(stmt, rows_to_fetch) != SQL_SUCCESS)
     {
-      setlocale(LC_NUMERIC, "C");
+      return SQL_ERROR;
     }
 
+    /* Timed for the rowset, not for every row */
+    start= myodbc_time_us();
     res= SQL_SUCCESS;
     for (i= 0 ; i < rows_to_fetch ; ++i)
     {
+      SQLUSMALLINT row_status= SQL_ROW_SUCCESS;
+
       if ( stmt->result_array )
       {
         values= stmt->result_array + cur_row*stmt->result->field_count;
@@ -2406,6 +2616,7 @@ SQLRETURN SQL_API my_SQLExtendedFetch( SQLHSTMT             hstmt,
         {
             save_position= row_tell(stmt);
         }
+        set_direct_fetch_row(stmt, i);
         /* - Actual fetching happens here - */
         if ( stmt->out_params_state == OPS_UNKNOWN
           && !(values= fetch_row(stmt)) )
@@ -2445,6 +2656,11 @@ SQLRETURN SQL_API my_SQLExtendedFetch( SQLHSTMT             hstmt,
             values= (*stmt->fix_fields)(stmt,values);
         }
 
+        if (stmt->cursor.keyset_rows)
+        {
+          values= keyset_row(stmt, values, i, &row_status);
+        }
+
         stmt->current_values= values;
       }
 
@@ -2466,7 +2682,9 @@ SQLRETURN SQL_API my_SQLExtendedFetch( SQLHSTMT             hstmt,
         }
         else
         {
-          fill_ird_data_lengths(stmt->ird, fetch_lengths(stmt),
+          fill_ird_data_lengths(stmt->ird, stmt->cursor.keyset_rows ?
+                                           stmt->cursor.keyset_lengths :
+                                           fetch_lengths(stmt),
                                 stmt->result->field_count);
         }
       }
@@ -2501,21 +2719,29 @@ SQLRETURN SQL_API my_SQLExtendedFetch( SQLHSTMT             hstmt,
       /* "Fetching" includes buffers filling. I think errors in that 
          have to affect row status */
 
+      /* Updated or deleted row of a dynamic cursor, if fetched fine */
+      if (row_status == SQL_ROW_SUCCESS || !SQL_SUCCEEDED(row_res))
+      {
+        row_status= sqlreturn2row_status(row_res);
+      }
+
       if (rgfRowStatus)
       {
-        rgfRowStatus[i]= sqlreturn2row_status(row_res);
+        rgfRowStatus[i]= row_status;
       }
       /*
         No need to update rowStatusPtr_ex, it's the same as rgfRowStatus.
       */
       if (upd_status && stmt->ird->array_status_ptr)
       {
-        stmt->ird->array_status_ptr[i]= sqlreturn2row_status(row_res);
+        stmt->ird->array_status_ptr[i]= row_status;
       }
 
       ++cur_row;
     }   /* fetching cycle end*/
 
+    stmt->stats.fetch_us+= myodbc_time_us() - start;
+
     stmt->rows_found_in_set= i;
     *pcrow= i;
 
@@ -2551,11 +2777,6 @@ SQLRETURN SQL_API my_SQLExtendedFetch( SQLHSTMT             hstmt,
       stmt->end_of_set= row_seek(stmt, save_position);
     }
 
-    if (!stmt->dbc->ds->dont_use_set_locale)
-    {
-      setlocale(LC_NUMERIC,default_locale);
-    }
-
     if (SQL_SUCCEEDED(res)
       && stmt->rows_found_in_set < stmt->ard->array_size)
     {
@@ -2616,9 +2837,13 @@ SQLRETURN SQL_API SQLFetchScroll( SQLHSTMT      StatementHandle,
 {
     STMT *stmt = (STMT *)StatementHandle;
     STMT_OPTIONS *options;
+    SQLRETURN rc;
 
     CHECK_HANDLE(stmt);
 
+    if (async_poll(stmt, SQL_API_SQLFETCHSCROLL, &rc))
+      return rc;
+
     options= &stmt->stmt_options;
     options->rowStatusPtr_ex= NULL;
 
@@ -2637,6 +2862,10 @@ SQLRETURN SQL_API SQLFetchScroll( SQLHSTMT      StatementHandle,
                        stmt->stmt_options.bookmark_ptr);
     }
 
+    if (ASYNC_FETCH(stmt))
+      return async_start(stmt, SQL_API_SQLFETCHSCROLL, FetchOrientation,
+                         FetchOffset);
+
     return my_SQLExtendedFetch(StatementHandle, FetchOrientation, FetchOffset,
                                stmt->ird->rows_processed_ptr, stmt->ird->array_status_ptr,
                                0);
@@ -2652,12 +2881,19 @@ SQLRETURN SQL_API SQLFetch(SQLHSTMT StatementHandle)
 {
     STMT *stmt = (STMT *)StatementHandle;
     STMT_OPTIONS *options;
+    SQLRETURN rc;
 
     CHECK_HANDLE(stmt);
 
+    if (async_poll(stmt, SQL_API_SQLFETCH, &rc))
+      return rc;
+
     options= &stmt->stmt_options;
     options->rowStatusPtr_ex= NULL;
 
+    if (ASYNC_FETCH(stmt))
+      return async_start(stmt, SQL_API_SQLFETCH, SQL_FETCH_NEXT, 0);
+
     return my_SQLExtendedFetch(StatementHandle, SQL_FETCH_NEXT, 0,
                                stmt->ird->rows_processed_ptr, stmt->ird->array_status_ptr,
                                0);
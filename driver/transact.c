@@ -68,7 +68,7 @@ static SQLRETURN my_transact(SQLHDBC hdbc, SQLSMALLINT CompletionType)
 
     MYLOG_DBC_QUERY(dbc, query);
 
-    myodbc_mutex_lock(&dbc->lock);
+    lock_dbc(dbc);
     if (check_if_server_is_alive(dbc) ||
 	mysql_real_query(&dbc->mysql,query,length))
     {
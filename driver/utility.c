@@ -31,6 +31,12 @@
 #include "errmsg.h"
 #include <ctype.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# include <emmintrin.h>
+# define ESCAPE_SSE2 1
+#endif
+
 
 #define DATETIME_DIGITS 14
 
@@ -80,7 +86,7 @@ SQLRETURN odbc_stmt(DBC *dbc, const char *query,
  
   if (req_lock)
   {
-    myodbc_mutex_lock(&dbc->lock);
+    lock_dbc(dbc);
   }
 
   if (query_length == SQL_NTS)
@@ -103,6 +109,37 @@ SQLRETURN odbc_stmt(DBC *dbc, const char *query,
 }
 
 
+/**
+  Take the connection lock, counting the times the caller had to wait for
+  another thread holding it.
+
+  @param[in] dbc  The connection
+*/
+void lock_dbc(DBC *dbc)
+{
+  if (myodbc_mutex_trylock(&dbc->lock))
+  {
+    myodbc_mutex_lock(&dbc->lock);
+    ++dbc->lock_waits;
+  }
+}
+
+
+/**
+  Record the statement whose query runs while the connection lock is held,
+  so that SQLCancel() of another statement does not kill it.
+
+  @param[in] dbc   The connection, its lock held by the caller
+  @param[in] stmt  The statement, NULL before the lock is released
+*/
+void dbc_set_running(DBC *dbc, STMT *stmt)
+{
+  myodbc_mutex_lock(&dbc->env->cancel_lock);
+  dbc->running_stmt= stmt;
+  myodbc_mutex_unlock(&dbc->env->cancel_lock);
+}
+
+
 /**
   Link a list of fields to the current statement result.
 
@@ -114,14 +151,11 @@ SQLRETURN odbc_stmt(DBC *dbc, const char *query,
 */
 void myodbc_link_fields(STMT *stmt, MYSQL_FIELD *fields, uint field_count)
 {
-    MYSQL_RES *result;
-    myodbc_mutex_lock(&stmt->dbc->lock);
-    result= stmt->result;
+    MYSQL_RES *result= stmt->result;
     result->fields= fields;
     result->field_count= field_count;
     result->current_field= 0;
     fix_result_types(stmt);
-    myodbc_mutex_unlock(&stmt->dbc->lock);
 }
 
 
@@ -172,6 +206,7 @@ void fix_result_types(STMT *stmt)
   int capint32= stmt->dbc->ds->limit_column_size ? 1 : 0;
 
   stmt->state= ST_EXECUTED;  /* Mark set found */
+  stmt->fetch_plan.valid= FALSE;
 
   /* Populate the IRD records */
   for (i= 0; i < field_count(stmt); ++i)
@@ -2267,7 +2302,20 @@ int check_if_server_is_alive( DBC *dbc )
     time_t seconds= (time_t) time( (time_t*)0 );
     int result= 0;
 
-    if ( (ulong)(seconds - dbc->last_query_time) >= CHECK_IF_ALIVE )
+    if ( dbc->liveness_interval > 0 )
+    {
+        /* Environment's monitor checks the connection when it is idle.
+           With AUTO_RECONNECT it is reconnected here, as by the ping below */
+        result= dbc->server_gone;
+
+        if ( result && dbc->ds->auto_reconnect
+             && !mysql_ping( &dbc->mysql ) )
+        {
+            dbc->server_gone= FALSE;
+            result= 0;
+        }
+    }
+    else if ( (ulong)(seconds - dbc->last_query_time) >= CHECK_IF_ALIVE )
     {
         if ( mysql_ping( &dbc->mysql ) )
         {
@@ -2415,81 +2463,131 @@ void free_internal_result_buffers(STMT *stmt)
   free_root(&stmt->alloc_root, MYF(0));
 }
 
+
 /*
-  @type    : myodbc3 internal
-  @purpose : logs the queries sent to server
+  Microseconds since an arbitrary point, for durations and deadlines. The
+  clock is monotonic, changes of the system time do not affect it.
 */
-
-void query_print(FILE *log_file,char *query)
+my_ulonglong myodbc_time_us()
 {
-    if ( log_file && query )
-    {
-      /*
-        because of bug 68201 we bring the result of time() call
-        to 64-bits in any case
-      */
-      long long time_now= time(NULL);
+#ifdef _WIN32
+  static LARGE_INTEGER frequency;
+  LARGE_INTEGER counter;
 
-      fprintf(log_file, "%lld:%s;\n", time_now, query);
-    }
+  /* Fixed at boot, threads racing here store the same value */
+  if (frequency.QuadPart == 0)
+  {
+    QueryPerformanceFrequency(&frequency);
+  }
+  QueryPerformanceCounter(&counter);
+
+  return (my_ulonglong)(counter.QuadPart / frequency.QuadPart) * 1000000 +
+         (my_ulonglong)(counter.QuadPart % frequency.QuadPart) * 1000000 /
+         frequency.QuadPart;
+#else
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (my_ulonglong)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#endif
 }
 
 
-FILE *init_query_log(void)
+/* Microseconds since the epoch, for timestamps */
+my_ulonglong myodbc_wall_time_us()
 {
-    FILE *query_log;
 #ifdef _WIN32
-    char filename[MAX_PATH];
-    size_t buffsize;
-
-    getenv_s(&buffsize, filename, sizeof(filename), "TEMP");
+  FILETIME ft;
+  ULARGE_INTEGER t;
 
-    if (buffsize)
-    {
-      sprintf(filename + buffsize - 1, "\\%s", DRIVER_QUERY_LOGFILE);
-    }
-    else
-    {
-      sprintf(filename, "c:\\%s", DRIVER_QUERY_LOGFILE);
-    }
+  GetSystemTimeAsFileTime(&ft);
+  t.LowPart= ft.dwLowDateTime;
+  t.HighPart= ft.dwHighDateTime;
 
-    if ( (query_log= fopen(filename, "a+")) )
+  /* 100ns intervals since 1601-01-01 */
+  return t.QuadPart / 10 - 11644473600000000ULL;
 #else
-    if ( (query_log= fopen(DRIVER_QUERY_LOGFILE, "a+")) )
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return (my_ulonglong)tv.tv_sec * 1000000 + tv.tv_usec;
 #endif
-    {
-        fprintf(query_log,"-- Query logging\n");
-        fprintf(query_log,"--\n");
-        fprintf(query_log,"--  Driver name: %s  Version: %s\n",DRIVER_NAME,
-                DRIVER_VERSION);
-#ifdef HAVE_LOCALTIME_R
-        {
-            time_t now= time(NULL);
-            struct tm start;
-            localtime_r(&now,&start);
-
-            fprintf(query_log,"-- Timestamp: %02d%02d%02d %2d:%02d:%02d\n",
-                    start.tm_year % 100,
-                    start.tm_mon+1,
-                    start.tm_mday,
-                    start.tm_hour,
-                    start.tm_min,
-                    start.tm_sec);
-        }
-#endif /* HAVE_LOCALTIME_R */
-      fprintf(query_log,"\n");
-    }
-    return query_log;
 }
 
 
-void end_query_log(FILE *query_log)
+/* Counts an execution that took the given number of microseconds */
+void stats_add_execution(MY_STATS *stats, my_ulonglong usec)
 {
-  if ( query_log )
+  my_ulonglong ms= usec / 1000;
+  uint bucket= 0;
+
+  while (ms > 0 && bucket < MY_STATS_BUCKETS - 1)
   {
-      fclose(query_log);
-      query_log= 0;
+    ms>>= 1;
+    ++bucket;
   }
+
+  ++stats->executions;
+  ++stats->latency[bucket];
+}
+
+
+void stats_add(MY_STATS *to, const MY_STATS *from)
+{
+  SQLULEN *to_counter= (SQLULEN *)to;
+  const SQLULEN *from_counter= (const SQLULEN *)from;
+  uint i;
+
+  for (i= 0; i < MY_STATS_COUNTERS; ++i)
+  {
+    to_counter[i]+= from_counter[i];
+  }
+}
+
+
+/*
+  Totals of the connection, its statements included. Called with dbc->lock
+  held. Statements update their counters without it, so they may be a bit
+  behind. SQLCancel, which runs while another thread holds dbc->lock,
+  updates the cancel counters with env->cancel_lock held.
+*/
+void dbc_get_stats(DBC *dbc, MY_STATS *stats)
+{
+  LIST *item;
+
+  *stats= dbc->stats;
+
+  myodbc_mutex_lock(&dbc->env->cancel_lock);
+  for (item= dbc->statements; item != NULL; item= item->next)
+  {
+    stats_add(stats, &((STMT *)item->data)->stats);
+  }
+  myodbc_mutex_unlock(&dbc->env->cancel_lock);
+}
+
+
+/* Totals of the environment, its connections included */
+void env_get_stats(ENV *env, MY_STATS *stats)
+{
+  LIST *item;
+
+  myodbc_mutex_lock(&env->lock);
+
+  *stats= env->stats;
+
+  for (item= env->connections; item != NULL; item= item->next)
+  {
+    DBC *dbc= (DBC *)item->data;
+    MY_STATS dbc_stats;
+
+    myodbc_mutex_lock(&dbc->lock);
+    dbc_get_stats(dbc, &dbc_stats);
+    myodbc_mutex_unlock(&dbc->lock);
+
+    stats_add(stats, &dbc_stats);
+  }
+
+  myodbc_mutex_unlock(&env->lock);
 }
 
 
@@ -2620,6 +2718,148 @@ ulong myodbc_escape_string(MYSQL *mysql __attribute__((unused)),
 }
 
 
+/*
+  Escape sequences of the bytes mysql_real_escape_string() escapes, 0 for
+  bytes going into a quoted string as they are.
+*/
+static const char escape_sequence[256]=
+{
+  '0',0,0,0,0,0,0,0,0,0,'n',0,0,'r',0,0,   /* 00-0F: \0 \n \r */
+  0,0,0,0,0,0,0,0,0,0,'Z',0,0,0,0,0,       /* 10-1F: \032 */
+  0,0,'"',0,0,0,0,'\'',0,0,0,0,0,0,0,0,    /* 20-2F: " ' */
+  0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,         /* 30-3F */
+  0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,         /* 40-4F */
+  0,0,0,0,0,0,0,0,0,0,0,0,'\\',0,0,0       /* 50-5F: \ */
+};
+
+
+/*
+  Returns the first byte from pos on that has to be escaped, or end. If mb
+  is set, bytes with the high bit set, which are parts of multibyte
+  characters, stop the scan as well. With SSE2 16 bytes are checked at a
+  time.
+*/
+static const char *skip_unescaped_bytes(const char *pos, const char *end,
+                                        my_bool mb)
+{
+#ifdef ESCAPE_SSE2
+  const __m128i nul= _mm_setzero_si128(), newline= _mm_set1_epi8('\n');
+  const __m128i cr= _mm_set1_epi8('\r'), ctrl_z= _mm_set1_epi8('\032');
+  const __m128i backslash= _mm_set1_epi8('\\'), squote= _mm_set1_epi8('\'');
+  const __m128i dquote= _mm_set1_epi8('"');
+
+  while (end - pos >= 16)
+  {
+    __m128i bytes= _mm_loadu_si128((const __m128i *)pos);
+    __m128i special= _mm_cmpeq_epi8(bytes, nul);
+    int mask;
+
+    special= _mm_or_si128(special, _mm_cmpeq_epi8(bytes, newline));
+    special= _mm_or_si128(special, _mm_cmpeq_epi8(bytes, cr));
+    special= _mm_or_si128(special, _mm_cmpeq_epi8(bytes, ctrl_z));
+    special= _mm_or_si128(special, _mm_cmpeq_epi8(bytes, backslash));
+    special= _mm_or_si128(special, _mm_cmpeq_epi8(bytes, squote));
+    special= _mm_or_si128(special, _mm_cmpeq_epi8(bytes, dquote));
+
+    mask= _mm_movemask_epi8(special);
+    if (mb)
+    {
+      mask|= _mm_movemask_epi8(bytes);
+    }
+    if (mask)
+    {
+      int i= 0;
+      while (!(mask & (1 << i)))
+      {
+        ++i;
+      }
+      return pos + i;
+    }
+
+    pos+= 16;
+  }
+#endif
+
+  while (pos < end && !escape_sequence[(uchar)*pos] &&
+         !(mb && ((uchar)*pos & 0x80)))
+  {
+    ++pos;
+  }
+
+  return pos;
+}
+
+
+/**
+  Escapes a parameter value for a quoted string of a query, the same way
+  as mysql_real_escape_string() does. If no byte of a multibyte character
+  of the connection character set can be one that needs escaping (single
+  byte character sets, binary and utf8), runs of bytes that need no escaping
+  are found a block at a time and copied as they are. Valid utf8 characters
+  are copied whole; from an invalid sequence on, whose lead byte the client
+  library escapes, the rest goes to mysql_real_escape_string(). For other
+  character sets and in NO_BACKSLASH_ESCAPES mode mysql_real_escape_string()
+  is called.
+
+  @param[in]   mysql    Connection the value is going to
+  @param[out]  to       Buffer of at least 2*length+1 bytes
+  @param[in]   from     The value to escape
+  @param[in]   length   The length of the value
+
+  @return The length of the escaped value, not including the terminating
+          null written after it.
+*/
+ulong myodbc_escape_data(MYSQL *mysql, char *to, const char *from,
+                         ulong length)
+{
+  const char *end= from + length;
+  char *to_start= to;
+  my_bool mb= use_mb(mysql->charset) != 0;
+
+  if ((mysql->server_status & SERVER_STATUS_NO_BACKSLASH_ESCAPES) ||
+      (mb && strncmp(mysql->charset->csname, "utf8", 4) != 0))
+  {
+    return mysql_real_escape_string(mysql, to, from, length);
+  }
+
+  while (from < end)
+  {
+    const char *special= skip_unescaped_bytes(from, end, mb);
+    uint        mb_length;
+
+    memcpy(to, from, special - from);
+    to+= special - from;
+
+    if (special == end)
+    {
+      break;
+    }
+
+    if (mb && ((uchar)*special & 0x80))
+    {
+      if (!(mb_length= my_ismbchar(mysql->charset, special, end)))
+      {
+        return (ulong)(to - to_start) +
+               mysql_real_escape_string(mysql, to, special,
+                                        (ulong)(end - special));
+      }
+
+      memcpy(to, special, mb_length);
+      to+= mb_length;
+      from= special + mb_length;
+      continue;
+    }
+
+    *to++= '\\';
+    *to++= escape_sequence[(uchar)*special];
+    from= special + 1;
+  }
+
+  *to= 0;
+  return (ulong)(to - to_start);
+}
+
+
 /**
   Scale an int[] representing SQL_C_NUMERIC
 
@@ -3799,51 +4039,117 @@ char * complete_timestamp(const char * value, ulong length, char buff[21])
 }
 
 
-/*
-  HPUX has some problems with long double : http://docs.hp.com/en/B3782-90716/ch02s02.html
-
-  strtold() has implementations that return struct long_double, 128bit one,
-  which contains four 32bit words.
-  Fix described :
-  --------
-  union {
-	long_double l_d;
-	long double ld;
-  } u;
-  // convert str to a long_double; store return val in union
-  //(Putting value into union enables converted value to be
-  // accessed as an ANSI C long double)
-  u.l_d = strtold( (const char *)str, (char **)NULL);
-  --------
-  reinterpret_cast doesn't work :(
+/**
+  Converts a string to a number with '.' as the decimal point, whatever the
+  locale of the process is. The bundled dtoa is used instead of strtold(),
+  so setlocale() is not needed around conversions.
+
+  @param[in]  nptr    String to convert
+  @param[out] endptr  If not NULL, set to the first character not converted
+
+  @return The number, or +-DBL_MAX if it is out of the range of double
 */
 long double myodbc_strtold(const char *nptr, char **endptr)
 {
-/*
- * Experienced odd compilation errors on one of windows build hosts -
- * cmake reported there is strold function. Since double and long double on windows
- * are of the same size - we are using strtod on those platforms regardless
- * to the HAVE_FUNCTION_STRTOLD value
- */
-#ifdef _WIN32
-  return strtod(nptr, endptr);
-#else
-# ifndef HAVE_FUNCTION_STRTOLD
-	return strtod(nptr, endptr);
-# else
-#  if defined(__hpux) && defined(_LONG_DOUBLE)
-	union {
-		long_double l_d;
-		long double ld;
-	} u;
-	u.l_d = strtold( nptr, endptr);
-	return u.ld;
-#  else
-	return strtold(nptr, endptr);
-#  endif
-# endif
-#endif
+  char *end= (char *)nptr + strlen(nptr);
+  int error;
+  double result= my_strtod(nptr, &end, &error);
+
+  if (endptr)
+  {
+    *endptr= end;
+  }
+
+  return result;
+}
+
+
+/**
+  Formats a number as sprintf("%.<precision>e") does, but always with '.'
+  as the decimal point. printf() uses the decimal point of the locale of
+  the process, which could be anything if the application has called
+  setlocale(), so the separator it has put after the first digit is
+  replaced.
+
+  @param[in]  value      Number to format
+  @param[in]  precision  Number of digits after the decimal point
+  @param[out] buff       Buffer of at least precision + 32 bytes
+
+  @return Length of the string in buff
+*/
+size_t myodbc_d2str(double value, int precision, char *buff)
+{
+  int length= sprintf(buff, "%.*e", precision, value);
+  char *sep= buff + (*buff == '-'), *pos;
+
+  /* inf, nan and numbers without fraction digits have no decimal point */
+  if (precision <= 0 || !isdigit(*sep) || *++sep == '.')
+  {
+    return length;
+  }
+
+  for (pos= sep; *pos && !isdigit(*pos); ++pos);
+
+  *sep= '.';
+  memmove(sep + 1, pos, length - (pos - buff) + 1);
+
+  return length - (pos - sep - 1);
+}
+
 
+/**
+  Formats a number with the fewest digits that read back to the same
+  value, using my_gcvt from the bundled dtoa. An exponent is always
+  written, so the server takes the literal as a DOUBLE and not a DECIMAL.
+
+  @param[in]  value     Number to format
+  @param[in]  is_float  Whether the number has to read back as a float
+  @param[out] buff      Buffer of at least MY_GCVT_MAX_FIELD_WIDTH + 3 bytes
+
+  @return Length of the string in buff
+*/
+size_t myodbc_d2str_shortest(double value, BOOL is_float, char *buff)
+{
+  my_bool error;
+  size_t length= 0;
+
+  if (is_float)
+  {
+    /* FLT_DIG digits are enough for most floats, else all digits are used */
+    length= my_gcvt(value, MY_GCVT_ARG_FLOAT, MY_GCVT_MAX_FIELD_WIDTH, buff,
+                    &error);
+    if (!error)
+    {
+      char *end= buff + length;
+      int err;
+
+      if ((float)my_strtod(buff, &end, &err) != (float)value)
+      {
+        length= 0;
+      }
+    }
+  }
+
+  if (!length)
+  {
+    length= my_gcvt(value, MY_GCVT_ARG_DOUBLE, MY_GCVT_MAX_FIELD_WIDTH, buff,
+                    &error);
+  }
+
+  /* inf and nan are written as "0" by my_gcvt */
+  if (error)
+  {
+    return myodbc_d2str(value, 17, buff);
+  }
+
+  if (!memchr(buff, 'e', length))
+  {
+    buff[length++]= 'e';
+    buff[length++]= '0';
+    buff[length]= '\0';
+  }
+
+  return length;
 }
 
 
@@ -4117,65 +4423,6 @@ int get_session_variable(STMT *stmt, const char *var, char *result)
 }
 
 
-/**
-  Sets the value of @@max_execution_time
-
-  @param[in]  stmt        stmt handler
-  @param[in]  new_value   Value to set @@max_execution_time.
-
-  Returns new_value if operation was successful, -1 otherwise
- */
-SQLRETURN set_query_timeout(STMT *stmt, SQLULEN new_value)
-{
-  char query[44];
-  SQLRETURN rc= SQL_SUCCESS;
-
-  if (new_value == stmt->stmt_options.query_timeout ||
-      !is_minimum_version(stmt->dbc->mysql.server_version, "5.7.8"))
-  {
-    /* Do nothing if setting same timeout or MySQL server older than 5.7.8 */
-    return SQL_SUCCESS;
-  }
-
-  if (new_value > 0)
-  {
-    unsigned long long msec_value= (unsigned long long)new_value * 1000;
-    sprintf(query, "set @@max_execution_time=%llu", msec_value);
-  }
-  else
-  {
-    strcpy(query, "set @@max_execution_time=DEFAULT");
-    new_value= 0;
-  }
-
-  if (SQL_SUCCEEDED(rc= odbc_stmt(stmt->dbc, query, SQL_NTS, TRUE)))
-  {
-    stmt->stmt_options.query_timeout= new_value;
-  }
-
-  return rc;
-}
-
-
-SQLULEN get_query_timeout(STMT *stmt)
-{
-  SQLULEN query_timeout= SQL_QUERY_TIMEOUT_DEFAULT; /* 0 */
-  
-  if (is_minimum_version(stmt->dbc->mysql.server_version, "5.7.8"))
-  {
-    /* Be cautious with very long values even if they don't make sense */
-    char query_timeout_char[32]= {0};
-    uint length= get_session_variable(stmt, "MAX_EXECUTION_TIME", 
-                                      (char*)query_timeout_char);
-    /* Terminate the string just in case */
-    query_timeout_char[length]= 0;
-    /* convert */
-    query_timeout= (SQLULEN)(atol(query_timeout_char) / 1000);
-  }
-  return query_timeout;
-}
-
-
 const char get_identifier_quote(STMT *stmt)
 {
   const char tick= '`', quote= '"', empty= ' ';
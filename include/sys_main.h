@@ -548,6 +548,63 @@ static inline int native_mutex_destroy(native_mutex_t *mutex)
 #endif
 }
 
+#ifdef _WIN32
+typedef CONDITION_VARIABLE native_cond_t;
+#else
+typedef pthread_cond_t native_cond_t;
+#endif
+
+static inline int native_cond_init(native_cond_t *cond)
+{
+#ifdef _WIN32
+  InitializeConditionVariable(cond);
+  return 0;
+#else
+  /* pthread_condattr_t is not used in MySQL */
+  return pthread_cond_init(cond, NULL);
+#endif
+}
+
+static inline int native_cond_destroy(native_cond_t *cond)
+{
+#ifdef _WIN32
+  return 0; /* no destroy function */
+#else
+  return pthread_cond_destroy(cond);
+#endif
+}
+
+static inline int native_cond_wait(native_cond_t *cond, native_mutex_t *mutex)
+{
+#ifdef _WIN32
+  if (!SleepConditionVariableCS(cond, mutex, INFINITE))
+    return ETIMEDOUT;
+  return 0;
+#else
+  return pthread_cond_wait(cond, mutex);
+#endif
+}
+
+static inline int native_cond_signal(native_cond_t *cond)
+{
+#ifdef _WIN32
+  WakeConditionVariable(cond);
+  return 0;
+#else
+  return pthread_cond_signal(cond);
+#endif
+}
+
+static inline int native_cond_broadcast(native_cond_t *cond)
+{
+#ifdef _WIN32
+  WakeAllConditionVariable(cond);
+  return 0;
+#else
+  return pthread_cond_broadcast(cond);
+#endif
+}
+
 /* Debugging */
 #define DBUG_ENTER(a1)
 #define DBUG_LEAVE
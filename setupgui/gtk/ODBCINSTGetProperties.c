@@ -41,6 +41,13 @@ static const char *MYODBC_OPTIONS[][3] = {
   {"INITSTMT",          "T", "Initial statement executed at the connecting time"},
   {"CHARSET",           "T", "The character set to use for the connection"},
   {"PREFETCH",          "T", "Prefecth from server by N rows at a time"},
+  {"PREFETCH_ASYNC",    "T", "Fetch up to N PREFETCH windows ahead on a second connection"},
+  {"LIVENESS_INTERVAL", "T", "Ping idle connections every N seconds, keeping them past wait_timeout"},
+  {"STMT_CACHE_SIZE",   "T", "Keep up to N prepared statements of the connection for reuse"},
+  {"CATALOG_CACHE_TTL", "T", "Catalog cache TTL"},
+  {"LOG_QUERY_SAMPLE",  "T", "Log only every N-th statement execution"},
+  {"LOG_QUERY_MAX_SIZE", "T", "Rotate the query log at N megabytes"},
+  {"STATS_INTERVAL",    "T", "Write statistics to the query log every N seconds"},
   {"READTIMEOUT",       "T", "The timeout in seconds for attempts to read from the server"},
   {"WRITETIMEOUT",      "T", "The timeout in seconds for attempts to write to the server"},
   {"SSLCA",             "F", "The path to a file with a list of trust SSL CAs"},
@@ -81,6 +88,7 @@ static const char *MYODBC_OPTIONS[][3] = {
   {"CAN_HANDLE_EXP_PWD",      "C", "Can Handle Expired Password"},
   {"ENABLE_CLEARTEXT_PLUGIN", "C", "Enable Cleartext Authentication"},
   {"NO_SSPS",                 "C", "Prepare statements on the client"},
+  {"BATCH_PARAMS",            "C", "Send parameter arrays in batches"},
   {NULL, NULL, NULL}
 };
 
@@ -655,16 +655,27 @@ DECLARE_TEST(sqlcancel)
 {
   HANDLE thread;
   DWORD waitrc;
+  SQLULEN cancels;
+  int i;
 
-  thread= CreateThread(NULL, 0, cancel_in_one_second, hstmt, 0, NULL);
+  /* The 2nd cancel goes through the channel the 1st one has opened */
+  for (i= 0; i < 2; ++i)
+  {
+    thread= CreateThread(NULL, 0, cancel_in_one_second, hstmt, 0, NULL);
 
-  /* SLEEP(n) returns 1 when it is killed. */
-  ok_sql(hstmt, "SELECT SLEEP(5)");
-  ok_stmt(hstmt, SQLFetch(hstmt));
-  is_num(my_fetch_int(hstmt, 1), 1);
+    /* SLEEP(n) returns 1 when it is killed. */
+    ok_sql(hstmt, "SELECT SLEEP(5)");
+    ok_stmt(hstmt, SQLFetch(hstmt));
+    is_num(my_fetch_int(hstmt, 1), 1);
+    ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+
+    waitrc= WaitForSingleObject(thread, 10000);
+    is(!(waitrc == WAIT_TIMEOUT));
+  }
 
-  waitrc= WaitForSingleObject(thread, 10000);
-  is(!(waitrc == WAIT_TIMEOUT));
+  ok_stmt(hstmt, SQLGetStmtAttr(hstmt, SQL_ATTR_MYODBC_STATS_CANCELS,
+                                &cancels, 0, NULL));
+  is_num(cancels, 2);
 
   return OK;
 }
@@ -688,14 +699,26 @@ DECLARE_TEST(sqlcancel)
   pthread_t thread;
 
 #ifdef IODBC_BUG_SQLCANCEL_FIXED
-  pthread_create(&thread, NULL, cancel_in_one_second, hstmt);
+  SQLULEN cancels;
+  int i;
 
-  /* SLEEP(n) returns 1 when it is killed. */
-  ok_sql(hstmt, "SELECT SLEEP(10)");
-  ok_stmt(hstmt, SQLFetch(hstmt));
-  is_num(my_fetch_int(hstmt, 1), 1);
+  /* The 2nd cancel goes through the channel the 1st one has opened */
+  for (i= 0; i < 2; ++i)
+  {
+    pthread_create(&thread, NULL, cancel_in_one_second, hstmt);
 
-  pthread_join(thread, NULL);
+    /* SLEEP(n) returns 1 when it is killed. */
+    ok_sql(hstmt, "SELECT SLEEP(10)");
+    ok_stmt(hstmt, SQLFetch(hstmt));
+    is_num(my_fetch_int(hstmt, 1), 1);
+    ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+
+    pthread_join(thread, NULL);
+  }
+
+  ok_stmt(hstmt, SQLGetStmtAttr(hstmt, SQL_ATTR_MYODBC_STATS_CANCELS,
+                                &cancels, 0, NULL));
+  is_num(cancels, 2);
 #endif // ifdef IODBC_BUG_SQLCANCEL_FIXED
 
   return OK;
@@ -1203,6 +1226,340 @@ DECLARE_TEST(t_ssl_mode)
   return OK;
 }
 
+
+/*
+  LOG_QUERY writes a "start" event with the text before each execution and
+  an "execute" event after it, only for every N-th with LOG_QUERY_SAMPLE.
+  The log is written out when the last connection using it is closed.
+  TEST_QUERY_LOG is where the driver under test writes it, if not in the
+  default place.
+*/
+DECLARE_TEST(t_query_log)
+{
+  DECLARE_BASIC_HANDLES(henv1, hdbc1, hstmt1);
+  char line[4096], path[1024];
+  long start= 0;
+  int started= 0, executed= 0;
+  FILE *log;
+
+  if (getenv("TEST_QUERY_LOG"))
+    strncpy(path, getenv("TEST_QUERY_LOG"), sizeof(path) - 1);
+  else
+#ifdef _WIN32
+    sprintf(path, "%s\\myodbc.sql", getenv("TEMP") ? getenv("TEMP") : "c:");
+#else
+    strcpy(path, "/tmp/myodbc.sql");
+#endif
+  path[sizeof(path) - 1]= '\0';
+
+  if ((log= fopen(path, "r")) != NULL)
+  {
+    fseek(log, 0, SEEK_END);
+    start= ftell(log);
+    fclose(log);
+  }
+
+  is(OK == alloc_basic_handles_with_opt(&henv1, &hdbc1, &hstmt1, NULL,
+                                        NULL, NULL, NULL,
+                                        "LOG_QUERY=1;LOG_QUERY_SAMPLE=2"));
+
+  ok_sql(hstmt1, "SELECT 't_query_log_1'");
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+  ok_sql(hstmt1, "SELECT 't_query_log_2'");
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+  ok_sql(hstmt1, "SELECT 't_query_log_3'");
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+  ok_sql(hstmt1, "SELECT 't_query_log_4'");
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  free_basic_handles(&henv1, &hdbc1, &hstmt1);
+
+  log= fopen(path, "r");
+  is(log != NULL);
+  fseek(log, start, SEEK_SET);
+
+  while (fgets(line, sizeof(line), log))
+  {
+    if (strstr(line, "\"event\":\"start\"") &&
+        strstr(line, "\"text\":\"SELECT 't_query_log_"))
+    {
+      ++started;
+      is(strstr(line, "t_query_log_2") == NULL);
+      is(strstr(line, "t_query_log_4") == NULL);
+
+      /* The end of the execution follows its start */
+      is(fgets(line, sizeof(line), log) != NULL);
+      is(strstr(line, "\"event\":\"execute\"") != NULL);
+      ++executed;
+      is(strstr(line, "\"rows\":1,") != NULL);
+      is(strstr(line, "\"error\":0,") != NULL);
+      is(strstr(line, "\"sqlstate\":\"00000\"") != NULL);
+      is(strstr(line, "\"duration_us\":") != NULL);
+    }
+  }
+  fclose(log);
+
+  /* 1st and 3rd */
+  is_num(started, 2);
+  is_num(executed, 2);
+
+  return OK;
+}
+
+
+/* Counters of the statement, the connection and the environment */
+DECLARE_TEST(t_stats)
+{
+  DECLARE_BASIC_HANDLES(henv1, hdbc1, hstmt1);
+  SQLULEN executions, rows, bytes, latency, conn_executions, env_executions;
+  SQLINTEGER value;
+  int i;
+
+  is(OK == alloc_basic_handles_with_opt(&henv1, &hdbc1, &hstmt1, NULL,
+                                        NULL, NULL, NULL, ""));
+
+  if (!SQL_SUCCEEDED(SQLGetStmtAttr(hstmt1, SQL_ATTR_MYODBC_STATS_EXECUTIONS,
+                                    &executions, 0, NULL)))
+  {
+    free_basic_handles(&henv1, &hdbc1, &hstmt1);
+    skip("Driver manager does not pass driver-specific attributes");
+  }
+  is_num(executions, 0);
+
+  ok_stmt(hstmt1, SQLBindCol(hstmt1, 1, SQL_C_LONG, &value, 0, NULL));
+  ok_sql(hstmt1, "SELECT 1 UNION ALL SELECT 22 UNION ALL SELECT 333");
+  for (i= 0; i < 3; ++i)
+  {
+    ok_stmt(hstmt1, SQLFetch(hstmt1));
+  }
+  expect_stmt(hstmt1, SQLFetch(hstmt1), SQL_NO_DATA);
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  ok_stmt(hstmt1, SQLGetStmtAttr(hstmt1, SQL_ATTR_MYODBC_STATS_EXECUTIONS,
+                                 &executions, 0, NULL));
+  is_num(executions, 1);
+  ok_stmt(hstmt1, SQLGetStmtAttr(hstmt1, SQL_ATTR_MYODBC_STATS_ROWS_FETCHED,
+                                 &rows, 0, NULL));
+  is_num(rows, 3);
+  ok_stmt(hstmt1, SQLGetStmtAttr(hstmt1, SQL_ATTR_MYODBC_STATS_BYTES_FETCHED,
+                                 &bytes, 0, NULL));
+  is_num(bytes, 6);
+
+  /* Every execution is in one of the latency buckets */
+  executions= 0;
+  for (i= 0; i < 16; ++i)
+  {
+    ok_stmt(hstmt1, SQLGetStmtAttr(hstmt1, SQL_ATTR_MYODBC_STATS_LATENCY + i,
+                                   &latency, 0, NULL));
+    executions+= latency;
+  }
+  is_num(executions, 1);
+
+  /* Counters of freed statements stay with the connection */
+  ok_stmt(hstmt1, SQLFreeHandle(SQL_HANDLE_STMT, hstmt1));
+  ok_con(hdbc1, SQLAllocHandle(SQL_HANDLE_STMT, hdbc1, &hstmt1));
+  ok_sql(hstmt1, "DO 1");
+
+  ok_con(hdbc1, SQLGetConnectAttr(hdbc1, SQL_ATTR_MYODBC_STATS_EXECUTIONS,
+                                  &conn_executions, 0, NULL));
+  is_num(conn_executions, 2);
+  ok_con(hdbc1, SQLGetConnectAttr(hdbc1, SQL_ATTR_MYODBC_STATS_EXECUTIONS +
+                                         SQL_ATTR_MYODBC_STATS_ENV,
+                                  &env_executions, 0, NULL));
+  is(env_executions >= conn_executions);
+
+  free_basic_handles(&henv1, &hdbc1, &hstmt1);
+  return OK;
+}
+
+
+/*
+  SQL_ATTR_ASYNC_ENABLE - functions return SQL_STILL_EXECUTING until the
+  call ends in the background, and then its result
+*/
+DECLARE_TEST(t_async)
+{
+  SQLRETURN rc;
+  SQLINTEGER value;
+  SQLULEN async;
+  int polls= 0;
+
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ASYNC_ENABLE,
+                                (SQLPOINTER)SQL_ASYNC_ENABLE_ON, 0));
+  ok_stmt(hstmt, SQLGetStmtAttr(hstmt, SQL_ATTR_ASYNC_ENABLE, &async, 0,
+                                NULL));
+  is_num(async, SQL_ASYNC_ENABLE_ON);
+
+  while ((rc= SQLExecDirect(hstmt, (SQLCHAR *)"SELECT SLEEP(1), 7",
+                            SQL_NTS)) == SQL_STILL_EXECUTING)
+  {
+    ++polls;
+    msleep(10);
+  }
+  ok_stmt(hstmt, rc);
+  is(polls > 0);
+
+  ok_stmt(hstmt, SQLBindCol(hstmt, 2, SQL_C_LONG, &value, 0, NULL));
+  while ((rc= SQLFetch(hstmt)) == SQL_STILL_EXECUTING)
+  {
+    msleep(10);
+  }
+  ok_stmt(hstmt, rc);
+  is_num(value, 7);
+
+  while ((rc= SQLMoreResults(hstmt)) == SQL_STILL_EXECUTING)
+  {
+    msleep(10);
+  }
+  expect_stmt(hstmt, rc, SQL_NO_DATA);
+
+  /* Prepared statement, and another function called while it runs */
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+  ok_stmt(hstmt, SQLPrepare(hstmt, (SQLCHAR *)"SELECT SLEEP(1)", SQL_NTS));
+  expect_stmt(hstmt, SQLExecute(hstmt), SQL_STILL_EXECUTING);
+  expect_stmt(hstmt, SQLFetch(hstmt), SQL_ERROR);
+  is_num(check_sqlstate(hstmt, "HY010"), OK);
+
+  while ((rc= SQLExecute(hstmt)) == SQL_STILL_EXECUTING)
+  {
+    msleep(10);
+  }
+  ok_stmt(hstmt, rc);
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ASYNC_ENABLE,
+                                (SQLPOINTER)SQL_ASYNC_ENABLE_OFF, 0));
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_UNBIND));
+
+  return OK;
+}
+
+
+/*
+  SQLCancel of a statement waiting for the query of another statement on the
+  connection drops the waiting call, the running query is not killed
+*/
+DECLARE_TEST(t_async_cancel_waiting)
+{
+  SQLHSTMT hstmt2;
+  SQLRETURN rc;
+  SQLINTEGER slept, value;
+
+  ok_con(hdbc, SQLAllocHandle(SQL_HANDLE_STMT, hdbc, &hstmt2));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ASYNC_ENABLE,
+                                (SQLPOINTER)SQL_ASYNC_ENABLE_ON, 0));
+  ok_stmt(hstmt2, SQLSetStmtAttr(hstmt2, SQL_ATTR_ASYNC_ENABLE,
+                                 (SQLPOINTER)SQL_ASYNC_ENABLE_ON, 0));
+
+  expect_stmt(hstmt, SQLExecDirect(hstmt, (SQLCHAR *)"SELECT SLEEP(2), 1",
+                                   SQL_NTS), SQL_STILL_EXECUTING);
+  msleep(300);
+  expect_stmt(hstmt2, SQLExecDirect(hstmt2, (SQLCHAR *)"SELECT 2", SQL_NTS),
+              SQL_STILL_EXECUTING);
+
+  ok_stmt(hstmt2, SQLCancel(hstmt2));
+
+  while ((rc= SQLExecDirect(hstmt2, (SQLCHAR *)"SELECT 2",
+                            SQL_NTS)) == SQL_STILL_EXECUTING)
+  {
+    msleep(10);
+  }
+  expect_stmt(hstmt2, rc, SQL_ERROR);
+  is_num(check_sqlstate(hstmt2, "HY008"), OK);
+
+  /* SLEEP() returns 1 if it was killed */
+  while ((rc= SQLExecDirect(hstmt, (SQLCHAR *)"SELECT SLEEP(2), 1",
+                            SQL_NTS)) == SQL_STILL_EXECUTING)
+  {
+    msleep(10);
+  }
+  ok_stmt(hstmt, rc);
+
+  ok_stmt(hstmt, SQLBindCol(hstmt, 1, SQL_C_LONG, &slept, 0, NULL));
+  ok_stmt(hstmt, SQLBindCol(hstmt, 2, SQL_C_LONG, &value, 0, NULL));
+  while ((rc= SQLFetch(hstmt)) == SQL_STILL_EXECUTING)
+  {
+    msleep(10);
+  }
+  ok_stmt(hstmt, rc);
+  is_num(slept, 0);
+  is_num(value, 1);
+
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ASYNC_ENABLE,
+                                (SQLPOINTER)SQL_ASYNC_ENABLE_OFF, 0));
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_UNBIND));
+  ok_stmt(hstmt2, SQLFreeHandle(SQL_HANDLE_STMT, hstmt2));
+
+  return OK;
+}
+
+
+/*
+  SQL_ATTR_ASYNC_DBC_FUNCTIONS_ENABLE - connections are opened in parallel
+  by the driver, as a pool of them is warmed up
+*/
+DECLARE_TEST(t_async_connect)
+{
+  SQLHDBC hdbcs[8];
+  SQLCHAR conn[512];
+  SQLRETURN rc[8];
+  SQLHSTMT hstmt1;
+  int i, pending;
+
+  sprintf((char *)conn, "DSN=%s;UID=%s;PWD=%s", mydsn, myuid, mypwd);
+  if (mysock != NULL)
+  {
+    strcat((char *)conn, ";SOCKET=");
+    strcat((char *)conn, (char *)mysock);
+  }
+
+  for (i= 0; i < 8; ++i)
+  {
+    ok_env(henv, SQLAllocHandle(SQL_HANDLE_DBC, henv, &hdbcs[i]));
+    ok_con(hdbcs[i], SQLSetConnectAttr(hdbcs[i],
+                                       SQL_ATTR_ASYNC_DBC_FUNCTIONS_ENABLE,
+                                       (SQLPOINTER)SQL_ASYNC_DBC_ENABLE_ON,
+                                       SQL_IS_INTEGER));
+    rc[i]= SQL_STILL_EXECUTING;
+  }
+
+  do
+  {
+    pending= 0;
+    for (i= 0; i < 8; ++i)
+    {
+      if (rc[i] == SQL_STILL_EXECUTING)
+      {
+        rc[i]= SQLDriverConnect(hdbcs[i], NULL, conn, SQL_NTS, NULL, 0, NULL,
+                                SQL_DRIVER_NOPROMPT);
+        pending+= rc[i] == SQL_STILL_EXECUTING;
+      }
+    }
+  } while (pending > 0);
+
+  for (i= 0; i < 8; ++i)
+  {
+    ok_con(hdbcs[i], rc[i]);
+  }
+
+  ok_con(hdbcs[7], SQLAllocHandle(SQL_HANDLE_STMT, hdbcs[7], &hstmt1));
+  ok_sql(hstmt1, "SELECT 1");
+  ok_stmt(hstmt1, SQLFreeHandle(SQL_HANDLE_STMT, hstmt1));
+
+  for (i= 0; i < 8; ++i)
+  {
+    SQLRETURN disconnect;
+
+    while ((disconnect= SQLDisconnect(hdbcs[i])) == SQL_STILL_EXECUTING);
+    ok_con(hdbcs[i], disconnect);
+    ok_con(hdbcs[i], SQLFreeHandle(SQL_HANDLE_DBC, hdbcs[i]));
+  }
+
+  return OK;
+}
+
+
 BEGIN_TESTS
   ADD_TEST(t_tls_opts)
   ADD_TEST(t_ssl_mode)
@@ -1237,6 +1594,11 @@ BEGIN_TESTS
   ADD_TEST(t_bug45378)
   ADD_TEST(t_bug63844)
   ADD_TEST(t_bug52996)
+  ADD_TEST(t_query_log)
+  ADD_TEST(t_stats)
+  ADD_TEST(t_async)
+  ADD_TEST(t_async_cancel_waiting)
+  ADD_TEST(t_async_connect)
   END_TESTS
 
 
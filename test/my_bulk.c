@@ -295,6 +295,137 @@ DECLARE_TEST(t_bulk_insert_rows)
 }
 
 
+/**
+  SQLBulkOperations(SQL_ADD) of a rowset that goes to the server as the
+  parameters of a prepared INSERT, with NULLs and strings of every length.
+  The rowset is added twice, the second time with the handles the first one
+  has left in the statement cache.
+*/
+#define SSPS_BULK_ROWS 1000
+DECLARE_TEST(t_bulk_insert_ssps)
+{
+  DECLARE_BASIC_HANDLES(henv1, hdbc1, hstmt1);
+  SQLINTEGER  id[SSPS_BULK_ROWS], nData;
+  SQLBIGINT   big[SSPS_BULK_ROWS];
+  SQLDOUBLE   dbl[SSPS_BULK_ROWS];
+  SQLCHAR     txt[SSPS_BULK_ROWS][32], buff[32];
+  SQLLEN      id_ind[SSPS_BULK_ROWS], big_ind[SSPS_BULK_ROWS],
+              dbl_ind[SSPS_BULK_ROWS], txt_ind[SSPS_BULK_ROWS];
+  SQLULEN     hits, misses, hits0, misses0;
+  int         i, stats;
+
+  is(OK == alloc_basic_handles_with_opt(&henv1, &hdbc1, &hstmt1, NULL,
+                                        NULL, NULL, NULL,
+                                        "STMT_CACHE_SIZE=4"));
+
+  ok_sql(hstmt1, "DROP TABLE IF EXISTS my_bulk");
+  ok_sql(hstmt1, "CREATE TABLE my_bulk (id INT, big BIGINT, dbl DOUBLE, "
+                 "txt VARCHAR(32))");
+
+  ok_stmt(hstmt1, SQLSetStmtAttr(hstmt1, SQL_ATTR_CURSOR_TYPE,
+                                 (SQLPOINTER)SQL_CURSOR_STATIC, 0));
+  ok_stmt(hstmt1, SQLSetStmtAttr(hstmt1, SQL_ATTR_ROW_ARRAY_SIZE,
+                                 (SQLPOINTER)SSPS_BULK_ROWS, 0));
+
+  ok_stmt(hstmt1, SQLBindCol(hstmt1, 1, SQL_C_LONG, id, 0, id_ind));
+  ok_stmt(hstmt1, SQLBindCol(hstmt1, 2, SQL_C_SBIGINT, big, 0, big_ind));
+  ok_stmt(hstmt1, SQLBindCol(hstmt1, 3, SQL_C_DOUBLE, dbl, 0, dbl_ind));
+  ok_stmt(hstmt1, SQLBindCol(hstmt1, 4, SQL_C_CHAR, txt, sizeof(txt[0]),
+                             txt_ind));
+
+  ok_sql(hstmt1, "SELECT id, big, dbl, txt FROM my_bulk");
+
+  expect_stmt(hstmt1, SQLFetchScroll(hstmt1, SQL_FETCH_NEXT, 0),
+              SQL_NO_DATA_FOUND);
+
+  for (i= 0; i < SSPS_BULK_ROWS; ++i)
+  {
+    id[i]= i; id_ind[i]= 0;
+    big[i]= (SQLBIGINT)i * 10000000000LL; big_ind[i]= 0;
+    dbl[i]= i + 0.5; dbl_ind[i]= i % 7 ? 0 : SQL_NULL_DATA;
+    sprintf((char *)txt[i], "row '%d'", i);
+    txt_ind[i]= i % 2 ? SQL_NTS : (SQLLEN)strlen((char *)txt[i]);
+  }
+  txt_ind[SSPS_BULK_ROWS - 1]= SQL_NULL_DATA;
+
+  /* Driver manager may not pass driver-specific attributes */
+  stats= SQL_SUCCEEDED(SQLGetConnectAttr(hdbc1,
+                                         SQL_ATTR_MYODBC_STMT_CACHE_HITS,
+                                         &hits0, 0, NULL)) &&
+         SQL_SUCCEEDED(SQLGetConnectAttr(hdbc1,
+                                         SQL_ATTR_MYODBC_STMT_CACHE_MISSES,
+                                         &misses0, 0, NULL));
+
+  ok_stmt(hstmt1, SQLBulkOperations(hstmt1, SQL_ADD));
+
+  /* The INSERTs have been prepared and went to the cache */
+  if (stats)
+  {
+    ok_con(hdbc1, SQLGetConnectAttr(hdbc1, SQL_ATTR_MYODBC_STMT_CACHE_HITS,
+                                    &hits, 0, NULL));
+    ok_con(hdbc1, SQLGetConnectAttr(hdbc1,
+                                    SQL_ATTR_MYODBC_STMT_CACHE_MISSES,
+                                    &misses, 0, NULL));
+    is_num(hits, hits0);
+    is(misses > misses0);
+    hits0= hits;
+    misses0= misses;
+  }
+
+  ok_stmt(hstmt1, SQLBulkOperations(hstmt1, SQL_ADD));
+
+  /* and are executed again without a prepare */
+  if (stats)
+  {
+    ok_con(hdbc1, SQLGetConnectAttr(hdbc1, SQL_ATTR_MYODBC_STMT_CACHE_HITS,
+                                    &hits, 0, NULL));
+    ok_con(hdbc1, SQLGetConnectAttr(hdbc1,
+                                    SQL_ATTR_MYODBC_STMT_CACHE_MISSES,
+                                    &misses, 0, NULL));
+    is(hits > hits0);
+    is_num(misses, misses0);
+  }
+
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_UNBIND));
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+  ok_stmt(hstmt1, SQLSetStmtAttr(hstmt1, SQL_ATTR_ROW_ARRAY_SIZE,
+                                 (SQLPOINTER)1, 0));
+
+  ok_sql(hstmt1, "SELECT COUNT(*), SUM(id), COUNT(dbl), COUNT(txt) "
+                 "FROM my_bulk WHERE big = id * 10000000000 AND "
+                 "(dbl IS NULL OR dbl = id + 0.5)");
+  ok_stmt(hstmt1, SQLFetch(hstmt1));
+  is_num(my_fetch_int(hstmt1, 1), 2 * SSPS_BULK_ROWS);
+  is_num(my_fetch_int(hstmt1, 2), SSPS_BULK_ROWS * (SSPS_BULK_ROWS - 1));
+  is_num(my_fetch_int(hstmt1, 3),
+         2 * (SSPS_BULK_ROWS - (SSPS_BULK_ROWS + 6) / 7));
+  is_num(my_fetch_int(hstmt1, 4), 2 * (SSPS_BULK_ROWS - 1));
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  ok_sql(hstmt1, "SELECT DISTINCT id, txt FROM my_bulk WHERE id IN (2, 3) "
+                 "ORDER BY id");
+  ok_stmt(hstmt1, SQLBindCol(hstmt1, 1, SQL_C_LONG, &nData, 0, NULL));
+  ok_stmt(hstmt1, SQLBindCol(hstmt1, 2, SQL_C_CHAR, buff, sizeof(buff),
+                             NULL));
+  ok_stmt(hstmt1, SQLFetch(hstmt1));
+  is_num(nData, 2);
+  is_str(buff, "row '2'", 8);
+  ok_stmt(hstmt1, SQLFetch(hstmt1));
+  is_num(nData, 3);
+  is_str(buff, "row '3'", 8);
+  expect_stmt(hstmt1, SQLFetch(hstmt1), SQL_NO_DATA_FOUND);
+
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_UNBIND));
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  ok_sql(hstmt1, "DROP TABLE IF EXISTS my_bulk");
+
+  free_basic_handles(&henv1, &hdbc1, &hstmt1);
+
+  return OK;
+}
+
+
 DECLARE_TEST(t_bulk_insert_bookmark)
 {
   SQLINTEGER i, id[MAX_BM_INS_COUNT + 1];
@@ -606,6 +737,7 @@ BEGIN_TESTS
   ADD_TEST(t_mul_pkdel)
   ADD_TEST(t_bulk_insert_indicator)
   ADD_TEST(t_bulk_insert_rows)
+  ADD_TEST(t_bulk_insert_ssps)
   ADD_TEST(t_bulk_insert_bookmark)
   // ADD_TEST(t_bookmark_update) TODO: Fix
   // ADD_TEST(t_bookmark_delete) TODO: Fix
@@ -1552,6 +1552,184 @@ DECLARE_TEST(t_bug39957)
 }
 
 
+/*
+  Catalog function results are reused with CATALOG_CACHE_TTL, until the
+  connection executes DDL
+*/
+DECLARE_TEST(t_catalog_cache)
+{
+  DECLARE_BASIC_HANDLES(henv1, hdbc1, hstmt1);
+
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_catalog_cache");
+  ok_sql(hstmt, "CREATE TABLE t_catalog_cache (a INT, b INT)");
+
+  is(OK == alloc_basic_handles_with_opt(&henv1, &hdbc1, &hstmt1, NULL,
+                                        NULL, NULL, NULL,
+                                        "CATALOG_CACHE_TTL=600;"
+                                        "MULTI_STATEMENTS=1"));
+
+  ok_stmt(hstmt1, SQLColumns(hstmt1, NULL, 0, NULL, 0,
+                             (SQLCHAR *)"t_catalog_cache", SQL_NTS, NULL, 0));
+  is_num(myrowcount(hstmt1), 2);
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  /* Changed by another connection, the cached result is still returned */
+  ok_sql(hstmt, "ALTER TABLE t_catalog_cache ADD c INT");
+
+  ok_stmt(hstmt1, SQLColumns(hstmt1, NULL, 0, NULL, 0,
+                             (SQLCHAR *)"t_catalog_cache", SQL_NTS, NULL, 0));
+  is_num(myrowcount(hstmt1), 2);
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  /* DDL going through the connection empties the cache */
+  ok_sql(hstmt1, "ALTER TABLE t_catalog_cache ADD d INT");
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  ok_stmt(hstmt1, SQLColumns(hstmt1, NULL, 0, NULL, 0,
+                             (SQLCHAR *)"t_catalog_cache", SQL_NTS, NULL, 0));
+  is_num(myrowcount(hstmt1), 4);
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  /* So does DDL that is not the first statement of a batch */
+  ok_sql(hstmt1, "SELECT 1; ALTER TABLE t_catalog_cache ADD e INT");
+  while (SQLMoreResults(hstmt1) == SQL_SUCCESS);
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  ok_stmt(hstmt1, SQLColumns(hstmt1, NULL, 0, NULL, 0,
+                             (SQLCHAR *)"t_catalog_cache", SQL_NTS, NULL, 0));
+  is_num(myrowcount(hstmt1), 5);
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  free_basic_handles(&henv1, &hdbc1, &hstmt1);
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_catalog_cache");
+
+  return OK;
+}
+
+
+/* More than the driver asks for in one request */
+#define COLUMNS_BATCH_TABLES 70
+
+/*
+  Checks columns b1 and b2 of every t_columns_batchNN table, only b2 of the
+  table with the number restricted.
+*/
+static int check_columns_batch(SQLHSTMT hstmt, int restricted)
+{
+  SQLCHAR buff[255], name[32], def[16];
+  int i;
+
+  ok_stmt(hstmt, SQLColumns(hstmt, NULL, 0, NULL, 0,
+                            (SQLCHAR *)"t_columns_batch%", SQL_NTS,
+                            (SQLCHAR *)"b%", SQL_NTS));
+
+  for (i= 0; i < COLUMNS_BATCH_TABLES; ++i)
+  {
+    sprintf((char *)name, "t_columns_batch%02d", i);
+
+    if (i != restricted)
+    {
+      ok_stmt(hstmt, SQLFetch(hstmt));
+      is_str(my_fetch_str(hstmt, buff, 3), name, strlen((char *)name));
+      is_str(my_fetch_str(hstmt, buff, 4), "b1", 2);
+      sprintf((char *)def, "%d", i);
+      is_str(my_fetch_str(hstmt, buff, 13), def, strlen((char *)def));
+    }
+
+    ok_stmt(hstmt, SQLFetch(hstmt));
+    is_str(my_fetch_str(hstmt, buff, 3), name, strlen((char *)name));
+    is_str(my_fetch_str(hstmt, buff, 4), "b2", 2);
+    is_str(my_fetch_str(hstmt, buff, 13), "'x'", 3);
+  }
+
+  expect_stmt(hstmt, SQLFetch(hstmt), SQL_NO_DATA);
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+
+  return OK;
+}
+
+
+/*
+  SQLColumns over many tables with a column pattern, which gets the
+  columns of the tables in batches. An invalid view is skipped, and a table
+  the user can read some columns of only is listed with them.
+*/
+DECLARE_TEST(t_columns_batch)
+{
+  DECLARE_BASIC_HANDLES(henv1, hdbc1, hstmt1);
+  SQLCHAR buff[255], query[255];
+  int i;
+
+  for (i= 0; i < COLUMNS_BATCH_TABLES; ++i)
+  {
+    sprintf((char *)query, "DROP TABLE IF EXISTS t_columns_batch%02d", i);
+    ok_stmt(hstmt, SQLExecDirect(hstmt, query, SQL_NTS));
+    sprintf((char *)query, "CREATE TABLE t_columns_batch%02d (a INT,"
+            " b1 INT DEFAULT %d, c INT, b2 VARCHAR(10) DEFAULT 'x')", i, i);
+    ok_stmt(hstmt, SQLExecDirect(hstmt, query, SQL_NTS));
+  }
+
+  /* Invalid view between the tables is skipped, not failing the rest */
+  ok_sql(hstmt, "DROP VIEW IF EXISTS t_columns_batch00v");
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_columns_batch_base");
+  ok_sql(hstmt, "CREATE TABLE t_columns_batch_base (b INT)");
+  ok_sql(hstmt, "CREATE VIEW t_columns_batch00v AS "
+                "SELECT b FROM t_columns_batch_base");
+  ok_sql(hstmt, "DROP TABLE t_columns_batch_base");
+
+  is(OK == check_columns_batch(hstmt, -1));
+
+  /* Table in the 2nd batch the user can SELECT only b2 of */
+  (void)SQLExecDirect(hstmt, (SQLCHAR *)"DROP USER t_colbatch", SQL_NTS);
+  ok_sql(hstmt, "CREATE USER t_colbatch IDENTIFIED BY 'foo'");
+
+  for (i= 0; i < COLUMNS_BATCH_TABLES; ++i)
+  {
+    sprintf((char *)query, i == 65 ? "GRANT SELECT(b2) ON t_columns_batch%02d "
+                                     "TO t_colbatch"
+                                   : "GRANT SELECT ON t_columns_batch%02d "
+                                     "TO t_colbatch", i);
+    ok_stmt(hstmt, SQLExecDirect(hstmt, query, SQL_NTS));
+  }
+
+  is(OK == alloc_basic_handles_with_opt(&henv1, &hdbc1, &hstmt1, NULL,
+                                        (SQLCHAR *)"t_colbatch",
+                                        (SQLCHAR *)"foo", NULL, NULL));
+  is(OK == check_columns_batch(hstmt1, 65));
+  free_basic_handles(&henv1, &hdbc1, &hstmt1);
+
+  ok_sql(hstmt, "DROP USER t_colbatch");
+  ok_sql(hstmt, "DROP VIEW IF EXISTS t_columns_batch00v");
+  for (i= 0; i < COLUMNS_BATCH_TABLES; ++i)
+  {
+    sprintf((char *)query, "DROP TABLE IF EXISTS t_columns_batch%02d", i);
+    ok_stmt(hstmt, SQLExecDirect(hstmt, query, SQL_NTS));
+  }
+
+  /* Escaped wildcard of the column pattern matches only itself */
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_colbatch_esc");
+  ok_sql(hstmt, "CREATE TABLE t_colbatch_esc (b_1 INT, bx1 INT)");
+
+  ok_stmt(hstmt, SQLColumns(hstmt, NULL, 0, NULL, 0,
+                            (SQLCHAR *)"t_colbatch_esc", SQL_NTS,
+                            (SQLCHAR *)"b_1", SQL_NTS));
+  is_num(myrowcount(hstmt), 2);
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+
+  ok_stmt(hstmt, SQLColumns(hstmt, NULL, 0, NULL, 0,
+                            (SQLCHAR *)"t_colbatch_esc", SQL_NTS,
+                            (SQLCHAR *)"b\\_1", SQL_NTS));
+  ok_stmt(hstmt, SQLFetch(hstmt));
+  is_str(my_fetch_str(hstmt, buff, 4), "b_1", 3);
+  expect_stmt(hstmt, SQLFetch(hstmt), SQL_NO_DATA);
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_colbatch_esc");
+
+  return OK;
+}
+
+
 BEGIN_TESTS
   ADD_TEST(my_columns_null)
   ADD_TEST(my_drop_table)
@@ -1586,6 +1764,8 @@ BEGIN_TESTS
   // ADD_TEST(t_bug30770) TODO: Fix NO_IS
   ADD_TEST(t_bug36275)
   ADD_TEST(t_bug39957)
+  ADD_TEST(t_catalog_cache)
+  ADD_TEST(t_columns_batch)
 END_TESTS
 
 myoption &= ~(1 << 30);
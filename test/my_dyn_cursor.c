@@ -719,6 +719,158 @@ DECLARE_TEST(my_dynamic_cursor)
 }
 
 
+/*
+  Dynamic cursor over a table with a primary key is keyset-driven: it reads
+  the rowset again by the key on every fetch, and reports rows changed and
+  deleted since.
+*/
+DECLARE_TEST(my_dynamic_keyset)
+{
+  SQLHSTMT     hstmt1;
+  SQLINTEGER   id[4];
+  SQLBIGINT    big_id[4];
+  SQLCHAR      name[4][16];
+  SQLLEN       name_len[4];
+  SQLUSMALLINT status[4];
+  SQLULEN      fetched;
+  SQLUINTEGER  cursor_type;
+
+  ok_sql(hstmt, "DROP TABLE IF EXISTS my_dynamic_keyset");
+  ok_sql(hstmt, "CREATE TABLE my_dynamic_keyset (id INT PRIMARY KEY, "
+                "name VARCHAR(15))");
+  ok_sql(hstmt, "INSERT INTO my_dynamic_keyset VALUES (1,'one'),(2,'two'),"
+                "(3,'three'),(4,'four'),(5,'five'),(6,'six')");
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+
+  ok_con(hdbc, SQLAllocHandle(SQL_HANDLE_STMT, hdbc, &hstmt1));
+
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_CURSOR_TYPE,
+                                (SQLPOINTER)SQL_CURSOR_DYNAMIC, 0));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_ARRAY_SIZE,
+                                (SQLPOINTER)4, 0));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_STATUS_PTR, status, 0));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROWS_FETCHED_PTR, &fetched,
+                                0));
+
+  /* The cursor is reported as keyset-driven */
+  expect_sql(hstmt, "SELECT id, name FROM my_dynamic_keyset ORDER BY id",
+             SQL_SUCCESS_WITH_INFO);
+  is_num(check_sqlstate(hstmt, "01S02"), OK);
+  ok_stmt(hstmt, SQLGetStmtAttr(hstmt, SQL_ATTR_CURSOR_TYPE, &cursor_type,
+                                0, NULL));
+  is_num(cursor_type, SQL_CURSOR_KEYSET_DRIVEN);
+
+  ok_stmt(hstmt, SQLBindCol(hstmt, 1, SQL_C_LONG, id, 0, NULL));
+  ok_stmt(hstmt, SQLBindCol(hstmt, 2, SQL_C_CHAR, name, sizeof(name[0]),
+                            name_len));
+
+  ok_stmt(hstmt, SQLFetchScroll(hstmt, SQL_FETCH_NEXT, 0));
+  is_num(fetched, 4);
+  is_num(status[1], SQL_ROW_SUCCESS);
+  is_str(name[1], "two", 4);
+
+  ok_sql(hstmt1, "UPDATE my_dynamic_keyset SET name='TWO' WHERE id = 2");
+  ok_sql(hstmt1, "DELETE FROM my_dynamic_keyset WHERE id = 3");
+
+  ok_stmt(hstmt, SQLFetchScroll(hstmt, SQL_FETCH_FIRST, 0));
+  is_num(fetched, 4);
+  is_num(status[0], SQL_ROW_SUCCESS);
+  is_num(id[0], 1);
+  is_num(status[1], SQL_ROW_UPDATED);
+  is_num(id[1], 2);
+  is_str(name[1], "TWO", 4);
+  is_num(name_len[1], 3);
+  is_num(status[2], SQL_ROW_DELETED);
+  is_num(status[3], SQL_ROW_SUCCESS);
+  is_num(id[3], 4);
+
+  ok_stmt(hstmt, SQLFetchScroll(hstmt, SQL_FETCH_NEXT, 0));
+  is_num(fetched, 2);
+  is_num(id[0], 5);
+  is_num(id[1], 6);
+  is_num(status[2], SQL_ROW_NOROW);
+
+  expect_stmt(hstmt, SQLFetchScroll(hstmt, SQL_FETCH_NEXT, 0), SQL_NO_DATA);
+
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_UNBIND));
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+
+  /* Key values are compared with the collation of the key, so a key
+     changed only in case still finds its row */
+  ok_sql(hstmt, "DROP TABLE IF EXISTS my_dynamic_keyset");
+  ok_sql(hstmt, "CREATE TABLE my_dynamic_keyset (name VARCHAR(15) "
+                "COLLATE latin1_general_ci PRIMARY KEY, id INT) "
+                "CHARSET latin1");
+  ok_sql(hstmt, "INSERT INTO my_dynamic_keyset VALUES ('one',1),('two',2)");
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+
+  ok_sql(hstmt, "SELECT name, id FROM my_dynamic_keyset ORDER BY id");
+  ok_stmt(hstmt, SQLBindCol(hstmt, 1, SQL_C_CHAR, name, sizeof(name[0]),
+                            name_len));
+  ok_stmt(hstmt, SQLBindCol(hstmt, 2, SQL_C_LONG, id, 0, NULL));
+
+  ok_stmt(hstmt, SQLFetchScroll(hstmt, SQL_FETCH_NEXT, 0));
+  is_num(fetched, 2);
+
+  ok_sql(hstmt1, "UPDATE my_dynamic_keyset SET name='ONE' WHERE id = 1");
+
+  ok_stmt(hstmt, SQLFetchScroll(hstmt, SQL_FETCH_FIRST, 0));
+  is_num(fetched, 2);
+  is_num(status[0], SQL_ROW_UPDATED);
+  is_str(name[0], "ONE", 4);
+  is_num(id[0], 1);
+  is_num(status[1], SQL_ROW_SUCCESS);
+  is_str(name[1], "two", 4);
+
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_UNBIND));
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+
+  /* BIGINT keys past 2^53 are not compared as doubles, each row of the
+     rowset is found by its own key */
+  ok_sql(hstmt, "DROP TABLE IF EXISTS my_dynamic_keyset");
+  ok_sql(hstmt, "CREATE TABLE my_dynamic_keyset (id BIGINT PRIMARY KEY, "
+                "name VARCHAR(15))");
+  ok_sql(hstmt, "INSERT INTO my_dynamic_keyset VALUES "
+                "(9007199254740992,'a'),(9007199254740993,'b'),"
+                "(9007199254740994,'c')");
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+
+  ok_sql(hstmt, "SELECT id, name FROM my_dynamic_keyset ORDER BY id");
+  ok_stmt(hstmt, SQLBindCol(hstmt, 1, SQL_C_SBIGINT, big_id, 0, NULL));
+  ok_stmt(hstmt, SQLBindCol(hstmt, 2, SQL_C_CHAR, name, sizeof(name[0]),
+                            name_len));
+
+  ok_stmt(hstmt, SQLFetchScroll(hstmt, SQL_FETCH_NEXT, 0));
+  is_num(fetched, 3);
+
+  ok_sql(hstmt1, "DELETE FROM my_dynamic_keyset WHERE id = 9007199254740992");
+  ok_sql(hstmt1, "UPDATE my_dynamic_keyset SET name='B' "
+                 "WHERE id = 9007199254740993");
+
+  ok_stmt(hstmt, SQLFetchScroll(hstmt, SQL_FETCH_FIRST, 0));
+  is_num(fetched, 3);
+  is_num(status[0], SQL_ROW_DELETED);
+  is_num(status[1], SQL_ROW_UPDATED);
+  is_num(big_id[1], 9007199254740993LL);
+  is_str(name[1], "B", 2);
+  is_num(status[2], SQL_ROW_SUCCESS);
+  is_num(big_id[2], 9007199254740994LL);
+  is_str(name[2], "c", 2);
+
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_UNBIND));
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_STATUS_PTR, NULL, 0));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROWS_FETCHED_PTR, NULL, 0));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_ARRAY_SIZE,
+                                (SQLPOINTER)1, 0));
+  ok_stmt(hstmt1, SQLFreeHandle(SQL_HANDLE_STMT, hstmt1));
+
+  ok_sql(hstmt, "DROP TABLE IF EXISTS my_dynamic_keyset");
+
+  return OK;
+}
+
+
 BEGIN_TESTS
   ADD_TEST(my_dynamic_pos_cursor)
   ADD_TEST(my_dynamic_pos_cursor1)
@@ -729,6 +881,7 @@ BEGIN_TESTS
 #ifndef USE_IODBC
   ADD_TEST(my_dynamic_cursor)
 #endif
+  ADD_TEST(my_dynamic_keyset)
   END_TESTS
 
 SET_DSN_OPTION(35);
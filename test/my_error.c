@@ -400,10 +400,9 @@ DECLARE_TEST(t_handle_err)
                                   (SQLPOINTER)SQL_OV_ODBC3, 0), SQL_ERROR);
   is_num(check_sqlstate_ex(henv1, SQL_HANDLE_ENV, "HY010"), OK);
 
-  expect_dbc(hdbc1, SQLSetConnectAttr(hdbc1, SQL_ATTR_ASYNC_ENABLE,
-                                      (SQLPOINTER)SQL_ASYNC_ENABLE_ON,
-                                      SQL_IS_INTEGER), SQL_SUCCESS_WITH_INFO);
-  is_num(check_sqlstate_ex(hdbc1, SQL_HANDLE_DBC, "01S02"), OK);
+  ok_con(hdbc1, SQLSetConnectAttr(hdbc1, SQL_ATTR_ASYNC_ENABLE,
+                                  (SQLPOINTER)SQL_ASYNC_ENABLE_ON,
+                                  SQL_IS_INTEGER));
 
   ok_con(hdbc1, SQLDisconnect(hdbc1));
   ok_con(hdbc1, SQLFreeHandle(SQL_HANDLE_DBC, hdbc1));
@@ -812,6 +811,65 @@ DECLARE_TEST(t_bug25671389)
   return OK;
 }
 
+/* Waits until the monitor has pinged the connection once more */
+static int wait_liveness_ping(SQLHDBC hdbc1)
+{
+  SQLULEN pings, start;
+  int i;
+
+  ok_con(hdbc1, SQLGetConnectAttr(hdbc1, SQL_ATTR_MYODBC_LIVENESS_PINGS,
+                                  &start, 0, NULL));
+  for (i= 0; i < 300; ++i)
+  {
+    msleep(100);
+    ok_con(hdbc1, SQLGetConnectAttr(hdbc1, SQL_ATTR_MYODBC_LIVENESS_PINGS,
+                                    &pings, 0, NULL));
+    if (pings > start)
+      return OK;
+  }
+
+  printMessage("The monitor didn't ping the connection in 30 seconds");
+  return FAIL;
+}
+
+/*
+  The environment's monitor pings idle connections opened with
+  LIVENESS_INTERVAL and the next statement reports the lost server
+  without pinging it itself.
+*/
+DECLARE_TEST(t_liveness_monitor)
+{
+  DECLARE_BASIC_HANDLES(henv1, hdbc1, hstmt1);
+  SQLINTEGER connection_id;
+  SQLCHAR buf[255];
+
+  is(OK == alloc_basic_handles_with_opt(&henv1, &hdbc1, &hstmt1, NULL,
+                                        NULL, NULL, NULL,
+                                        "LIVENESS_INTERVAL=1"));
+
+  ok_sql(hstmt1, "SELECT connection_id()");
+  ok_stmt(hstmt1, SQLFetch(hstmt1));
+  connection_id= my_fetch_int(hstmt1, 1);
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  /* Healthy connection stays usable after being checked in background */
+  is(OK == wait_liveness_ping(hdbc1));
+  ok_sql(hstmt1, "SELECT 1");
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  snprintf((char *)buf, sizeof(buf), "KILL %d", connection_id);
+  ok_stmt(hstmt, SQLExecDirect(hstmt, buf, SQL_NTS));
+
+  /* The KILL may not have closed the connection yet, so let the monitor
+     find it gone rather than count on any single ping */
+  is(OK == wait_liveness_ping(hdbc1));
+  is(OK == wait_liveness_ping(hdbc1));
+  expect_sql(hstmt1, "SELECT 1", SQL_ERROR);
+  is_num(check_sqlstate(hstmt1, "08S01"), OK);
+
+  free_basic_handles(&henv1, &hdbc1, &hstmt1);
+  return OK;
+}
 
 BEGIN_TESTS
 #ifndef NO_DRIVERMANAGER
@@ -830,6 +888,7 @@ BEGIN_TESTS
   ADD_TEST(t_bug3456)
   ADD_TEST(t_bug16224)
   ADD_TEST(t_bug25671389)
+  ADD_TEST(t_liveness_monitor)
 #ifndef USE_IODBC
   ADD_TEST(bind_invalidcol)
   ADD_TEST(t_handle_err)
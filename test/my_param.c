@@ -856,6 +856,156 @@ DECLARE_TEST(t_bug56804)
 #undef PARAMSET_SIZE
 }
 
+/*
+  BATCH_PARAMS option - paramsets are sent as multi-row INSERT, or as
+  multi-statement batch for other DML. Statuses and diagnostics should be
+  the same as without batching.
+*/
+DECLARE_TEST(t_batch_params)
+{
+#define PARAMSET_SIZE		10
+  DECLARE_BASIC_HANDLES(henv1, hdbc1, hstmt1);
+  SQLINTEGER	c1[PARAMSET_SIZE]=      {0, 1, 2, 3, 4, 5, 1, 7, 8, 9};
+  SQLINTEGER	c2[PARAMSET_SIZE]=      {9, 8, 7, 6, 5, 4, 3, 2, 1, 0};
+  SQLUSMALLINT status[PARAMSET_SIZE];
+  SQLULEN     processed;
+  SQLLEN      rowCount;
+  int i;
+
+  is(OK == alloc_basic_handles_with_opt(&henv1, &hdbc1, &hstmt1, NULL,
+                                        NULL, NULL, NULL,
+                                        "BATCH_PARAMS=1;MULTI_STATEMENTS=1"));
+
+  ok_sql(hstmt1, "DROP TABLE IF EXISTS t_batch_params");
+  ok_sql(hstmt1, "CREATE TABLE t_batch_params (c1 int primary key not null, "
+                 "c2 int) ENGINE=InnoDB");
+  ok_sql(hstmt1, "INSERT INTO t_batch_params VALUES (1, 1), (9, 9009)");
+
+  ok_stmt(hstmt1, SQLSetStmtAttr(hstmt1, SQL_ATTR_PARAMSET_SIZE,
+                                 (SQLPOINTER)PARAMSET_SIZE, 0));
+  ok_stmt(hstmt1, SQLSetStmtAttr(hstmt1, SQL_ATTR_PARAM_STATUS_PTR,
+                                 status, 0));
+  ok_stmt(hstmt1, SQLSetStmtAttr(hstmt1, SQL_ATTR_PARAMS_PROCESSED_PTR,
+                                 &processed, 0));
+
+  ok_stmt(hstmt1, SQLBindParameter(hstmt1, 1, SQL_PARAM_INPUT, SQL_C_SLONG,
+                                   SQL_INTEGER, 0, 0, c1, 0, NULL));
+  ok_stmt(hstmt1, SQLBindParameter(hstmt1, 2, SQL_PARAM_INPUT, SQL_C_SLONG,
+                                   SQL_INTEGER, 0, 0, c2, 0, NULL));
+
+  /* Multi-row insert fails and paramsets are re-executed one by one */
+  expect_stmt(hstmt1, SQLExecDirect(hstmt1, "INSERT INTO t_batch_params "
+                                    "VALUES (?, ?)", SQL_NTS),
+              SQL_SUCCESS_WITH_INFO);
+
+  is_num(processed, PARAMSET_SIZE);
+
+  for (i= 0; i < PARAMSET_SIZE; ++i)
+  {
+    switch (i)
+    {
+    case 1:
+    case 6:
+      is_num(status[i], SQL_PARAM_DIAG_UNAVAILABLE);
+      break;
+    case 9:
+      is_num(status[i], SQL_PARAM_ERROR);
+      break;
+    default:
+      is_num(status[i], SQL_PARAM_SUCCESS);
+    }
+  }
+
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  /* All paramsets succeed - one multi-row insert */
+  for (i= 0; i < PARAMSET_SIZE; ++i)
+  {
+    c1[i]= 100 + i;
+  }
+
+  ok_stmt(hstmt1, SQLExecDirect(hstmt1, "INSERT INTO t_batch_params "
+                                "VALUES (?, ?)", SQL_NTS));
+  ok_stmt(hstmt1, SQLRowCount(hstmt1, &rowCount));
+  is_num(rowCount, PARAMSET_SIZE);
+
+  for (i= 0; i < PARAMSET_SIZE; ++i)
+  {
+    is_num(status[i], SQL_PARAM_SUCCESS);
+  }
+
+  /* Duplicates ignored with warnings - the multi-row insert succeeds with
+     info for all its paramsets */
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+  expect_stmt(hstmt1, SQLExecDirect(hstmt1, "INSERT IGNORE INTO "
+                                    "t_batch_params VALUES (?, ?)", SQL_NTS),
+              SQL_SUCCESS_WITH_INFO);
+
+  for (i= 0; i < PARAMSET_SIZE; ++i)
+  {
+    is_num(status[i], SQL_PARAM_SUCCESS_WITH_INFO);
+  }
+
+  /* UPDATE is sent as multi-statement batch. 5th paramset fails, the rest
+     of the batch is re-sent */
+  for (i= 0; i < PARAMSET_SIZE; ++i)
+  {
+    c1[i]= 200 + i;
+    c2[i]= 100 + i;
+  }
+  c1[4]= 201;
+
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+  expect_stmt(hstmt1, SQLExecDirect(hstmt1, "UPDATE t_batch_params "
+                                    "SET c1= ? WHERE c1= ?", SQL_NTS),
+              SQL_SUCCESS_WITH_INFO);
+  ok_stmt(hstmt1, SQLRowCount(hstmt1, &rowCount));
+  is_num(rowCount, PARAMSET_SIZE - 1);
+
+  for (i= 0; i < PARAMSET_SIZE; ++i)
+  {
+    is_num(status[i], i == 4 ? SQL_PARAM_ERROR : SQL_PARAM_SUCCESS);
+  }
+  is_num(processed, PARAMSET_SIZE);
+
+  /* Comment after the separator does not make the query a batch, it is
+     still one multi-row insert */
+  for (i= 0; i < PARAMSET_SIZE; ++i)
+  {
+    c1[i]= 300 + i;
+  }
+
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+  ok_stmt(hstmt1, SQLExecDirect(hstmt1, "INSERT INTO t_batch_params "
+                                "VALUES (?, ?); -- trailing comment",
+                                SQL_NTS));
+  ok_stmt(hstmt1, SQLRowCount(hstmt1, &rowCount));
+  is_num(rowCount, PARAMSET_SIZE);
+  is_num(processed, PARAMSET_SIZE);
+
+  for (i= 0; i < PARAMSET_SIZE; ++i)
+  {
+    is_num(status[i], SQL_PARAM_SUCCESS);
+  }
+
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+  ok_stmt(hstmt1, SQLSetStmtAttr(hstmt1, SQL_ATTR_PARAMSET_SIZE,
+                                 (SQLPOINTER)1, 0));
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_RESET_PARAMS));
+
+  ok_sql(hstmt1, "SELECT COUNT(*) FROM t_batch_params "
+                 "WHERE c1 BETWEEN 200 AND 299");
+  ok_stmt(hstmt1, SQLFetch(hstmt1));
+  is_num(my_fetch_int(hstmt1, 1), PARAMSET_SIZE - 1);
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  ok_sql(hstmt1, "DROP TABLE IF EXISTS t_batch_params");
+  free_basic_handles(&henv1, &hdbc1, &hstmt1);
+
+  return OK;
+#undef PARAMSET_SIZE
+}
+
 
 /*
   Bug 59772 - Column parameter binding makes SQLExecute not to return
@@ -1699,6 +1849,188 @@ DECLARE_TEST(t_inoutstream17842966)
 
 #endif /* #ifndef USE_IODBC */
 
+/*
+  Queries with parameter values are built in a buffer of the statement,
+  statements of one connection must not overwrite each other's queries
+*/
+DECLARE_TEST(t_param_stmt_buffers)
+{
+  DECLARE_BASIC_HANDLES(henv1, hdbc1, hstmt1);
+  SQLHSTMT hstmt2;
+  SQLINTEGER params[3]= {1, 2, 3}, param2= 7, i;
+  SQLULEN lock_waits;
+
+  is(OK == alloc_basic_handles_with_opt(&henv1, &hdbc1, &hstmt1, NULL,
+                                        NULL, NULL, NULL, "NO_SSPS=1"));
+  ok_con(hdbc1, SQLAllocHandle(SQL_HANDLE_STMT, hdbc1, &hstmt2));
+
+  ok_stmt(hstmt1, SQLSetStmtAttr(hstmt1, SQL_ATTR_PARAMSET_SIZE,
+                                 (SQLPOINTER)3, 0));
+  ok_stmt(hstmt1, SQLPrepare(hstmt1, "SELECT ?", SQL_NTS));
+  ok_stmt(hstmt1, SQLBindParameter(hstmt1, 1, SQL_PARAM_INPUT, SQL_C_LONG,
+                                   SQL_INTEGER, 0, 0, params, 0, NULL));
+
+  ok_stmt(hstmt2, SQLPrepare(hstmt2, "SELECT ? + 10", SQL_NTS));
+  ok_stmt(hstmt2, SQLBindParameter(hstmt2, 1, SQL_PARAM_INPUT, SQL_C_LONG,
+                                   SQL_INTEGER, 0, 0, &param2, 0, NULL));
+
+  /* Parameter sets of the SELECT are put together with UNION ALL */
+  ok_stmt(hstmt1, SQLExecute(hstmt1));
+  ok_stmt(hstmt2, SQLExecute(hstmt2));
+
+  ok_stmt(hstmt2, SQLFetch(hstmt2));
+  is_num(my_fetch_int(hstmt2, 1), 17);
+  ok_stmt(hstmt2, SQLFreeStmt(hstmt2, SQL_CLOSE));
+
+  for (i= 0; i < 3; ++i)
+  {
+    ok_stmt(hstmt1, SQLFetch(hstmt1));
+    is_num(my_fetch_int(hstmt1, 1), params[i]);
+  }
+  expect_stmt(hstmt1, SQLFetch(hstmt1), SQL_NO_DATA);
+
+  /* Nothing else was using the connection */
+  if (SQL_SUCCEEDED(SQLGetConnectAttr(hdbc1, SQL_ATTR_MYODBC_LOCK_WAITS,
+                                      &lock_waits, 0, NULL)))
+  {
+    is_num(lock_waits, 0);
+  }
+
+  ok_stmt(hstmt2, SQLFreeHandle(SQL_HANDLE_STMT, hstmt2));
+  free_basic_handles(&henv1, &hdbc1, &hstmt1);
+  return OK;
+}
+
+
+/*
+  FLOAT and DOUBLE parameters sent as text with the shortest literals have
+  to read back as the same numbers, and still be DOUBLE for the server.
+*/
+DECLARE_TEST(t_float_params_text)
+{
+  DECLARE_BASIC_HANDLES(henv1, hdbc1, hstmt1);
+  SQLDOUBLE doubles[]= {0.1, 1.0 / 3, 1e300, -2.5e-300, 1.2345678901234568e17,
+                        10.0};
+  SQLREAL floats[]= {1.0000001f, 0.1f, 3.4e38f, -1.17549435e-38f,
+                     16777216.0f, 10.0f};
+  SQLDOUBLE d;
+  SQLREAL f;
+  SQLSMALLINT type;
+  int i;
+
+  is(OK == alloc_basic_handles_with_opt(&henv1, &hdbc1, &hstmt1, NULL,
+                                        NULL, NULL, NULL, "NO_SSPS=1"));
+
+  ok_sql(hstmt1, "DROP TABLE IF EXISTS t_float_params_text");
+  /* FLOAT columns are returned with 6 digits only */
+  ok_sql(hstmt1, "CREATE TABLE t_float_params_text (id INT, d DOUBLE,"
+                 " f DOUBLE)");
+
+  for (i= 0; i < 6; ++i)
+  {
+    ok_stmt(hstmt1, SQLBindParameter(hstmt1, 1, SQL_PARAM_INPUT, SQL_C_LONG,
+                                     SQL_INTEGER, 0, 0, &i, 0, NULL));
+    ok_stmt(hstmt1, SQLBindParameter(hstmt1, 2, SQL_PARAM_INPUT, SQL_C_DOUBLE,
+                                     SQL_DOUBLE, 0, 0, doubles + i, 0, NULL));
+    ok_stmt(hstmt1, SQLBindParameter(hstmt1, 3, SQL_PARAM_INPUT, SQL_C_FLOAT,
+                                     SQL_REAL, 0, 0, floats + i, 0, NULL));
+    ok_sql(hstmt1, "INSERT INTO t_float_params_text VALUES (?, ?, ?)");
+  }
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_RESET_PARAMS));
+
+  ok_sql(hstmt1, "SELECT d, f FROM t_float_params_text ORDER BY id");
+  for (i= 0; i < 6; ++i)
+  {
+    ok_stmt(hstmt1, SQLFetch(hstmt1));
+    ok_stmt(hstmt1, SQLGetData(hstmt1, 1, SQL_C_DOUBLE, &d, 0, NULL));
+    ok_stmt(hstmt1, SQLGetData(hstmt1, 2, SQL_C_FLOAT, &f, 0, NULL));
+    is(d == doubles[i]);
+    is(f == floats[i]);
+  }
+  expect_stmt(hstmt1, SQLFetch(hstmt1), SQL_NO_DATA);
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  /* 10 is sent with an exponent, so the division is not a DECIMAL one */
+  ok_stmt(hstmt1, SQLBindParameter(hstmt1, 1, SQL_PARAM_INPUT, SQL_C_DOUBLE,
+                                   SQL_DOUBLE, 0, 0, doubles + 5, 0, NULL));
+  ok_sql(hstmt1, "SELECT ? / 4");
+  ok_stmt(hstmt1, SQLDescribeCol(hstmt1, 1, NULL, 0, NULL, &type, NULL, NULL,
+                                 NULL));
+  is_num(type, SQL_DOUBLE);
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_RESET_PARAMS));
+
+  ok_sql(hstmt1, "DROP TABLE IF EXISTS t_float_params_text");
+  free_basic_handles(&henv1, &hdbc1, &hstmt1);
+  return OK;
+}
+
+
+/*
+  Strings with every byte that needs escaping, in runs shorter and longer
+  than a block, and a value of a few megabytes go through the text protocol
+  unchanged.
+*/
+DECLARE_TEST(t_escape_params_text)
+{
+  DECLARE_BASIC_HANDLES(henv1, hdbc1, hstmt1);
+  const SQLLEN big_length= 3 * 1024 * 1024;
+  SQLCHAR *value= malloc(big_length), *res= malloc(big_length);
+  const char specials[]= "\0\n\r\\'\"\032";
+  SQLLEN length, res_length;
+  int i;
+
+  is(value != NULL && res != NULL);
+  is(OK == alloc_basic_handles_with_opt(&henv1, &hdbc1, &hstmt1, NULL,
+                                        NULL, NULL, NULL, "NO_SSPS=1"));
+
+  ok_sql(hstmt1, "DROP TABLE IF EXISTS t_escape_params_text");
+  ok_sql(hstmt1, "CREATE TABLE t_escape_params_text (id INT, b LONGBLOB)");
+
+  for (i= 0; i < big_length; ++i)
+  {
+    /* Runs of 0 to 40 plain bytes between specials */
+    value[i]= i % 41 == 40 ? specials[i / 41 % 7] : 'a' + i % 26;
+  }
+  memcpy(value, specials, 7);
+
+  for (i= 0; i < 3; ++i)
+  {
+    length= i == 0 ? 7 : i == 1 ? 100 : big_length;
+
+    ok_stmt(hstmt1, SQLBindParameter(hstmt1, 1, SQL_PARAM_INPUT, SQL_C_LONG,
+                                     SQL_INTEGER, 0, 0, &i, 0, NULL));
+    ok_stmt(hstmt1, SQLBindParameter(hstmt1, 2, SQL_PARAM_INPUT,
+                                     SQL_C_BINARY, SQL_LONGVARBINARY, 0, 0,
+                                     value, length, &length));
+    ok_sql(hstmt1, "INSERT INTO t_escape_params_text VALUES (?, ?)");
+    ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_RESET_PARAMS));
+  }
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  ok_sql(hstmt1, "SELECT id, b FROM t_escape_params_text ORDER BY id");
+  for (i= 0; i < 3; ++i)
+  {
+    length= i == 0 ? 7 : i == 1 ? 100 : big_length;
+
+    ok_stmt(hstmt1, SQLFetch(hstmt1));
+    is_num(my_fetch_int(hstmt1, 1), i);
+    ok_stmt(hstmt1, SQLGetData(hstmt1, 2, SQL_C_BINARY, res, big_length,
+                               &res_length));
+    is_num(res_length, length);
+    is(memcmp(res, value, length) == 0);
+  }
+  expect_stmt(hstmt1, SQLFetch(hstmt1), SQL_NO_DATA);
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  ok_sql(hstmt1, "DROP TABLE IF EXISTS t_escape_params_text");
+  free_basic_handles(&henv1, &hdbc1, &hstmt1);
+  free(value);
+  free(res);
+  return OK;
+}
+
+
 BEGIN_TESTS
   ADD_TEST(my_init_table)
 #ifndef USE_IODBC
@@ -1711,6 +2043,7 @@ BEGIN_TESTS
   ADD_TEST(paramarray_ignore_paramset)
   ADD_TEST(paramarray_select)
   ADD_TEST(t_bug56804)
+  ADD_TEST(t_batch_params)
 #endif
   ADD_TEST(t_param_offset)
   ADD_TEST(t_bug49029)
@@ -1723,6 +2056,9 @@ BEGIN_TESTS
   // ADD_TEST(t_bug14586094) TODO: Fix
   // ADD_TEST(t_longtextoutparam)  TODO: Fix
   ADD_TEST(t_bug53891)
+  ADD_TEST(t_param_stmt_buffers)
+  ADD_TEST(t_float_params_text)
+  ADD_TEST(t_escape_params_text)
 #if USE_UNIXODBC
   ADD_TEST(t_odbc_outstream_params)
   ADD_TEST(t_odbc_inoutstream_params)
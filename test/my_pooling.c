@@ -98,6 +98,92 @@ DECLARE_TEST(t_reset_connection)
 }
 
 
+#ifndef USE_IODBC
+/*
+  Connection brought back from the pool has to be in the state it had after
+  connect, without logging in again if the account is still the same. The
+  reset the DM does when putting the connection to the pool is done here by
+  the test itself.
+*/
+DECLARE_TEST(t_wakeup_session)
+{
+  DECLARE_BASIC_HANDLES(henv1, hdbc1, hstmt1);
+  SQLULEN wakeups, reauths, count;
+  SQLCHAR buff[64];
+  SQLINTEGER autocommit;
+
+  ok_sql(hstmt, "DROP DATABASE IF EXISTS t_wakeup_session");
+  ok_sql(hstmt, "CREATE DATABASE t_wakeup_session");
+
+  is(OK == alloc_basic_handles(&henv1, &hdbc1, &hstmt1));
+
+  if (!SQL_SUCCEEDED(SQLGetConnectAttr(hdbc1, SQL_ATTR_MYODBC_WAKEUPS,
+                                       &wakeups, 0, NULL)))
+  {
+    free_basic_handles(&henv1, &hdbc1, &hstmt1);
+    skip("Driver manager does not pass driver-specific attributes");
+  }
+  ok_con(hdbc1, SQLGetConnectAttr(hdbc1, SQL_ATTR_MYODBC_WAKEUPS_REAUTH,
+                                  &reauths, 0, NULL));
+
+  ok_sql(hstmt1, "USE t_wakeup_session");
+  ok_sql(hstmt1, "SET @@sql_select_limit=3, @@character_set_results=latin1");
+  /* Nothing of the previous user's session may be left */
+  ok_sql(hstmt1, "SET @t_wakeup_var=1");
+  ok_sql(hstmt1, "CREATE TEMPORARY TABLE t_wakeup_tmp (a INT)");
+  ok_con(hdbc1, SQLSetConnectAttr(hdbc1, SQL_ATTR_AUTOCOMMIT,
+                                  (SQLPOINTER)SQL_AUTOCOMMIT_OFF, 0));
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_DROP));
+  hstmt1= NULL;
+
+  if (!SQL_SUCCEEDED(SQLSetConnectAttr(hdbc1, SQL_ATTR_RESET_CONNECTION,
+                                       (SQLPOINTER)SQL_RESET_CONNECTION_YES,
+                                       0)))
+  {
+    free_basic_handles(&henv1, &hdbc1, &hstmt1);
+    skip("Driver manager does not let reset the connection");
+  }
+
+  /* Waking up */
+  ok_con(hdbc1, SQLAllocStmt(hdbc1, &hstmt1));
+
+  ok_sql(hstmt1, "SELECT DATABASE(), @@sql_select_limit = @@global.sql_select_limit,"
+                 " @@character_set_results IS NULL, @@autocommit");
+  ok_stmt(hstmt1, SQLFetch(hstmt1));
+  is_str(my_fetch_str(hstmt1, buff, 1), mydb, strlen((char *)mydb) + 1);
+  is_num(my_fetch_int(hstmt1, 2), 1);
+  is_num(my_fetch_int(hstmt1, 3), 1);
+  is_num(my_fetch_int(hstmt1, 4), 1);
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  ok_sql(hstmt1, "SELECT @t_wakeup_var IS NULL");
+  ok_stmt(hstmt1, SQLFetch(hstmt1));
+  is_num(my_fetch_int(hstmt1, 1), 1);
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  expect_sql(hstmt1, "SELECT * FROM t_wakeup_session.t_wakeup_tmp",
+             SQL_ERROR);
+
+  ok_con(hdbc1, SQLGetConnectAttr(hdbc1, SQL_ATTR_AUTOCOMMIT, &autocommit,
+                                  0, NULL));
+  is_num(autocommit, SQL_AUTOCOMMIT_ON);
+
+  ok_con(hdbc1, SQLGetConnectAttr(hdbc1, SQL_ATTR_MYODBC_WAKEUPS, &count,
+                                  0, NULL));
+  is_num(count, wakeups + 1);
+  ok_con(hdbc1, SQLGetConnectAttr(hdbc1, SQL_ATTR_MYODBC_WAKEUPS_REAUTH,
+                                  &count, 0, NULL));
+  is_num(count, reauths);
+
+  free_basic_handles(&henv1, &hdbc1, &hstmt1);
+
+  ok_sql(hstmt, "DROP DATABASE IF EXISTS t_wakeup_session");
+
+  return OK;
+}
+#endif
+
+
 DECLARE_TEST(t_dummy_test)
 {
   return OK;
@@ -106,6 +192,9 @@ DECLARE_TEST(t_dummy_test)
 BEGIN_TESTS
   // ADD_TEST(t_reset_connection) TODO: Fix
   ADD_TEST(t_dummy_test)
+#ifndef USE_IODBC
+  ADD_TEST(t_wakeup_session)
+#endif
 END_TESTS
 
 myenable_pooling= 1;
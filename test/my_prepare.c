@@ -1250,6 +1250,315 @@ DECLARE_TEST(t_bug67920)
   SQLFreeStmt(hstmt, SQL_CLOSE);
   return OK;
 }
+/*
+  Fixed width columns bound with their exact C type are fetched by
+  server-side prepared statement right into the application buffers
+*/
+DECLARE_TEST(t_prep_direct_fetch)
+{
+  struct {
+    SQLSCHAR    t;
+    SQLLEN      t_ind;
+    SQLUINTEGER u;
+    SQLLEN      u_ind;
+    SQLBIGINT   b;
+    SQLLEN      b_ind;
+    SQLDOUBLE   d;
+    SQLLEN      d_ind;
+    SQLCHAR     s[10];
+    SQLLEN      s_ind;
+  } rows[3];
+  SQLULEN fetched;
+  SQLINTEGER id, check;
+
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_prep_direct_fetch");
+  ok_sql(hstmt, "CREATE TABLE t_prep_direct_fetch (id INT PRIMARY KEY, "
+                "t TINYINT, u INT UNSIGNED, b BIGINT, d DOUBLE, s VARCHAR(9))");
+  ok_sql(hstmt, "INSERT INTO t_prep_direct_fetch VALUES "
+                "(1, -1, 4294967295, -9000000000, 0.5, 'a'),"
+                "(2, NULL, NULL, NULL, NULL, NULL),"
+                "(3, 127, 3, 9000000000, -1.25, 'abc')");
+
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_BIND_TYPE,
+                                (SQLPOINTER)sizeof(rows[0]), 0));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_ARRAY_SIZE,
+                                (SQLPOINTER)3, 0));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROWS_FETCHED_PTR,
+                                &fetched, 0));
+
+  ok_stmt(hstmt, SQLPrepare(hstmt, "SELECT t, u, b, d, s FROM "
+                            "t_prep_direct_fetch ORDER BY id", SQL_NTS));
+  ok_stmt(hstmt, SQLBindCol(hstmt, 1, SQL_C_STINYINT, &rows[0].t, 0,
+                            &rows[0].t_ind));
+  ok_stmt(hstmt, SQLBindCol(hstmt, 2, SQL_C_ULONG, &rows[0].u, 0,
+                            &rows[0].u_ind));
+  ok_stmt(hstmt, SQLBindCol(hstmt, 3, SQL_C_SBIGINT, &rows[0].b, 0,
+                            &rows[0].b_ind));
+  ok_stmt(hstmt, SQLBindCol(hstmt, 4, SQL_C_DOUBLE, &rows[0].d, 0,
+                            &rows[0].d_ind));
+  ok_stmt(hstmt, SQLBindCol(hstmt, 5, SQL_C_CHAR, rows[0].s,
+                            sizeof(rows[0].s), &rows[0].s_ind));
+
+  memset(rows, 0x7f, sizeof(rows));
+  ok_stmt(hstmt, SQLExecute(hstmt));
+  ok_stmt(hstmt, SQLFetch(hstmt));
+  is_num(fetched, 3);
+
+  is_num(rows[0].t, -1);
+  is_num(rows[0].t_ind, sizeof(SQLSCHAR));
+  is_num(rows[0].u, 4294967295U);
+  is_num(rows[0].u_ind, sizeof(SQLUINTEGER));
+  is(rows[0].b == -9000000000LL);
+  is_num(rows[0].b_ind, sizeof(SQLBIGINT));
+  is(rows[0].d == 0.5);
+  is_num(rows[0].d_ind, sizeof(SQLDOUBLE));
+  is_str(rows[0].s, "a", 2);
+
+  is_num(rows[1].t_ind, SQL_NULL_DATA);
+  is_num(rows[1].u_ind, SQL_NULL_DATA);
+  is_num(rows[1].b_ind, SQL_NULL_DATA);
+  is_num(rows[1].d_ind, SQL_NULL_DATA);
+  is_num(rows[1].s_ind, SQL_NULL_DATA);
+
+  is_num(rows[2].t, 127);
+  is_num(rows[2].u, 3);
+  is(rows[2].b == 9000000000LL);
+  is(rows[2].d == -1.25);
+  is_str(rows[2].s, "abc", 4);
+
+  expect_stmt(hstmt, SQLFetch(hstmt), SQL_NO_DATA);
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_UNBIND));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_BIND_TYPE,
+                                (SQLPOINTER)SQL_BIND_BY_COLUMN, 0));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_ARRAY_SIZE,
+                                (SQLPOINTER)1, 0));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROWS_FETCHED_PTR, NULL, 0));
+
+  /* Positioned update must use the value fetched, not the changed one */
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_CURSOR_TYPE,
+                                (SQLPOINTER)SQL_CURSOR_STATIC, 0));
+  ok_stmt(hstmt, SQLPrepare(hstmt, "SELECT id FROM t_prep_direct_fetch "
+                            "ORDER BY id", SQL_NTS));
+  ok_stmt(hstmt, SQLExecute(hstmt));
+  ok_stmt(hstmt, SQLBindCol(hstmt, 1, SQL_C_LONG, &id, 0, NULL));
+  ok_stmt(hstmt, SQLFetch(hstmt));
+  is_num(id, 1);
+
+  id= 10;
+  ok_stmt(hstmt, SQLSetPos(hstmt, 1, SQL_UPDATE, SQL_LOCK_NO_CHANGE));
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_UNBIND));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_CURSOR_TYPE,
+                                (SQLPOINTER)SQL_CURSOR_FORWARD_ONLY, 0));
+
+  ok_sql(hstmt, "SELECT COUNT(*) FROM t_prep_direct_fetch WHERE id IN (2,3,10)");
+  ok_stmt(hstmt, SQLFetch(hstmt));
+  check= my_fetch_int(hstmt, 1);
+  is_num(check, 3);
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+
+  /* SQLGetData returns the value fetched, and SQL_RD_OFF leaves the bound
+     buffer alone */
+  ok_stmt(hstmt, SQLPrepare(hstmt, "SELECT id FROM t_prep_direct_fetch "
+                            "ORDER BY id", SQL_NTS));
+  ok_stmt(hstmt, SQLExecute(hstmt));
+  ok_stmt(hstmt, SQLBindCol(hstmt, 1, SQL_C_LONG, &id, 0, NULL));
+  ok_stmt(hstmt, SQLFetch(hstmt));
+  is_num(id, 2);
+
+  id= 0;
+  ok_stmt(hstmt, SQLGetData(hstmt, 1, SQL_C_LONG, &check, 0, NULL));
+  is_num(check, 2);
+
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_RETRIEVE_DATA,
+                                (SQLPOINTER)SQL_RD_OFF, 0));
+  ok_stmt(hstmt, SQLFetch(hstmt));
+  is_num(id, 0);
+  ok_stmt(hstmt, SQLGetData(hstmt, 1, SQL_C_LONG, &check, 0, NULL));
+  is_num(check, 3);
+
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_RETRIEVE_DATA,
+                                (SQLPOINTER)SQL_RD_ON, 0));
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_UNBIND));
+
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_prep_direct_fetch");
+  return OK;
+}
+/*
+  Statement prepared again on the same connection is taken from the cache
+  of prepared statements, least recently used ones are evicted from it
+*/
+DECLARE_TEST(t_prep_cache)
+{
+  DECLARE_BASIC_HANDLES(henv1, hdbc1, hstmt1);
+  SQLCHAR *queries[]= {"SELECT ?", "SELECT ? + 1", "SELECT ? + 2",
+                       "SELECT ?"};
+  SQLULEN hits, misses, evictions;
+  SQLINTEGER param= 5, i;
+
+  is(OK == alloc_basic_handles_with_opt(&henv1, &hdbc1, &hstmt1, NULL,
+                                        NULL, NULL, NULL,
+                                        "NO_SSPS=0;STMT_CACHE_SIZE=2"));
+
+  if (!SQL_SUCCEEDED(SQLGetConnectAttr(hdbc1, SQL_ATTR_MYODBC_STMT_CACHE_HITS,
+                                       &hits, 0, NULL)))
+  {
+    free_basic_handles(&henv1, &hdbc1, &hstmt1);
+    skip("Driver manager does not pass driver-specific attributes");
+  }
+  is_num(hits, 0);
+
+  ok_stmt(hstmt1, SQLBindParameter(hstmt1, 1, SQL_PARAM_INPUT, SQL_C_LONG,
+                                   SQL_INTEGER, 0, 0, &param, 0, NULL));
+
+  /* "SELECT ?" is evicted by the 3rd query, so none of them is a hit */
+  for (i= 0; i < 4; ++i)
+  {
+    ok_stmt(hstmt1, SQLPrepare(hstmt1, queries[i], SQL_NTS));
+    ok_stmt(hstmt1, SQLExecute(hstmt1));
+    ok_stmt(hstmt1, SQLFetch(hstmt1));
+    is_num(my_fetch_int(hstmt1, 1), param + (i % 3));
+    ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+  }
+
+  /* Most recently used one is there */
+  ok_stmt(hstmt1, SQLPrepare(hstmt1, queries[2], SQL_NTS));
+  ok_stmt(hstmt1, SQLExecute(hstmt1));
+  ok_stmt(hstmt1, SQLFetch(hstmt1));
+  is_num(my_fetch_int(hstmt1, 1), param + 2);
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  ok_con(hdbc1, SQLGetConnectAttr(hdbc1, SQL_ATTR_MYODBC_STMT_CACHE_HITS,
+                                  &hits, 0, NULL));
+  ok_con(hdbc1, SQLGetConnectAttr(hdbc1, SQL_ATTR_MYODBC_STMT_CACHE_MISSES,
+                                  &misses, 0, NULL));
+  ok_con(hdbc1, SQLGetConnectAttr(hdbc1,
+                                  SQL_ATTR_MYODBC_STMT_CACHE_EVICTIONS,
+                                  &evictions, 0, NULL));
+  is_num(hits, 1);
+  is_num(misses, 4);
+  is_num(evictions, 2);
+
+  /* Changing the default database flushes the cache, so the unqualified
+     table is looked up in the new one */
+  ok_sql(hstmt1, "DROP DATABASE IF EXISTS t_prep_cache_db");
+  ok_sql(hstmt1, "CREATE DATABASE t_prep_cache_db");
+  ok_sql(hstmt1, "CREATE TABLE t_prep_cache_db.t_prep_cache (a INT)");
+  ok_sql(hstmt1, "INSERT INTO t_prep_cache_db.t_prep_cache VALUES (2)");
+  ok_sql(hstmt1, "DROP TABLE IF EXISTS t_prep_cache");
+  ok_sql(hstmt1, "CREATE TABLE t_prep_cache (a INT)");
+  ok_sql(hstmt1, "INSERT INTO t_prep_cache VALUES (1)");
+
+  for (i= 1; i <= 3; ++i)
+  {
+    ok_stmt(hstmt1, SQLPrepare(hstmt1, "SELECT a FROM t_prep_cache",
+                               SQL_NTS));
+    ok_stmt(hstmt1, SQLExecute(hstmt1));
+    ok_stmt(hstmt1, SQLFetch(hstmt1));
+    is_num(my_fetch_int(hstmt1, 1), i == 2 ? 2 : 1);
+    ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+    if (i == 1)
+    {
+      ok_sql(hstmt1, "USE t_prep_cache_db");
+    }
+    else if (i == 2)
+    {
+      ok_con(hdbc1, SQLSetConnectAttr(hdbc1, SQL_ATTR_CURRENT_CATALOG,
+                                      mydb, SQL_NTS));
+    }
+  }
+
+  ok_sql(hstmt1, "DROP TABLE IF EXISTS t_prep_cache");
+  ok_sql(hstmt1, "DROP DATABASE IF EXISTS t_prep_cache_db");
+
+  free_basic_handles(&henv1, &hdbc1, &hstmt1);
+  return OK;
+}
+
+
+/*
+  Queries parsed before are taken from the parse cache of the environment,
+  which has to give the same parameters and remove the same braces.
+*/
+DECLARE_TEST(t_prep_parse_cache)
+{
+  SQLCHAR *queries[]= {"SELECT ? + 1, '?'", "{SELECT ? + 2}",
+                       "SELECT /* ? */ ? + 3"};
+  SQLINTEGER param= 5, i, j;
+  SQLULEN hits, misses, hits_after, misses_after;
+  int counted= SQL_SUCCEEDED(SQLGetConnectAttr(hdbc,
+                                SQL_ATTR_MYODBC_PARSE_CACHE_HITS,
+                                &hits, 0, NULL));
+
+  if (counted)
+  {
+    ok_con(hdbc, SQLGetConnectAttr(hdbc, SQL_ATTR_MYODBC_PARSE_CACHE_MISSES,
+                                   &misses, 0, NULL));
+  }
+
+  ok_stmt(hstmt, SQLBindParameter(hstmt, 1, SQL_PARAM_INPUT, SQL_C_LONG,
+                                  SQL_INTEGER, 0, 0, &param, 0, NULL));
+
+  for (j= 0; j < 3; ++j)
+  {
+    for (i= 0; i < 3; ++i)
+    {
+      ok_stmt(hstmt, SQLPrepare(hstmt, queries[i], SQL_NTS));
+      ok_stmt(hstmt, SQLExecute(hstmt));
+      ok_stmt(hstmt, SQLFetch(hstmt));
+      is_num(my_fetch_int(hstmt, 1), param + i + 1);
+      ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+    }
+    ++param;
+  }
+
+  /* Texts are parsed once, unless they take the same slot of the cache */
+  if (counted)
+  {
+    ok_con(hdbc, SQLGetConnectAttr(hdbc, SQL_ATTR_MYODBC_PARSE_CACHE_HITS,
+                                   &hits_after, 0, NULL));
+    ok_con(hdbc, SQLGetConnectAttr(hdbc, SQL_ATTR_MYODBC_PARSE_CACHE_MISSES,
+                                   &misses_after, 0, NULL));
+    is(hits_after > hits);
+    is(misses_after > misses);
+  }
+
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_RESET_PARAMS));
+  return OK;
+}
+
+
+/* Quotes, comments and parameters after long runs of plain characters */
+DECLARE_TEST(t_prep_long_tokens)
+{
+  SQLCHAR buff[64];
+  SQLSMALLINT params;
+  SQLINTEGER param= 5;
+
+  ok_stmt(hstmt, SQLPrepare(hstmt, (SQLCHAR *)
+          "SELECT ?+1 AS a_rather_long_column_alias_0123456789,"
+          "'x?y;z' AS another_long_alias_abcdefghijklmnop/* ? */,"
+          "`quoted?identifier_with_a_long_name` FROM (SELECT 1 AS "
+          "`quoted?identifier_with_a_long_name`) AS a_long_table_alias -- ?\n",
+          SQL_NTS));
+  ok_stmt(hstmt, SQLNumParams(hstmt, &params));
+  is_num(params, 1);
+
+  ok_stmt(hstmt, SQLBindParameter(hstmt, 1, SQL_PARAM_INPUT, SQL_C_LONG,
+                                  SQL_INTEGER, 0, 0, &param, 0, NULL));
+  ok_stmt(hstmt, SQLExecute(hstmt));
+  ok_stmt(hstmt, SQLFetch(hstmt));
+  is_num(my_fetch_int(hstmt, 1), 6);
+  is_str(my_fetch_str(hstmt, buff, 2), "x?y;z", 5);
+  is_num(my_fetch_int(hstmt, 3), 1);
+
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_RESET_PARAMS));
+  return OK;
+}
 
 
 BEGIN_TESTS
@@ -1273,6 +1582,10 @@ BEGIN_TESTS
   ADD_TEST(t_bug67702)
   ADD_TEST(t_bug68243)
   ADD_TEST(t_bug67920)
+  ADD_TEST(t_prep_direct_fetch)
+  ADD_TEST(t_prep_cache)
+  ADD_TEST(t_prep_parse_cache)
+  ADD_TEST(t_prep_long_tokens)
 END_TESTS
 
 
@@ -1368,6 +1368,260 @@ DECLARE_TEST(t_prefetch_bug)
     return OK;
 }
 
+/*
+  Fetch plan has to follow changes of bindings and of the bind offset
+  between fetches from the same result.
+*/
+DECLARE_TEST(t_fetch_plan_rebind)
+{
+  SQLINTEGER  id;
+  SQLCHAR     str[2][10];
+  SQLLEN      id_len, str_len[2];
+  SQLULEN     offset= 0;
+
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_fetch_plan");
+  ok_sql(hstmt, "CREATE TABLE t_fetch_plan (id INT, val VARCHAR(8))");
+  ok_sql(hstmt, "INSERT INTO t_fetch_plan VALUES (1, 'a'), (2, 'bb'), "
+                "(3, 'ccc'), (4, 'dddd')");
+
+  ok_sql(hstmt, "SELECT id, val FROM t_fetch_plan ORDER BY id");
+
+  ok_stmt(hstmt, SQLBindCol(hstmt, 1, SQL_C_LONG, &id, 0, &id_len));
+  ok_stmt(hstmt, SQLFetch(hstmt));
+  is_num(id, 1);
+
+  /* Rebinding 1st column to another type, and binding the 2nd one */
+  ok_stmt(hstmt, SQLBindCol(hstmt, 1, SQL_C_CHAR, str[0], sizeof(str[0]),
+                            str_len));
+  ok_stmt(hstmt, SQLBindCol(hstmt, 2, SQL_C_CHAR, str[1], sizeof(str[1]),
+                            str_len + 1));
+  ok_stmt(hstmt, SQLFetch(hstmt));
+  is_str(str[0], "2", 2);
+  is_str(str[1], "bb", 3);
+
+  /* Unbinding 1st column */
+  ok_stmt(hstmt, SQLBindCol(hstmt, 1, SQL_C_CHAR, NULL, 0, NULL));
+  str[0][0]= '\0';
+  ok_stmt(hstmt, SQLFetch(hstmt));
+  is_str(str[0], "", 1);
+  is_str(str[1], "ccc", 4);
+
+  /* Changing the offset value has to be picked up without rebinding */
+  ok_stmt(hstmt, SQLBindCol(hstmt, 2, SQL_C_CHAR, str[0], sizeof(str[0]),
+                            NULL));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_BIND_OFFSET_PTR, &offset,
+                                0));
+  offset= sizeof(str[0]);
+  ok_stmt(hstmt, SQLFetch(hstmt));
+  is_str(str[1], "dddd", 5);
+
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_UNBIND));
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_BIND_OFFSET_PTR, NULL, 0));
+
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_fetch_plan");
+
+  return OK;
+}
+
+
+/*
+  Windows of the scrolled query fetched ahead on the second connection
+  (PREFETCH_ASYNC) have to come in the right order, and closing cursor in the
+  middle of the result has to stop fetching.
+*/
+DECLARE_TEST(t_prefetch_async)
+{
+  SQLINTEGER id, i;
+  SQLCHAR    tz[16];
+  DECLARE_BASIC_HANDLES(henv1, hdbc1, hstmt1);
+
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_prefetch_async");
+  ok_sql(hstmt, "CREATE TABLE t_prefetch_async(id INT PRIMARY KEY)");
+  ok_sql(hstmt, "INSERT INTO t_prefetch_async VALUES (1),(2),(3),(4),(5),"
+                "(6),(7),(8),(9),(10),(11),(12),(13),(14),(15),(16),(17),"
+                "(18),(19),(20),(21),(22),(23)");
+
+  is(OK == alloc_basic_handles_with_opt(&henv1, &hdbc1, &hstmt1, NULL,
+                                        NULL, NULL, NULL,
+                                        "PREFETCH=5;PREFETCH_ASYNC=2;NO_SSPS=1"));
+
+  ok_sql(hstmt1, "SELECT id FROM t_prefetch_async ORDER BY id");
+  ok_stmt(hstmt1, SQLBindCol(hstmt1, 1, SQL_C_LONG, &id, 0, NULL));
+
+  for (i= 1; i <= 23; ++i)
+  {
+    ok_stmt(hstmt1, SQLFetch(hstmt1));
+    is_num(id, i);
+  }
+  expect_stmt(hstmt1, SQLFetch(hstmt1), SQL_NO_DATA);
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  /* LIMIT of the query has to be respected by the windows fetched ahead */
+  ok_sql(hstmt1, "SELECT id FROM t_prefetch_async ORDER BY id LIMIT 3, 12");
+
+  for (i= 4; i <= 15; ++i)
+  {
+    ok_stmt(hstmt1, SQLFetch(hstmt1));
+    is_num(id, i);
+  }
+  expect_stmt(hstmt1, SQLFetch(hstmt1), SQL_NO_DATA);
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  /* Closing the cursor with windows fetched ahead but not consumed */
+  ok_sql(hstmt1, "SELECT id FROM t_prefetch_async ORDER BY id");
+  for (i= 1; i <= 7; ++i)
+  {
+    ok_stmt(hstmt1, SQLFetch(hstmt1));
+    is_num(id, i);
+  }
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  ok_sql(hstmt1, "SELECT id FROM t_prefetch_async WHERE id > 20 ORDER BY id");
+  ok_stmt(hstmt1, SQLFetch(hstmt1));
+  is_num(id, 21);
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  /* Windows fetched ahead see the session variables of the statement's
+     connection */
+  ok_sql(hstmt1, "SET SESSION time_zone = '+05:00'");
+  ok_sql(hstmt1, "SELECT id, @@SESSION.time_zone FROM t_prefetch_async "
+                 "ORDER BY id");
+  ok_stmt(hstmt1, SQLBindCol(hstmt1, 2, SQL_C_CHAR, tz, sizeof(tz), NULL));
+
+  for (i= 1; i <= 23; ++i)
+  {
+    ok_stmt(hstmt1, SQLFetch(hstmt1));
+    is_num(id, i);
+    is_str(tz, "+05:00", 7);
+  }
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_UNBIND));
+
+  free_basic_handles(&henv1, &hdbc1, &hstmt1);
+
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_prefetch_async");
+
+  return OK;
+}
+
+
+/*
+  Scroller pages by the key values when ORDER BY covers a unique key of the
+  table. Windows have to come in the same order as with the whole result
+  read at once, with WHERE, DESC, composite keys and LIMIT in the query.
+  ENUM key is not paged by values.
+*/
+DECLARE_TEST(t_prefetch_keyset)
+{
+  const char *queries[]= {
+    "SELECT a, b FROM t_prefetch_keyset ORDER BY a, b",
+    "SELECT a, b FROM t_prefetch_keyset t ORDER BY t.a DESC, `b` DESC",
+    "SELECT b, a FROM t_prefetch_keyset WHERE a <> 2 OR b LIKE 'x%' "
+      "ORDER BY a, b",
+    "SELECT a, b FROM t_prefetch_keyset ORDER BY a, b LIMIT 4, 13",
+    /* ORDER BY does not cover the key - offsets are used */
+    "SELECT a, b FROM t_prefetch_keyset ORDER BY b, a"
+  };
+  SQLCHAR b[2][20];
+  SQLINTEGER a[2], i, j, rows;
+  SQLULEN keyset_windows, windows= 0;
+  SQLRETURN rc;
+  DECLARE_BASIC_HANDLES(henv1, hdbc1, hstmt1);
+
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_prefetch_keyset");
+  ok_sql(hstmt, "CREATE TABLE t_prefetch_keyset(a INT NOT NULL,"
+                "b VARCHAR(20) NOT NULL, PRIMARY KEY(a, b))");
+  ok_sql(hstmt, "INSERT INTO t_prefetch_keyset VALUES (1,'a'),(1,'b'),"
+                "(1,'c'),(1,'x'),(2,'a'),(2,'xb'),(2,'x''c'),(2,'d'),"
+                "(3,'a'),(3,'b'),(3,'\\\\'),(3,'xyz'),(4,''),(4,'a'),"
+                "(4,'z'),(5,'a'),(5,'b'),(5,'c'),(5,'d'),(5,'e'),(6,'a'),"
+                "(7,'x'),(7,'y')");
+
+  is(OK == alloc_basic_handles_with_opt(&henv1, &hdbc1, &hstmt1, NULL,
+                                        NULL, NULL, NULL,
+                                        "PREFETCH=5;NO_SSPS=1"));
+
+  for (i= 0; i < (SQLINTEGER)(sizeof(queries)/sizeof(queries[0])); ++i)
+  {
+    ok_stmt(hstmt, SQLExecDirect(hstmt, (SQLCHAR *)queries[i], SQL_NTS));
+    ok_stmt(hstmt1, SQLExecDirect(hstmt1, (SQLCHAR *)queries[i], SQL_NTS));
+
+    /* Column order differs in one of the queries */
+    j= i == 2 ? 2 : 1;
+    ok_stmt(hstmt, SQLBindCol(hstmt, j, SQL_C_LONG, &a[0], 0, NULL));
+    ok_stmt(hstmt, SQLBindCol(hstmt, 3 - j, SQL_C_CHAR, b[0], sizeof(b[0]),
+                              NULL));
+    ok_stmt(hstmt1, SQLBindCol(hstmt1, j, SQL_C_LONG, &a[1], 0, NULL));
+    ok_stmt(hstmt1, SQLBindCol(hstmt1, 3 - j, SQL_C_CHAR, b[1], sizeof(b[1]),
+                               NULL));
+
+    rows= 0;
+    while ((rc= SQLFetch(hstmt)) != SQL_NO_DATA)
+    {
+      ok_stmt(hstmt, rc);
+      ok_stmt(hstmt1, SQLFetch(hstmt1));
+      is_num(a[1], a[0]);
+      is_str(b[1], b[0], strlen((char *)b[0]) + 1);
+      ++rows;
+    }
+    expect_stmt(hstmt1, SQLFetch(hstmt1), SQL_NO_DATA);
+    is(rows > 10);
+
+    /* Windows after the 1st one are read by the key values, but with the
+       last query */
+    ok_stmt(hstmt1, SQLGetStmtAttr(hstmt1, SQL_ATTR_MYODBC_STATS_KEYSET_WINDOWS,
+                                   &keyset_windows, 0, NULL));
+    if (i < 4)
+    {
+      is(keyset_windows > windows);
+    }
+    else
+    {
+      is_num(keyset_windows, windows);
+    }
+    windows= keyset_windows;
+
+    ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_UNBIND));
+    ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+    ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_UNBIND));
+    ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+  }
+
+  /* ENUM is ordered by the numbers of its values, not by the strings -
+     offsets have to be used */
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_prefetch_keyset_enum");
+  ok_sql(hstmt, "CREATE TABLE t_prefetch_keyset_enum(e ENUM('z','y','x',"
+                "'w','v','u','t','s','r','q','p','o') NOT NULL PRIMARY KEY)");
+  ok_sql(hstmt, "INSERT INTO t_prefetch_keyset_enum VALUES ('z'),('y'),"
+                "('x'),('w'),('v'),('u'),('t'),('s'),('r'),('q'),('p'),('o')");
+
+  ok_sql(hstmt1, "SELECT e FROM t_prefetch_keyset_enum ORDER BY e");
+  ok_stmt(hstmt1, SQLBindCol(hstmt1, 1, SQL_C_CHAR, b[1], sizeof(b[1]), NULL));
+
+  for (i= 0; i < 12; ++i)
+  {
+    ok_stmt(hstmt1, SQLFetch(hstmt1));
+    is_num(b[1][0], 'z' - i);
+  }
+  expect_stmt(hstmt1, SQLFetch(hstmt1), SQL_NO_DATA);
+
+  ok_stmt(hstmt1, SQLGetStmtAttr(hstmt1, SQL_ATTR_MYODBC_STATS_KEYSET_WINDOWS,
+                                 &keyset_windows, 0, NULL));
+  is_num(keyset_windows, windows);
+
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_UNBIND));
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  free_basic_handles(&henv1, &hdbc1, &hstmt1);
+
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_prefetch_keyset_enum");
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_prefetch_keyset");
+
+  return OK;
+}
+
+
 BEGIN_TESTS
   ADD_TEST(t_bug32420)
   ADD_TEST(t_bug34575)
@@ -1395,6 +1649,9 @@ BEGIN_TESTS
 #endif
   ADD_TEST(t_bug17311065)
   ADD_TEST(t_prefetch_bug)
+  ADD_TEST(t_fetch_plan_rebind)
+  ADD_TEST(t_prefetch_async)
+  ADD_TEST(t_prefetch_keyset)
 END_TESTS
 
 
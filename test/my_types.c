@@ -23,6 +23,7 @@
 */
 
 #include "odbctap.h"
+#include <locale.h>
 
 
 DECLARE_TEST(t_longlong1)
@@ -1218,6 +1219,60 @@ DECLARE_TEST(t_bug69545)
 }
 
 
+/*
+  Numbers in parameters and results have to be converted with '.' as the
+  decimal point whatever locale the application has set.
+*/
+DECLARE_TEST(t_numeric_locale)
+{
+  SQLDOUBLE param= 1.5, value= 0;
+  SQLCHAR buff[32];
+
+  if (!setlocale(LC_NUMERIC, "de_DE.UTF-8") && !setlocale(LC_NUMERIC, "de_DE")
+    && !setlocale(LC_NUMERIC, "German"))
+  {
+    skip("No locale with decimal comma is available");
+  }
+
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_numeric_locale");
+  ok_sql(hstmt, "CREATE TABLE t_numeric_locale (d DOUBLE, v VARCHAR(20))");
+
+  ok_stmt(hstmt, SQLBindParameter(hstmt, 1, SQL_PARAM_INPUT, SQL_C_DOUBLE,
+                                  SQL_DOUBLE, 0, 0, &param, 0, NULL));
+  ok_sql(hstmt, "INSERT INTO t_numeric_locale VALUES (?, '2.25')");
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_RESET_PARAMS));
+
+  ok_sql(hstmt, "SELECT d, v, d FROM t_numeric_locale");
+  ok_stmt(hstmt, SQLFetch(hstmt));
+
+  ok_stmt(hstmt, SQLGetData(hstmt, 1, SQL_C_DOUBLE, &value, 0, NULL));
+  is(value == 1.5);
+  ok_stmt(hstmt, SQLGetData(hstmt, 2, SQL_C_DOUBLE, &value, 0, NULL));
+  is(value == 2.25);
+  is_str(my_fetch_str(hstmt, buff, 3), "1.5", 4);
+
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+
+  /* Server-side prepared statement converts the binary DOUBLE itself */
+  ok_stmt(hstmt, SQLPrepare(hstmt, (SQLCHAR *)"SELECT d FROM t_numeric_locale "
+                                   "WHERE d > ?", SQL_NTS));
+  param= 0;
+  ok_stmt(hstmt, SQLBindParameter(hstmt, 1, SQL_PARAM_INPUT, SQL_C_DOUBLE,
+                                  SQL_DOUBLE, 0, 0, &param, 0, NULL));
+  ok_stmt(hstmt, SQLExecute(hstmt));
+  ok_stmt(hstmt, SQLFetch(hstmt));
+  is_str(my_fetch_str(hstmt, buff, 1), "1.500000", 9);
+
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_RESET_PARAMS));
+
+  setlocale(LC_NUMERIC, "C");
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_numeric_locale");
+
+  return OK;
+}
+
+
 BEGIN_TESTS
   ADD_TEST(t_longlong1)
   ADD_TEST(t_decimal)
@@ -1243,6 +1298,7 @@ BEGIN_TESTS
   ADD_TEST(t_bug29402)
   ADD_TEST(t_bug67793)
   ADD_TEST(t_bug69545)
+  ADD_TEST(t_numeric_locale)
 END_TESTS
 
 
@@ -191,12 +191,80 @@ DECLARE_TEST(t_bug39878)
 
   return OK;
 }
+/*
+  Streaming result of prepared SELECT fetched by rowsets comes through
+  a server cursor, the connection can be used meanwhile
+*/
+DECLARE_TEST(t_ssps_server_cursor)
+{
+  SQLINTEGER i, id[7], total= 0, expected= 0;
+  SQLULEN    fetched;
+  SQLHSTMT   hstmt2;
+  SQLRETURN  rc;
+
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_ssps_server_cursor");
+  ok_sql(hstmt, "CREATE TABLE t_ssps_server_cursor (id INT)");
+
+  ok_stmt(hstmt, SQLPrepare(hstmt, (SQLCHAR *)
+                 "INSERT INTO t_ssps_server_cursor VALUES (?)", SQL_NTS));
+  ok_stmt(hstmt, SQLBindParameter(hstmt, 1, SQL_PARAM_INPUT, SQL_C_LONG,
+                                  SQL_INTEGER, 0, 0, &i, 0, NULL));
+  for (i= 1; i <= my_max_rows; ++i)
+  {
+    ok_stmt(hstmt, SQLExecute(hstmt));
+    expected+= i;
+  }
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_RESET_PARAMS));
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_ARRAY_SIZE,
+                                (SQLPOINTER)7, 0));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROWS_FETCHED_PTR,
+                                &fetched, 0));
+  ok_stmt(hstmt, SQLPrepare(hstmt, (SQLCHAR *)
+                 "SELECT id FROM t_ssps_server_cursor WHERE id > ?", SQL_NTS));
+  i= 0;
+  ok_stmt(hstmt, SQLBindParameter(hstmt, 1, SQL_PARAM_INPUT, SQL_C_LONG,
+                                  SQL_INTEGER, 0, 0, &i, 0, NULL));
+  ok_stmt(hstmt, SQLBindCol(hstmt, 1, SQL_C_LONG, id, 0, NULL));
+  ok_stmt(hstmt, SQLExecute(hstmt));
+
+  ok_con(hdbc, SQLAllocHandle(SQL_HANDLE_STMT, hdbc, &hstmt2));
+
+  while (SQL_SUCCEEDED(rc= SQLFetch(hstmt)))
+  {
+    SQLULEN row;
+
+    for (row= 0; row < fetched; ++row)
+    {
+      total+= id[row];
+    }
+
+    /* Rows left are on the server, not in the connection */
+    ok_sql(hstmt2, "SELECT 1");
+    ok_stmt(hstmt2, SQLFreeStmt(hstmt2, SQL_CLOSE));
+  }
+  is_num(rc, SQL_NO_DATA);
+  is_num(total, expected);
+
+  ok_stmt(hstmt2, SQLFreeStmt(hstmt2, SQL_DROP));
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_UNBIND));
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_RESET_PARAMS));
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_ARRAY_SIZE,
+                                (SQLPOINTER)1, 0));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROWS_FETCHED_PTR, NULL, 0));
+
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_ssps_server_cursor");
+  return OK;
+}
 
 
 BEGIN_TESTS
   ADD_TEST(t_use_result)
   ADD_TEST(t_bug4657)
   ADD_TEST(t_bug39878)
+  ADD_TEST(t_ssps_server_cursor)
 END_TESTS
 
 
@@ -41,10 +41,12 @@
 #ifdef WIN32
 #  include <windows.h>
 #  define sleep(x) Sleep(x*1000)
+#  define msleep(x) Sleep(x)
 #  include <crtdbg.h>
 #else
 #  include <unistd.h>
 #  include <signal.h>
+#  define msleep(x) usleep((x)*1000)
 #endif
 
 #include <stdio.h>
@@ -131,6 +133,27 @@ const char * wstr4output(const wchar_t *wstr)
 #define MYSQL_NAME_LEN 64
 #define MAX_MEM_BLOCK_ELEMENTS 100
 
+/* Driver-specific connection and statement attributes, see driver/driver.h */
+#ifndef SQL_DRIVER_CONN_ATTR_BASE
+# define SQL_DRIVER_CONN_ATTR_BASE 0x00004000
+#endif
+#define SQL_ATTR_MYODBC_WAKEUPS               (SQL_DRIVER_CONN_ATTR_BASE + 1)
+#define SQL_ATTR_MYODBC_WAKEUPS_REAUTH        (SQL_DRIVER_CONN_ATTR_BASE + 2)
+#define SQL_ATTR_MYODBC_STMT_CACHE_HITS       (SQL_DRIVER_CONN_ATTR_BASE + 3)
+#define SQL_ATTR_MYODBC_STMT_CACHE_MISSES     (SQL_DRIVER_CONN_ATTR_BASE + 4)
+#define SQL_ATTR_MYODBC_STMT_CACHE_EVICTIONS  (SQL_DRIVER_CONN_ATTR_BASE + 5)
+#define SQL_ATTR_MYODBC_LOCK_WAITS            (SQL_DRIVER_CONN_ATTR_BASE + 6)
+#define SQL_ATTR_MYODBC_LIVENESS_PINGS        (SQL_DRIVER_CONN_ATTR_BASE + 7)
+#define SQL_ATTR_MYODBC_PARSE_CACHE_HITS      (SQL_DRIVER_CONN_ATTR_BASE + 8)
+#define SQL_ATTR_MYODBC_PARSE_CACHE_MISSES    (SQL_DRIVER_CONN_ATTR_BASE + 9)
+#define SQL_ATTR_MYODBC_STATS_EXECUTIONS      (SQL_DRIVER_CONN_ATTR_BASE + 0x10)
+#define SQL_ATTR_MYODBC_STATS_ROWS_FETCHED    (SQL_DRIVER_CONN_ATTR_BASE + 0x16)
+#define SQL_ATTR_MYODBC_STATS_BYTES_FETCHED   (SQL_DRIVER_CONN_ATTR_BASE + 0x17)
+#define SQL_ATTR_MYODBC_STATS_LATENCY         (SQL_DRIVER_CONN_ATTR_BASE + 0x19)
+#define SQL_ATTR_MYODBC_STATS_CANCELS         (SQL_DRIVER_CONN_ATTR_BASE + 0x29)
+#define SQL_ATTR_MYODBC_STATS_KEYSET_WINDOWS  (SQL_DRIVER_CONN_ATTR_BASE + 0x2B)
+#define SQL_ATTR_MYODBC_STATS_ENV             0x40
+
 #ifdef __WIN__
 #define _MY_NEWLINE "\r\n"
 #else
@@ -187,6 +187,22 @@ static SQLWCHAR W_SSLMODE[] =
 { 'S', 'S', 'L', 'M', 'O', 'D', 'E', 0 };
 static SQLWCHAR W_NO_DATE_OVERFLOW[] =
 { 'N', 'O', '_', 'D', 'A', 'T', 'E', '_', 'O', 'V', 'E', 'R', 'F', 'L', 'O', 'W', 0 };
+static SQLWCHAR W_BATCH_PARAMS[] =
+{ 'B', 'A', 'T', 'C', 'H', '_', 'P', 'A', 'R', 'A', 'M', 'S', 0 };
+static SQLWCHAR W_PREFETCH_ASYNC[] =
+{ 'P', 'R', 'E', 'F', 'E', 'T', 'C', 'H', '_', 'A', 'S', 'Y', 'N', 'C', 0 };
+static SQLWCHAR W_LIVENESS_INTERVAL[] =
+{ 'L', 'I', 'V', 'E', 'N', 'E', 'S', 'S', '_', 'I', 'N', 'T', 'E', 'R', 'V', 'A', 'L', 0 };
+static SQLWCHAR W_STMT_CACHE_SIZE[] =
+{ 'S', 'T', 'M', 'T', '_', 'C', 'A', 'C', 'H', 'E', '_', 'S', 'I', 'Z', 'E', 0 };
+static SQLWCHAR W_CATALOG_CACHE_TTL[] =
+{ 'C', 'A', 'T', 'A', 'L', 'O', 'G', '_', 'C', 'A', 'C', 'H', 'E', '_', 'T', 'T', 'L', 0 };
+static SQLWCHAR W_LOG_QUERY_SAMPLE[] =
+{ 'L', 'O', 'G', '_', 'Q', 'U', 'E', 'R', 'Y', '_', 'S', 'A', 'M', 'P', 'L', 'E', 0 };
+static SQLWCHAR W_LOG_QUERY_MAX_SIZE[] =
+{ 'L', 'O', 'G', '_', 'Q', 'U', 'E', 'R', 'Y', '_', 'M', 'A', 'X', '_', 'S', 'I', 'Z', 'E', 0 };
+static SQLWCHAR W_STATS_INTERVAL[] =
+{ 'S', 'T', 'A', 'T', 'S', '_', 'I', 'N', 'T', 'E', 'R', 'V', 'A', 'L', 0 };
 
 /* DS_PARAM */
 /* externally used strings */
@@ -220,7 +236,11 @@ SQLWCHAR *dsnparams[]= {W_DSN, W_DRIVER, W_DESCRIPTION, W_SERVER,
                         W_SAVEFILE, W_RSAKEY, W_PLUGIN_DIR, W_DEFAULT_AUTH,
                         W_DISABLE_SSL_DEFAULT, W_SSL_ENFORCE,
                         W_TLS_1, W_NO_TLS_1_1, W_NO_TLS_1_2,
-                        W_SSLMODE, W_NO_DATE_OVERFLOW};
+                        W_SSLMODE, W_NO_DATE_OVERFLOW, W_BATCH_PARAMS,
+                        W_PREFETCH_ASYNC, W_LIVENESS_INTERVAL,
+                        W_STMT_CACHE_SIZE, W_CATALOG_CACHE_TTL,
+                        W_LOG_QUERY_SAMPLE, W_LOG_QUERY_MAX_SIZE,
+                        W_STATS_INTERVAL};
 static const
 int dsnparamcnt= sizeof(dsnparams) / sizeof(SQLWCHAR *);
 /* DS_PARAM */
@@ -808,6 +828,20 @@ void ds_map_param(DataSource *ds, const SQLWCHAR *param,
     *intdest= &ds->clientinteractive;
   else if (!sqlwcharcasecmp(W_PREFETCH, param))
     *intdest= &ds->cursor_prefetch_number;
+  else if (!sqlwcharcasecmp(W_PREFETCH_ASYNC, param))
+    *intdest= &ds->cursor_prefetch_async;
+  else if (!sqlwcharcasecmp(W_LIVENESS_INTERVAL, param))
+    *intdest= &ds->liveness_interval;
+  else if (!sqlwcharcasecmp(W_STMT_CACHE_SIZE, param))
+    *intdest= &ds->stmt_cache_size;
+  else if (!sqlwcharcasecmp(W_CATALOG_CACHE_TTL, param))
+    *intdest= &ds->catalog_cache_ttl;
+  else if (!sqlwcharcasecmp(W_LOG_QUERY_SAMPLE, param))
+    *intdest= &ds->log_query_sample;
+  else if (!sqlwcharcasecmp(W_LOG_QUERY_MAX_SIZE, param))
+    *intdest= &ds->log_query_max_size;
+  else if (!sqlwcharcasecmp(W_STATS_INTERVAL, param))
+    *intdest= &ds->stats_interval;
   else if (!sqlwcharcasecmp(W_FOUND_ROWS, param))
     *booldest= &ds->return_matching_rows;
   else if (!sqlwcharcasecmp(W_BIG_PACKETS, param))
@@ -888,6 +922,8 @@ void ds_map_param(DataSource *ds, const SQLWCHAR *param,
     *booldest = &ds->no_tls_1_2;
   else if (!sqlwcharcasecmp(W_NO_DATE_OVERFLOW, param))
     *booldest = &ds->no_date_overflow;
+  else if (!sqlwcharcasecmp(W_BATCH_PARAMS, param))
+    *booldest = &ds->batch_params;
 
   /* DS_PARAM */
 }
@@ -1341,6 +1377,13 @@ int ds_add(DataSource *ds)
   if (ds_add_intprop(ds->name, W_WRITETIMEOUT, ds->writetimeout)) goto error;
   if (ds_add_intprop(ds->name, W_CLIENT_INTERACTIVE, ds->clientinteractive)) goto error;
   if (ds_add_intprop(ds->name, W_PREFETCH   , ds->cursor_prefetch_number)) goto error;
+  if (ds_add_intprop(ds->name, W_PREFETCH_ASYNC, ds->cursor_prefetch_async)) goto error;
+  if (ds_add_intprop(ds->name, W_LIVENESS_INTERVAL, ds->liveness_interval)) goto error;
+  if (ds_add_intprop(ds->name, W_STMT_CACHE_SIZE, ds->stmt_cache_size)) goto error;
+  if (ds_add_intprop(ds->name, W_CATALOG_CACHE_TTL, ds->catalog_cache_ttl)) goto error;
+  if (ds_add_intprop(ds->name, W_LOG_QUERY_SAMPLE, ds->log_query_sample)) goto error;
+  if (ds_add_intprop(ds->name, W_LOG_QUERY_MAX_SIZE, ds->log_query_max_size)) goto error;
+  if (ds_add_intprop(ds->name, W_STATS_INTERVAL, ds->stats_interval)) goto error;
 
   if (ds_add_intprop(ds->name, W_FOUND_ROWS, ds->return_matching_rows)) goto error;
   if (ds_add_intprop(ds->name, W_BIG_PACKETS, ds->allow_big_results)) goto error;
@@ -1382,6 +1425,7 @@ int ds_add(DataSource *ds)
   if (ds_add_intprop(ds->name, W_NO_TLS_1_1, ds->no_tls_1_1)) goto error;
   if (ds_add_intprop(ds->name, W_NO_TLS_1_2, ds->no_tls_1_2)) goto error;
   if (ds_add_intprop(ds->name, W_NO_DATE_OVERFLOW, ds->no_date_overflow)) goto error;
+  if (ds_add_intprop(ds->name, W_BATCH_PARAMS, ds->batch_params)) goto error;
   /* DS_PARAM */
 
   rc= 0;
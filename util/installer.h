@@ -153,6 +153,21 @@ typedef struct {
   /* SSL */
   unsigned int sslverify;
   unsigned int cursor_prefetch_number;
+  /* number of scroller windows fetched ahead on a second connection */
+  unsigned int cursor_prefetch_async;
+  /* seconds between background checks of idle connections, 0 - off. The
+     pings reset the server's wait_timeout, idle connections never expire */
+  unsigned int liveness_interval;
+  /* prepared statements kept on the server for reuse, 0 - off */
+  unsigned int stmt_cache_size;
+  /* seconds catalog function results are reused, 0 - off */
+  unsigned int catalog_cache_ttl;
+  /* only every N-th statement execution is logged, 0 and 1 - all */
+  unsigned int log_query_sample;
+  /* megabytes the query log is rotated at, 0 - never */
+  unsigned int log_query_max_size;
+  /* seconds between statistics written to the query log, 0 - never */
+  unsigned int stats_interval;
   BOOL no_ssps;
   BOOL disable_ssl_default;
   BOOL ssl_enforce;
@@ -162,6 +177,7 @@ typedef struct {
   BOOL no_tls_1_2;
 
   BOOL no_date_overflow;
+  BOOL batch_params;
 } DataSource;
 
 /* perhaps that is a good idea to have const ds object with defaults */